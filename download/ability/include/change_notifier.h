@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef CHANGE_NOTIFIER_H
+#define CHANGE_NOTIFIER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OHOS::Request::Download {
+constexpr int64_t CHANGE_ID_UNKNOWN = -1;
+
+/*
+ * Coalesces data changes into common events per batch window. A window closes when no change arrived for
+ * CHANGE_QUIET_MS, or CHANGE_MAX_DELAY_MS after its first change, whichever comes first. Changes stay in
+ * arrival order; only consecutive changes of the same action are merged, so an insert followed by a delete
+ * is never reported the other way round. An event carries the smallest and largest affected task id and
+ * the number of changed rows.
+ */
+class ChangeNotifier final {
+public:
+    static ChangeNotifier &GetInstance();
+    void Notify(int actionCode, int64_t startId, int64_t endId, int64_t count);
+    void Start();
+    void Stop();
+
+private:
+    struct ChangeRange {
+        int actionCode;
+        int64_t startId;
+        int64_t endId;
+        int64_t count;
+    };
+
+    ChangeNotifier();
+    ~ChangeNotifier();
+    ChangeNotifier(const ChangeNotifier &) = delete;
+    ChangeNotifier &operator=(const ChangeNotifier &) = delete;
+    void Run();
+    void Flush(const std::vector<ChangeRange> &changes);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<ChangeRange> pending_;
+    std::chrono::steady_clock::time_point firstChange_;
+    std::chrono::steady_clock::time_point lastChange_;
+    std::thread thread_;
+    bool stop_;
+};
+} // namespace OHOS::Request::Download
+#endif // CHANGE_NOTIFIER_H
@@ -16,6 +16,8 @@
 #ifndef COMMON_EVENT_H
 #define COMMON_EVENT_H
 
+#include <cstdint>
+
 #include "common_event_manager.h"
 #include "common_event_subscriber.h"
 
@@ -41,6 +43,7 @@ public:
     static void UnregisterSubscriber(std::shared_ptr<OHOS::EventFwk::CommonEventSubscriber> subscriber);
     static void RegisterSubscriber();
     static void SendChange(int actionCode);
+    static void SendChange(int actionCode, int64_t startId, int64_t endId, int64_t count);
 };
 } // namespace OHOS::Request::Download
 #endif // COMMON_EVENT_H
\ No newline at end of file
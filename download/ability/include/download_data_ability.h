@@ -21,6 +21,7 @@
 #include "want.h"
 
 #include "download_database.h"
+#include "predicates_convert.h"
 
 namespace OHOS::AppExecFwk {
 class DownloadDataAbility : public Ability {
@@ -30,19 +31,28 @@ public:
     virtual int Insert(const Uri &uri, const NativeRdb::ValuesBucket &value) override;
     virtual int BatchInsert(const Uri &uri, const std::vector<NativeRdb::ValuesBucket> &values) override;
     virtual void OnStart(const Want &want) override;
+    virtual void OnStop() override;
     virtual int Update(const Uri &uri, const NativeRdb::ValuesBucket &value,
         const NativeRdb::DataAbilityPredicates &predicates) override;
     virtual int Delete(const Uri &uri, const NativeRdb::DataAbilityPredicates &predicates) override;
     virtual std::shared_ptr<NativeRdb::AbsSharedResultSet> Query(const Uri &uri,
         const std::vector<std::string> &columns, const NativeRdb::DataAbilityPredicates &predicates) override;
     virtual void Dump(const std::string &extra) override;
+    /* process-local and not persisted: the defaults from constant.h apply again after the ability restarts */
+    static void SetRetentionPolicy(const OHOS::Request::Download::RetentionPolicy &policy);
 
 private:
     int UriParse(Uri &uri);
     int InsertExecute(const Uri &uri, const NativeRdb::ValuesBucket &value);
-    void DataBaseNotifyChange(int code, Uri uri);
-    bool IsBeginTransactionOK(int code, std::mutex &mutex);
-    bool IsCommitOk(int code, std::mutex &mutex);
+    bool ParseQueryPage(const Uri &uri, OHOS::Request::Download::QueryPage &page, bool &isPaged);
+    bool IsValidProjection(const std::vector<std::string> &columns);
+    void DataBaseNotifyChange(int code, int64_t startId, int64_t endId, int64_t count);
+    bool IsBeginTransactionOK(int code);
+    bool IsCommitOk(int code);
+    static void StartRetention();
+    static void StopRetention();
+    static void RetentionLoop();
+    static void RunRetention();
 
 private:
     static std::shared_ptr<OHOS::Request::Download::DownloadDataBase> database_;
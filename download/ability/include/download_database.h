@@ -16,6 +16,7 @@
 #ifndef DOWNLOAD_DATABASE_H
 #define DOWNLOAD_DATABASE_H
 
+#include <mutex>
 #include <pthread.h>
 
 #include "data_ability_predicates.h"
@@ -31,7 +32,13 @@ namespace OHOS::Request::Download {
 constexpr const char *DB_NAME = "download.db";
 constexpr const char *TABLE_NAME = "downloadInfo";
 constexpr int DATABASE_OPEN_VERSION = 1;
-constexpr int DATABASE_NEW_VERSION = 2;
+constexpr int DATABASE_INDEX_VERSION = 2;
+constexpr int DATABASE_NEW_VERSION = 3;
+
+// auto_vacuum only takes effect before the first table is created
+constexpr const char *ENABLE_INCREMENTAL_VACUUM = "PRAGMA auto_vacuum = INCREMENTAL";
+constexpr const char *QUERY_AUTO_VACUUM = "PRAGMA auto_vacuum";
+constexpr int AUTO_VACUUM_INCREMENTAL = 2;
 
 constexpr const char *CREATE_DOWNLOAD =
     "CREATE TABLE IF NOT EXISTS [downloadInfo]("
@@ -47,20 +54,42 @@ constexpr const char *CREATE_DOWNLOAD =
     "[status] INTEGER, "
     "[reason] INTEGER, "
     "[size] INTEGER, "
-    "[mime] TEXT )";
+    "[mime] TEXT, "
+    "[createTime] INTEGER )";
+
+// taskid is the rowid alias of the table and needs no index of its own
+constexpr const char *CREATE_DOWNLOAD_STATUS_INDEX =
+    "CREATE INDEX IF NOT EXISTS [downloadInfo_status] ON [downloadInfo]([status])";
+constexpr const char *CREATE_DOWNLOAD_URL_INDEX =
+    "CREATE INDEX IF NOT EXISTS [downloadInfo_url] ON [downloadInfo]([url])";
+constexpr const char *CREATE_DOWNLOAD_CREATE_TIME_INDEX =
+    "CREATE INDEX IF NOT EXISTS [downloadInfo_createTime] ON [downloadInfo]([createTime])";
+
+struct RetentionPolicy {
+    int64_t maxAgeSeconds;
+    int64_t maxRows;
+    int batchSize;
+};
 
 class DownloadDataBase {
 public:
     static std::shared_ptr<DownloadDataBase> GetInstance();
     static std::shared_ptr<OHOS::NativeRdb::RdbStore> store_;
     int64_t Insert(OHOS::NativeRdb::ValuesBucket insertValues);
-    int Update(OHOS::NativeRdb::ValuesBucket values, OHOS::NativeRdb::RdbPredicates &rdbPredicates);
-    int Delete(OHOS::NativeRdb::RdbPredicates &rdbPredicates);
+    int Update(OHOS::NativeRdb::ValuesBucket values, OHOS::NativeRdb::RdbPredicates &rdbPredicates, int &changeRow);
+    int Delete(OHOS::NativeRdb::RdbPredicates &rdbPredicates, int &deleteRow);
     std::unique_ptr<OHOS::NativeRdb::AbsSharedResultSet> Query(
         OHOS::NativeRdb::RdbPredicates &rdbPredicates, std::vector<std::string> columns);
     int BeginTransaction();
     int Commit();
     int RollBack();
+    int PruneExpired(int64_t expireTime, int batchSize);
+    int PruneOverflow(int64_t maxRows, int batchSize);
+    bool EnableIncrementalVacuum();
+    void IncrementalVacuum(int pages);
+
+private:
+    int PruneOldest(const std::string &whereClause, const std::vector<std::string> &whereArgs, int batchSize);
 
 private:
     DownloadDataBase();
@@ -68,11 +97,14 @@ private:
     const DownloadDataBase &operator=(const DownloadDataBase &);
 
 private:
+    static std::mutex instanceLock_;
     static std::shared_ptr<DownloadDataBase> instance_;
 };
 
 class SqliteOpenHelperDownloadCallback : public OHOS::NativeRdb::RdbOpenCallback {
 public:
+    static int CreateIndexes(OHOS::NativeRdb::RdbStore &rdbStore);
+    static int UpgradeStep(OHOS::NativeRdb::RdbStore &rdbStore, int fromVersion);
     int OnCreate(OHOS::NativeRdb::RdbStore &rdbStore) override;
     int OnUpgrade(OHOS::NativeRdb::RdbStore &rdbStore, int oldVersion, int newVersion) override;
     int OnDowngrade(OHOS::NativeRdb::RdbStore &rdbStore, int currentVersion, int targetVersion) override;
@@ -21,12 +21,25 @@
 #include "rdb_predicates.h"
 
 namespace OHOS::Request::Download {
+/*
+ * Keyset page over taskid. taskid grows with every new task, so it also orders rows by creation time.
+ * A page holds the rows after (or before, when descending) cursor, at most limit of them.
+ */
+struct QueryPage {
+    bool hasCursor = false;
+    int64_t cursor = 0;
+    int limit = 0;
+    bool descending = false;
+};
+
 class PredicatesConvert {
 public:
     PredicatesConvert();
     ~PredicatesConvert();
     OHOS::NativeRdb::RdbPredicates ConvertPredicates(
         std::string tableName, OHOS::NativeRdb::DataAbilityPredicates &dataAbilityPredicates);
+    OHOS::NativeRdb::RdbPredicates ConvertPagePredicates(std::string tableName,
+        OHOS::NativeRdb::DataAbilityPredicates &dataAbilityPredicates, const QueryPage &page);
     OHOS::NativeRdb::RdbPredicates CopyPredicates(
         std::string tableName, OHOS::NativeRdb::RdbPredicates &oldRdbPredicates);
 };
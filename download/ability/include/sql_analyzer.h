@@ -29,9 +29,7 @@ public:
     ~SqlAnalyzer();
 
     bool CheckValuesBucket(const NativeRdb::ValuesBucket &value);
-    bool FindIllegalWords(std::string sql);
-    bool StrCheck(char &ch, std::size_t strlen, std::string sql, std::size_t &pos);
-    bool CharCheck(char &ch, std::string sql, std::size_t &pos);
+    bool FindIllegalWords(const std::string &sql);
 
 private:
     inline bool IsNumber(char ch)
@@ -46,21 +44,11 @@ private:
     {
         return IsNumber(ch) || IsLetter(ch);
     }
-    inline char PickChar(std::string str, std::size_t index)
+    inline bool IsQuote(char ch)
     {
-        if (index < str.length()) {
-            return str.at(index);
-        }
-        return '\0';
-    }
-    inline int IsInStr(char ch, std::string str)
-    {
-        std::size_t pos = str.find(ch);
-        if (pos == std::string::npos) {
-            return OPERATION_ERROR;
-        }
-        return 0;
+        return ch == '\'' || ch == '"' || ch == '`';
     }
+    bool HasSpecialChar(const std::string &sql);
 };
 } // namespace OHOS::Request::Download
 #endif // SQL_ANALYZER_H
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2021 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "change_notifier.h"
+
+#include <algorithm>
+
+#include "common_event.h"
+#include "log.h"
+
+namespace OHOS::Request::Download {
+namespace {
+constexpr int CHANGE_QUIET_MS = 50;
+constexpr int CHANGE_MAX_DELAY_MS = 500;
+}
+
+ChangeNotifier &ChangeNotifier::GetInstance()
+{
+    static ChangeNotifier instance;
+    return instance;
+}
+
+ChangeNotifier::ChangeNotifier() : stop_(false)
+{
+}
+
+ChangeNotifier::~ChangeNotifier()
+{
+    Stop();
+}
+
+/**
+ * @brief Record a change; the common event is published when the batch window closes
+ *
+ * @param actionCode DOWNLOAD_INSERT, DOWNLOAD_UPDATE or DOWNLOAD_DELETE
+ * @param startId smallest affected task id, CHANGE_ID_UNKNOWN if not known
+ * @param endId largest affected task id, CHANGE_ID_UNKNOWN if not known
+ * @param count number of changed rows
+ */
+void ChangeNotifier::Notify(int actionCode, int64_t startId, int64_t endId, int64_t count)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (stop_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (pending_.empty()) {
+        firstChange_ = now;
+    }
+    lastChange_ = now;
+    if (pending_.empty() || pending_.back().actionCode != actionCode) {
+        pending_.push_back({actionCode, startId, endId, count});
+    } else {
+        ChangeRange &range = pending_.back();
+        // an unknown bound widens the whole window to unknown
+        if (range.startId == CHANGE_ID_UNKNOWN || startId == CHANGE_ID_UNKNOWN) {
+            range.startId = CHANGE_ID_UNKNOWN;
+        } else {
+            range.startId = std::min(range.startId, startId);
+        }
+        if (range.endId == CHANGE_ID_UNKNOWN || endId == CHANGE_ID_UNKNOWN) {
+            range.endId = CHANGE_ID_UNKNOWN;
+        } else {
+            range.endId = std::max(range.endId, endId);
+        }
+        range.count += count;
+    }
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&ChangeNotifier::Run, this);
+    }
+    cond_.notify_one();
+}
+
+/**
+ * @brief Accept changes again after Stop, the ability may be started again in the same process
+ */
+void ChangeNotifier::Start()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (!thread_.joinable()) {
+        stop_ = false;
+    }
+}
+
+void ChangeNotifier::Stop()
+{
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void ChangeNotifier::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+        while (!stop_ && !pending_.empty()) {
+            auto deadline = std::min(lastChange_ + std::chrono::milliseconds(CHANGE_QUIET_MS),
+                firstChange_ + std::chrono::milliseconds(CHANGE_MAX_DELAY_MS));
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+            cond_.wait_until(lock, deadline);
+        }
+        std::vector<ChangeRange> changes;
+        changes.swap(pending_);
+        lock.unlock();
+        Flush(changes);
+        lock.lock();
+        if (stop_) {
+            break;
+        }
+    }
+}
+
+void ChangeNotifier::Flush(const std::vector<ChangeRange> &changes)
+{
+    for (const auto &change : changes) {
+        DOWNLOAD_HILOGI("ChangeNotifier action %{public}d ids [%{public}lld, %{public}lld] count %{public}lld",
+            change.actionCode, (long long)change.startId, (long long)change.endId, (long long)change.count);
+        CommonEvent::SendChange(change.actionCode, change.startId, change.endId, change.count);
+    }
+}
+} // namespace OHOS::Request::Download
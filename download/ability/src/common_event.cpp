@@ -71,4 +71,17 @@ void CommonEvent::SendChange(int actionCode)
     std::string eventData("DataChange");
     PublishEvent(want, eventCode, eventData);
 }
+
+void CommonEvent::SendChange(int actionCode, int64_t startId, int64_t endId, int64_t count)
+{
+    OHOS::AAFwk::Want want;
+    int32_t eventCode = DOWNLOAD_EVENT_CODE;
+    want.SetParam("ActionCode", actionCode);
+    want.SetParam("StartId", static_cast<long>(startId));
+    want.SetParam("EndId", static_cast<long>(endId));
+    want.SetParam("Count", static_cast<long>(count));
+    want.SetAction(DOWNLOAD_EVENT);
+    std::string eventData("DataChange");
+    PublishEvent(want, eventCode, eventData);
+}
 } // namespace OHOS::Request::Download
\ No newline at end of file
@@ -15,9 +15,19 @@
 
 #include "download_data_ability.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <ctime>
 #include <mutex>
+#include <set>
+#include <strings.h>
+#include <thread>
 
 #include "ability_loader.h"
+#include "change_notifier.h"
 #include "common_event.h"
 #include "constant.h"
 #include "data_ability_predicates.h"
@@ -33,7 +43,39 @@
 namespace OHOS::AppExecFwk {
 REGISTER_AA(DownloadDataAbility);
 namespace {
-std::mutex g_mutex;
+// single writer: inserts, updates and deletes are serialized, queries read the WAL snapshot without it
+std::mutex g_writeMutex;
+
+constexpr const char *QUERY_PARAM_CURSOR = "cursor";
+constexpr const char *QUERY_PARAM_LIMIT = "limit";
+constexpr const char *QUERY_PARAM_ORDER = "order";
+constexpr const char *QUERY_ORDER_DESC = "desc";
+constexpr int DECIMAL = 10;
+
+// SQLite column names are case-insensitive, so is the projection check
+struct ColumnLess {
+    bool operator()(const std::string &left, const std::string &right) const
+    {
+        return strcasecmp(left.c_str(), right.c_str()) < 0;
+    }
+};
+
+const std::set<std::string, ColumnLess> DOWNLOAD_COLUMNS = {
+    "taskid", "url", "description", "title", "filePath", "header", "metered", "roaming", "network",
+    "status", "reason", "size", "mime", "createTime"};
+
+std::mutex g_retentionMutex;
+std::condition_variable g_retentionCond;
+std::thread g_retentionThread;
+std::atomic<bool> g_retentionStop(false);
+OHOS::Request::Download::RetentionPolicy g_retentionPolicy = {
+    OHOS::Request::Download::RETENTION_MAX_AGE_SECONDS,
+    OHOS::Request::Download::RETENTION_MAX_ROWS,
+    OHOS::Request::Download::RETENTION_BATCH_SIZE,
+};
+// first pass waits until the ability has served its launching request
+constexpr int RETENTION_START_DELAY_SECONDS = 30;
+constexpr int RETENTION_BATCH_PAUSE_MS = 50;
 }
 using namespace OHOS::Request::Download;
 
@@ -64,6 +106,110 @@ void DownloadDataAbility::OnStart(const Want &want)
     DBPath::RDB_PATH = basePath + "/";
     DBPath::RDB_BACKUP_PATH = basePath + "/backup/";
     DBPath::DUMP_PATH = GetFilesDir() + "/";
+    ChangeNotifier::GetInstance().Start();
+    StartRetention();
+}
+
+void DownloadDataAbility::OnStop()
+{
+    DOWNLOAD_HILOGI("DownloadDataAbility OnStop");
+    StopRetention();
+    ChangeNotifier::GetInstance().Stop();
+    Ability::OnStop();
+}
+
+void DownloadDataAbility::SetRetentionPolicy(const RetentionPolicy &policy)
+{
+    std::lock_guard<std::mutex> autoLock(g_retentionMutex);
+    g_retentionPolicy = policy;
+    g_retentionCond.notify_all();
+}
+
+void DownloadDataAbility::StartRetention()
+{
+    std::lock_guard<std::mutex> autoLock(g_retentionMutex);
+    if (g_retentionThread.joinable()) {
+        return;
+    }
+    g_retentionStop = false;
+    g_retentionThread = std::thread(&DownloadDataAbility::RetentionLoop);
+}
+
+void DownloadDataAbility::StopRetention()
+{
+    {
+        std::lock_guard<std::mutex> autoLock(g_retentionMutex);
+        g_retentionStop = true;
+    }
+    g_retentionCond.notify_all();
+    if (g_retentionThread.joinable()) {
+        g_retentionThread.join();
+    }
+}
+
+void DownloadDataAbility::RetentionLoop()
+{
+    std::chrono::seconds wait(RETENTION_START_DELAY_SECONDS);
+    std::unique_lock<std::mutex> lock(g_retentionMutex);
+    while (!g_retentionCond.wait_for(lock, wait, [] { return g_retentionStop.load(); })) {
+        lock.unlock();
+        RunRetention();
+        lock.lock();
+        wait = std::chrono::seconds(RETENTION_INTERVAL_SECONDS);
+    }
+}
+
+/**
+ * @brief DownloadDataAbility prune expired and overflowing records in small batches,
+ * releasing the writer lock between batches so client writes are not starved
+ */
+void DownloadDataAbility::RunRetention()
+{
+    RetentionPolicy policy;
+    {
+        std::lock_guard<std::mutex> autoLock(g_retentionMutex);
+        policy = g_retentionPolicy;
+    }
+    if (policy.batchSize <= 0) {
+        return;
+    }
+    std::shared_ptr<DownloadDataBase> database = DownloadDataBase::GetInstance();
+    {
+        std::lock_guard<std::mutex> autoLock(g_writeMutex);
+        database->EnableIncrementalVacuum();
+    }
+    int64_t expireTime = static_cast<int64_t>(time(nullptr)) - policy.maxAgeSeconds;
+    int total = 0;
+    int deleted = 0;
+    bool expired = policy.maxAgeSeconds > 0;
+    while (expired || policy.maxRows > 0) {
+        {
+            std::lock_guard<std::mutex> autoLock(g_writeMutex);
+            if (g_retentionStop) {
+                break;
+            }
+            deleted = expired ? database->PruneExpired(expireTime, policy.batchSize) :
+                database->PruneOverflow(policy.maxRows, policy.batchSize);
+        }
+        if (deleted > 0) {
+            total += deleted;
+        }
+        if (deleted < policy.batchSize) {
+            if (!expired) {
+                break;
+            }
+            expired = false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(RETENTION_BATCH_PAUSE_MS));
+    }
+    DOWNLOAD_HILOGI("DownloadDataAbility retention pruned %{public}d records", total);
+    if (total > 0) {
+        {
+            std::lock_guard<std::mutex> autoLock(g_writeMutex);
+            database->IncrementalVacuum(RETENTION_VACUUM_PAGES);
+        }
+        ChangeNotifier::GetInstance().Notify(DOWNLOAD_DELETE, CHANGE_ID_UNKNOWN, CHANGE_ID_UNKNOWN, total);
+    }
 }
 
 int DownloadDataAbility::UriParse(Uri &uri)
@@ -77,16 +223,13 @@ int DownloadDataAbility::UriParse(Uri &uri)
  * @brief DownloadDataAbility BeginTransaction emptiness problems
  *
  * @param code the return number of BeginTransaction
- * @param mutex transmission parameter : lock
  *
  * @return BeginTransaction emptiness true or false
  */
-bool DownloadDataAbility::IsBeginTransactionOK(int code, std::mutex &mutex)
+bool DownloadDataAbility::IsBeginTransactionOK(int code)
 {
-    mutex.try_lock();
     if (code != 0) {
         DOWNLOAD_HILOGE("IsBeginTransactionOK fail");
-        mutex.unlock();
         return false;
     }
     return true;
@@ -96,16 +239,13 @@ bool DownloadDataAbility::IsBeginTransactionOK(int code, std::mutex &mutex)
  * @brief DownloadDataAbility Commit emptiness problems
  *
  * @param code the return number of Commit
- * @param mutex transmission parameter : lock
  *
  * @return Commit emptiness true or false
  */
-bool DownloadDataAbility::IsCommitOk(int code, std::mutex &mutex)
+bool DownloadDataAbility::IsCommitOk(int code)
 {
-    mutex.try_lock();
     if (code != 0) {
         DOWNLOAD_HILOGE("IsCommitOk fail");
-        mutex.unlock();
         return false;
     }
     return true;
@@ -128,30 +268,29 @@ int DownloadDataAbility::Insert(const Uri &uri, const NativeRdb::ValuesBucket &v
         DOWNLOAD_HILOGE("DownloadDataAbility CheckValuesBucket is error");
         return RDB_EXECUTE_FAIL;
     }
-    g_mutex.lock();
-    database_ = DownloadDataBase::GetInstance();
-    int ret = database_->BeginTransaction();
-    if (!IsBeginTransactionOK(ret, g_mutex)) {
-        g_mutex.unlock();
-        return RDB_EXECUTE_FAIL;
-    }
-    int resultId = InsertExecute(uri, value);
-    DOWNLOAD_HILOGE("DownloadDataAbility Insert id %{public}d", resultId);
-    if (resultId == OPERATION_ERROR) {
-        DOWNLOAD_HILOGE("DownloadDataAbility Insert error");
-        ret = database_->RollBack();
-        g_mutex.unlock();
-        return OPERATION_ERROR;
-    }
-    ret = database_->Commit();
-    if (!IsCommitOk(ret, g_mutex)) {
-        DOWNLOAD_HILOGE("DownloadDataAbility Insert error Commit");
-        database_->RollBack();
-        g_mutex.unlock();
-        return RDB_EXECUTE_FAIL;
+    int resultId = RDB_EXECUTE_FAIL;
+    {
+        std::lock_guard<std::mutex> autoLock(g_writeMutex);
+        database_ = DownloadDataBase::GetInstance();
+        int ret = database_->BeginTransaction();
+        if (!IsBeginTransactionOK(ret)) {
+            return RDB_EXECUTE_FAIL;
+        }
+        resultId = InsertExecute(uri, value);
+        DOWNLOAD_HILOGE("DownloadDataAbility Insert id %{public}d", resultId);
+        if (resultId == OPERATION_ERROR) {
+            DOWNLOAD_HILOGE("DownloadDataAbility Insert error");
+            database_->RollBack();
+            return OPERATION_ERROR;
+        }
+        ret = database_->Commit();
+        if (!IsCommitOk(ret)) {
+            DOWNLOAD_HILOGE("DownloadDataAbility Insert error Commit");
+            database_->RollBack();
+            return RDB_EXECUTE_FAIL;
+        }
     }
-    g_mutex.unlock();
-    DataBaseNotifyChange(DOWNLOAD_INSERT, uri);
+    DataBaseNotifyChange(DOWNLOAD_INSERT, resultId, resultId, 1);
     return resultId;
 }
 
@@ -188,41 +327,48 @@ int DownloadDataAbility::BatchInsert(const Uri &uri, const std::vector<NativeRdb
         DOWNLOAD_HILOGE("BatchInsert value is error");
         return rowRet;
     }
-    g_mutex.lock();
-    database_ = DownloadDataBase::GetInstance();
-    int ret = database_->BeginTransaction();
-    if (!IsBeginTransactionOK(ret, g_mutex)) {
-        g_mutex.unlock();
-        return RDB_EXECUTE_FAIL;
+    SqlAnalyzer sqlAnalyzer;
+    for (const auto &value : values) {
+        if (!sqlAnalyzer.CheckValuesBucket(value)) {
+            DOWNLOAD_HILOGE("DownloadDataAbility CheckValuesBucket is error");
+            return RDB_EXECUTE_FAIL;
+        }
     }
-    int count = 0;
-    for (int i = 0; i < size; i++) {
-        ++count;
-        OHOS::NativeRdb::ValuesBucket rawValues = values[i];
-        int code = InsertExecute(uri, rawValues);
-        if (code == RDB_EXECUTE_FAIL) {
-            database_->RollBack();
-            g_mutex.unlock();
-            return code;
+    int64_t startId = CHANGE_ID_UNKNOWN;
+    int64_t endId = CHANGE_ID_UNKNOWN;
+    {
+        std::lock_guard<std::mutex> autoLock(g_writeMutex);
+        database_ = DownloadDataBase::GetInstance();
+        int ret = database_->BeginTransaction();
+        if (!IsBeginTransactionOK(ret)) {
+            return RDB_EXECUTE_FAIL;
         }
-        if (count % TRANSACTION_COUNT == 0) {
-            int markRet = database_->Commit();
-            int beginRet = database_->BeginTransaction();
-            if (!IsCommitOk(markRet, g_mutex) || !IsBeginTransactionOK(beginRet, g_mutex)) {
+        int count = 0;
+        for (int i = 0; i < size; i++) {
+            ++count;
+            int code = InsertExecute(uri, values[i]);
+            if (code == RDB_EXECUTE_FAIL) {
                 database_->RollBack();
-                g_mutex.unlock();
-                return RDB_EXECUTE_FAIL;
+                return code;
+            }
+            startId = (startId == CHANGE_ID_UNKNOWN) ? code : std::min<int64_t>(startId, code);
+            endId = std::max<int64_t>(endId, code);
+            if (count % TRANSACTION_COUNT == 0) {
+                int markRet = database_->Commit();
+                int beginRet = database_->BeginTransaction();
+                if (!IsCommitOk(markRet) || !IsBeginTransactionOK(beginRet)) {
+                    database_->RollBack();
+                    return RDB_EXECUTE_FAIL;
+                }
             }
         }
+        int markRet = database_->Commit();
+        if (!IsCommitOk(markRet)) {
+            database_->RollBack();
+            return RDB_EXECUTE_FAIL;
+        }
     }
-    int markRet = database_->Commit();
-    if (!IsCommitOk(markRet, g_mutex)) {
-        database_->RollBack();
-        g_mutex.unlock();
-        return RDB_EXECUTE_FAIL;
-    }
-    g_mutex.unlock();
-    DataBaseNotifyChange(DOWNLOAD_INSERT, uri);
+    DataBaseNotifyChange(DOWNLOAD_INSERT, startId, endId, size);
     return RDB_EXECUTE_OK;
 }
 
@@ -243,7 +389,7 @@ int DownloadDataAbility::Update(
         DOWNLOAD_HILOGE("DownloadDataAbility CheckValuesBucket is error");
         return RDB_EXECUTE_FAIL;
     }
-    g_mutex.lock();
+    std::unique_lock<std::mutex> lock(g_writeMutex);
     database_ = DownloadDataBase::GetInstance();
     PredicatesConvert predicatesConvert;
     int ret = RDB_EXECUTE_FAIL;
@@ -251,17 +397,21 @@ int DownloadDataAbility::Update(
     int parseCode = UriParse(uriTemp);
     OHOS::NativeRdb::DataAbilityPredicates dataAbilityPredicates = predicates;
     OHOS::NativeRdb::RdbPredicates rdbPredicates("");
+    int count = 0;
     switch (parseCode) {
         case DOWNLOAD_INFO:
             rdbPredicates = predicatesConvert.ConvertPredicates(TABLE_NAME, dataAbilityPredicates);
-            ret = database_->Update(value, rdbPredicates);
+            ret = database_->Update(value, rdbPredicates, count);
             break;
         default:
             DOWNLOAD_HILOGE("DownloadDataAbility ====>no match uri action");
             break;
     }
-    g_mutex.unlock();
-    DataBaseNotifyChange(DOWNLOAD_UPDATE, uri);
+    lock.unlock();
+    if (ret == RDB_EXECUTE_OK && count > 0) {
+        // the changed rows come from the statement itself, their ids are not looked up with an extra query
+        DataBaseNotifyChange(DOWNLOAD_UPDATE, CHANGE_ID_UNKNOWN, CHANGE_ID_UNKNOWN, count);
+    }
     return ret;
 }
 
@@ -275,7 +425,7 @@ int DownloadDataAbility::Update(
  */
 int DownloadDataAbility::Delete(const Uri &uri, const NativeRdb::DataAbilityPredicates &predicates)
 {
-    g_mutex.lock();
+    std::unique_lock<std::mutex> lock(g_writeMutex);
     database_ = DownloadDataBase::GetInstance();
     PredicatesConvert predicatesConvert;
     int ret = RDB_EXECUTE_FAIL;
@@ -283,34 +433,95 @@ int DownloadDataAbility::Delete(const Uri &uri, const NativeRdb::DataAbilityPred
     int parseCode = UriParse(uriTemp);
     OHOS::NativeRdb::DataAbilityPredicates dataAbilityPredicates = predicates;
     OHOS::NativeRdb::RdbPredicates rdbPredicates("");
+    int count = 0;
     switch (parseCode) {
         case DOWNLOAD_INFO:
             rdbPredicates = predicatesConvert.ConvertPredicates(TABLE_NAME, dataAbilityPredicates);
-            ret = database_->Delete(rdbPredicates);
+            ret = database_->Delete(rdbPredicates, count);
             break;
         default:
             DOWNLOAD_HILOGE("DownloadDataAbility ====>no match uri action");
             break;
     }
-    g_mutex.unlock();
-    DataBaseNotifyChange(DOWNLOAD_DELETE, uri);
+    lock.unlock();
+    if (ret == RDB_EXECUTE_OK && count > 0) {
+        // the changed rows come from the statement itself, their ids are not looked up with an extra query
+        DataBaseNotifyChange(DOWNLOAD_DELETE, CHANGE_ID_UNKNOWN, CHANGE_ID_UNKNOWN, count);
+    }
     return ret;
 }
 
+/**
+ * @brief DownloadDataAbility parse the keyset page of a query
+ *
+ * @param uri query uri, paged by "?cursor=<last taskid>&limit=<rows>&order=asc|desc"
+ * @param page page parsed from the uri
+ * @param isPaged whether the uri asks for a page
+ *
+ * @return false if a page parameter is malformed
+ */
+bool DownloadDataAbility::ParseQueryPage(const Uri &uri, QueryPage &page, bool &isPaged)
+{
+    OHOS::Uri uriTemp = uri;
+    UriUtils uriUtils;
+    std::map<std::string, std::string> params = uriUtils.getQueryParameter(uriTemp);
+    isPaged = false;
+    page.limit = QUERY_DEFAULT_PAGE_SIZE;
+    for (const auto &param : params) {
+        char *end = nullptr;
+        if ((param.first == QUERY_PARAM_CURSOR || param.first == QUERY_PARAM_LIMIT) && param.second.empty()) {
+            return false;
+        }
+        if (param.first == QUERY_PARAM_CURSOR) {
+            page.cursor = std::strtoll(param.second.c_str(), &end, DECIMAL);
+            page.hasCursor = true;
+        } else if (param.first == QUERY_PARAM_LIMIT) {
+            page.limit = static_cast<int>(std::strtol(param.second.c_str(), &end, DECIMAL));
+            if (page.limit <= 0) {
+                return false;
+            }
+        } else if (param.first == QUERY_PARAM_ORDER) {
+            page.descending = param.second == QUERY_ORDER_DESC;
+            isPaged = true;
+            continue;
+        } else {
+            continue;
+        }
+        if (end == nullptr || *end != '\0') {
+            return false;
+        }
+        isPaged = true;
+    }
+    page.limit = std::min(page.limit, QUERY_MAX_ROWS);
+    return true;
+}
+
+bool DownloadDataAbility::IsValidProjection(const std::vector<std::string> &columns)
+{
+    for (const auto &column : columns) {
+        if (DOWNLOAD_COLUMNS.find(column) == DOWNLOAD_COLUMNS.end()) {
+            DOWNLOAD_HILOGE("DownloadDataAbility unknown column %{public}s", column.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * @brief DownloadDataAbility Query database
  *
- * @param uri Determine the data table name based on the URI
+ * @param uri Determine the data table name based on the URI, optionally with a keyset page
  * @param columns Columns returned by query
  * @param predicates Query the data values of the condition
  *
- * @return Query database results
+ * @return Query database results, a page never holds more than QUERY_MAX_ROWS rows
  */
 std::shared_ptr<NativeRdb::AbsSharedResultSet> DownloadDataAbility::Query(
     const Uri &uri, const std::vector<std::string> &columns, const NativeRdb::DataAbilityPredicates &predicates)
 {
     DOWNLOAD_HILOGI("DownloadDataAbility ====>Query start");
-    database_ = DownloadDataBase::GetInstance();
+    // readers do not take the write lock, so they must not touch the shared database_ member either
+    std::shared_ptr<DownloadDataBase> database = DownloadDataBase::GetInstance();
     PredicatesConvert predicatesConvert;
     std::shared_ptr<NativeRdb::AbsSharedResultSet> result;
     OHOS::Uri uriTemp = uri;
@@ -319,10 +530,21 @@ std::shared_ptr<NativeRdb::AbsSharedResultSet> DownloadDataAbility::Query(
     OHOS::NativeRdb::DataAbilityPredicates dataAbilityPredicates = predicates;
     OHOS::NativeRdb::RdbPredicates rdbPredicates("");
     std::vector<std::string> columnsTemp = columns;
+    QueryPage page;
+    bool isPaged = false;
+    if (!ParseQueryPage(uri, page, isPaged) || !IsValidProjection(columns)) {
+        DOWNLOAD_HILOGE("DownloadDataAbility ====>invalid query");
+        return nullptr;
+    }
     switch (parseCode) {
         case DOWNLOAD_INFO:
-            rdbPredicates = predicatesConvert.ConvertPredicates(TABLE_NAME, dataAbilityPredicates);
-            result = database_->Query(rdbPredicates, columnsTemp);
+            if (isPaged) {
+                rdbPredicates = predicatesConvert.ConvertPagePredicates(TABLE_NAME, dataAbilityPredicates, page);
+            } else {
+                // callers that don't page keep getting every matching row
+                rdbPredicates = predicatesConvert.ConvertPredicates(TABLE_NAME, dataAbilityPredicates);
+            }
+            result = database->Query(rdbPredicates, columnsTemp);
             break;
         default:
             DOWNLOAD_HILOGE("DownloadDataAbility ====>no match uri action");
@@ -333,8 +555,8 @@ std::shared_ptr<NativeRdb::AbsSharedResultSet> DownloadDataAbility::Query(
     return sharedPtrResult;
 }
 
-void DownloadDataAbility::DataBaseNotifyChange(int code, Uri uri)
+void DownloadDataAbility::DataBaseNotifyChange(int code, int64_t startId, int64_t endId, int64_t count)
 {
-    CommonEvent::SendChange(code);
+    ChangeNotifier::GetInstance().Notify(code, startId, endId, count);
 }
 } // namespace OHOS::AppExecFwk
\ No newline at end of file
@@ -15,23 +15,37 @@
 
 #include "download_database.h"
 
+#include <ctime>
+
 #include "constant.h"
 #include "db_path.h"
 #include "log.h"
 
 namespace OHOS::Request::Download {
+std::mutex DownloadDataBase::instanceLock_;
 std::shared_ptr<DownloadDataBase> DownloadDataBase::instance_ = nullptr;
 std::shared_ptr<OHOS::NativeRdb::RdbStore> DownloadDataBase::store_ = nullptr;
 static std::string g_databaseName;
 
+/*
+ * Only records whose terminal status was written back by the client are pruned. A record without a status
+ * may belong to a task that is still running, pending or paused, so it is kept.
+ */
+static std::string GetFinishedClause()
+{
+    return "([status] IN (" + std::to_string(SESSION_SUCCESS) + ", " + std::to_string(SESSION_FAILED) + "))";
+}
+
 DownloadDataBase::DownloadDataBase()
 {
     g_databaseName = DBPath::RDB_PATH + DB_NAME;
     DOWNLOAD_HILOGI("DownloadDataBase g_databaseName :%{public}s", g_databaseName.c_str());
     int errCode = OHOS::NativeRdb::E_OK;
     OHOS::NativeRdb::RdbStoreConfig config(g_databaseName);
+    // WAL lets queries read a consistent snapshot while the single writer commits
+    config.SetJournalMode(OHOS::NativeRdb::JournalMode::MODE_WAL);
     SqliteOpenHelperDownloadCallback sqliteOpenHelperCallback;
-    store_ = OHOS::NativeRdb::RdbHelper::GetRdbStore(config, DATABASE_OPEN_VERSION, sqliteOpenHelperCallback, errCode);
+    store_ = OHOS::NativeRdb::RdbHelper::GetRdbStore(config, DATABASE_NEW_VERSION, sqliteOpenHelperCallback, errCode);
     if (errCode != OHOS::NativeRdb::E_OK) {
         DOWNLOAD_HILOGE("DownloadDataBase errCode :%{public}d", errCode);
     } else {
@@ -41,6 +55,7 @@ DownloadDataBase::DownloadDataBase()
 
 std::shared_ptr<DownloadDataBase> DownloadDataBase::GetInstance()
 {
+    std::lock_guard<std::mutex> autoLock(instanceLock_);
     if (instance_ == nullptr) {
         instance_.reset(new DownloadDataBase());
         return instance_;
@@ -101,6 +116,9 @@ int64_t DownloadDataBase::Insert(OHOS::NativeRdb::ValuesBucket insertValues)
         DOWNLOAD_HILOGE("DownloadDataBase Insert store_ is  nullptr");
         return RDB_OBJECT_EMPTY;
     }
+    if (!insertValues.HasColumn("createTime")) {
+        insertValues.PutLong("createTime", static_cast<int64_t>(time(nullptr)));
+    }
 
     int ret = store_->Insert(outRowId, TABLE_NAME, insertValues);
     DOWNLOAD_HILOGI("DownloadDataBase Insert id = %{public}lld ", (long long)outRowId);
@@ -116,17 +134,19 @@ int64_t DownloadDataBase::Insert(OHOS::NativeRdb::ValuesBucket insertValues)
  *
  * @param values Conditions for update operation
  * @param predicates Conditions for update operation
+ * @param changeRow number of updated rows
  *
  * @return Update operation results
  */
-int DownloadDataBase::Update(OHOS::NativeRdb::ValuesBucket values, OHOS::NativeRdb::RdbPredicates &predicates)
+int DownloadDataBase::Update(
+    OHOS::NativeRdb::ValuesBucket values, OHOS::NativeRdb::RdbPredicates &predicates, int &changeRow)
 {
+    changeRow = 0;
     if (store_ == nullptr) {
         DOWNLOAD_HILOGE("DownloadDataBase Update store_ is nullptr");
         return RDB_OBJECT_EMPTY;
     }
 
-    int changeRow;
     int ret = store_->Update(changeRow, values, predicates);
     if (ret != OHOS::NativeRdb::E_OK) {
         DOWNLOAD_HILOGE("DownloadDataBase Update ret :%{public}d", ret);
@@ -139,16 +159,17 @@ int DownloadDataBase::Update(OHOS::NativeRdb::ValuesBucket values, OHOS::NativeR
  * @brief Delete operation
  *
  * @param predicates Conditions for delete operation
+ * @param deleteRow number of deleted rows
  *
  * @return Delete operation results
  */
-int DownloadDataBase::Delete(OHOS::NativeRdb::RdbPredicates &predicates)
+int DownloadDataBase::Delete(OHOS::NativeRdb::RdbPredicates &predicates, int &deleteRow)
 {
+    deleteRow = 0;
     if (store_ == nullptr) {
         DOWNLOAD_HILOGE("DownloadDataBase Delete store_ is  nullptr");
         return RDB_OBJECT_EMPTY;
     }
-    int deleteRow;
     int ret = store_->Delete(deleteRow, predicates);
     if (ret != OHOS::NativeRdb::E_OK) {
         DOWNLOAD_HILOGE("DownloadDataBase Delete ret :%{public}d", ret);
@@ -176,17 +197,191 @@ std::unique_ptr<OHOS::NativeRdb::AbsSharedResultSet> DownloadDataBase::Query(
     return result;
 }
 
+/**
+ * @brief Delete up to batchSize of the oldest finished records matching whereClause
+ *
+ * @return number of deleted records, RDB_EXECUTE_FAIL on error
+ */
+int DownloadDataBase::PruneOldest(
+    const std::string &whereClause, const std::vector<std::string> &whereArgs, int batchSize)
+{
+    if (store_ == nullptr) {
+        DOWNLOAD_HILOGE("DownloadDataBase Prune store_ is nullptr");
+        return RDB_EXECUTE_FAIL;
+    }
+    std::string selection = GetFinishedClause();
+    if (!whereClause.empty()) {
+        selection += " AND " + whereClause;
+    }
+    OHOS::NativeRdb::RdbPredicates predicates(TABLE_NAME);
+    predicates.SetWhereClause("[taskid] IN (SELECT [taskid] FROM [downloadInfo] WHERE " + selection +
+        " ORDER BY [taskid] LIMIT " + std::to_string(batchSize) + ")");
+    predicates.SetWhereArgs(whereArgs);
+    int deleteRow = 0;
+    int ret = store_->Delete(deleteRow, predicates);
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("DownloadDataBase Prune ret :%{public}d", ret);
+        return RDB_EXECUTE_FAIL;
+    }
+    return deleteRow;
+}
+
+/**
+ * @brief Delete one batch of finished records created before expireTime
+ *
+ * @param expireTime seconds since epoch
+ * @param batchSize maximum records deleted by this call
+ *
+ * @return number of deleted records, RDB_EXECUTE_FAIL on error
+ */
+int DownloadDataBase::PruneExpired(int64_t expireTime, int batchSize)
+{
+    return PruneOldest("[createTime] < ?", {std::to_string(expireTime)}, batchSize);
+}
+
+/**
+ * @brief Delete one batch of the oldest finished records above maxRows
+ *
+ * @param maxRows number of records kept
+ * @param batchSize maximum records deleted by this call
+ *
+ * @return number of deleted records, RDB_EXECUTE_FAIL on error
+ */
+int DownloadDataBase::PruneOverflow(int64_t maxRows, int batchSize)
+{
+    if (store_ == nullptr) {
+        DOWNLOAD_HILOGE("DownloadDataBase PruneOverflow store_ is nullptr");
+        return RDB_EXECUTE_FAIL;
+    }
+    int64_t count = 0;
+    int ret = store_->ExecuteAndGetLong(count, "SELECT COUNT(*) FROM [downloadInfo]");
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("DownloadDataBase PruneOverflow count ret :%{public}d", ret);
+        return RDB_EXECUTE_FAIL;
+    }
+    if (count <= maxRows) {
+        return 0;
+    }
+    int64_t excess = count - maxRows;
+    return PruneOldest("", {}, excess < batchSize ? static_cast<int>(excess) : batchSize);
+}
+
+/**
+ * @brief Switch a database created before incremental vacuum to it, rebuilding the file once
+ *
+ * @return true if the database uses incremental vacuum
+ */
+bool DownloadDataBase::EnableIncrementalVacuum()
+{
+    if (store_ == nullptr) {
+        DOWNLOAD_HILOGE("DownloadDataBase EnableIncrementalVacuum store_ is nullptr");
+        return false;
+    }
+    int64_t mode = 0;
+    if (store_->ExecuteAndGetLong(mode, QUERY_AUTO_VACUUM) != OHOS::NativeRdb::E_OK) {
+        return false;
+    }
+    if (mode == AUTO_VACUUM_INCREMENTAL) {
+        return true;
+    }
+    DOWNLOAD_HILOGI("DownloadDataBase convert auto_vacuum from %{public}lld", (long long)mode);
+    if (store_->ExecuteSql(ENABLE_INCREMENTAL_VACUUM) != OHOS::NativeRdb::E_OK ||
+        store_->ExecuteSql("VACUUM") != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("DownloadDataBase EnableIncrementalVacuum fail");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Return up to pages free pages to the file system
+ */
+void DownloadDataBase::IncrementalVacuum(int pages)
+{
+    if (store_ == nullptr) {
+        DOWNLOAD_HILOGE("DownloadDataBase IncrementalVacuum store_ is nullptr");
+        return;
+    }
+    int ret = store_->ExecuteSql("PRAGMA incremental_vacuum(" + std::to_string(pages) + ")");
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("DownloadDataBase IncrementalVacuum ret :%{public}d", ret);
+    }
+}
+
 int SqliteOpenHelperDownloadCallback::OnCreate(OHOS::NativeRdb::RdbStore &store)
 {
     DOWNLOAD_HILOGD("Download DB OnCreat Enter");
+    if (store.ExecuteSql(ENABLE_INCREMENTAL_VACUUM) != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("SqliteOpenHelperDownloadCallback enable incremental vacuum error");
+    }
     if (store.ExecuteSql(CREATE_DOWNLOAD) != OHOS::NativeRdb::E_OK) {
         DOWNLOAD_HILOGE("SqliteOpenHelperDownloadCallback create table error");
     }
+    CreateIndexes(store);
     return OHOS::NativeRdb::E_OK;
 }
 
+int SqliteOpenHelperDownloadCallback::CreateIndexes(OHOS::NativeRdb::RdbStore &store)
+{
+    int ret = store.ExecuteSql(CREATE_DOWNLOAD_STATUS_INDEX);
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("SqliteOpenHelperDownloadCallback create status index error");
+        return ret;
+    }
+    ret = store.ExecuteSql(CREATE_DOWNLOAD_URL_INDEX);
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("SqliteOpenHelperDownloadCallback create url index error");
+        return ret;
+    }
+    ret = store.ExecuteSql(CREATE_DOWNLOAD_CREATE_TIME_INDEX);
+    if (ret != OHOS::NativeRdb::E_OK) {
+        DOWNLOAD_HILOGE("SqliteOpenHelperDownloadCallback create createTime index error");
+    }
+    return ret;
+}
+
+/**
+ * @brief Migrate the schema from fromVersion to fromVersion + 1
+ *
+ * @return E_OK if the step succeeded
+ */
+int SqliteOpenHelperDownloadCallback::UpgradeStep(OHOS::NativeRdb::RdbStore &store, int fromVersion)
+{
+    int ret = OHOS::NativeRdb::E_OK;
+    switch (fromVersion) {
+        case DATABASE_OPEN_VERSION:
+            ret = store.ExecuteSql(CREATE_DOWNLOAD_STATUS_INDEX);
+            if (ret == OHOS::NativeRdb::E_OK) {
+                ret = store.ExecuteSql(CREATE_DOWNLOAD_URL_INDEX);
+            }
+            break;
+        case DATABASE_INDEX_VERSION:
+            // rows written before the column existed start aging from the upgrade
+            ret = store.ExecuteSql("ALTER TABLE [downloadInfo] ADD COLUMN [createTime] INTEGER");
+            if (ret == OHOS::NativeRdb::E_OK) {
+                ret = store.ExecuteSql("UPDATE [downloadInfo] SET [createTime] = ?",
+                    {OHOS::NativeRdb::ValueObject(static_cast<int64_t>(time(nullptr)))});
+            }
+            if (ret == OHOS::NativeRdb::E_OK) {
+                ret = store.ExecuteSql(CREATE_DOWNLOAD_CREATE_TIME_INDEX);
+            }
+            break;
+        default:
+            break;
+    }
+    return ret;
+}
+
 int SqliteOpenHelperDownloadCallback::OnUpgrade(OHOS::NativeRdb::RdbStore &store, int oldVersion, int newVersion)
 {
+    DOWNLOAD_HILOGI("Download DB upgrade from %{public}d to %{public}d", oldVersion, newVersion);
+    for (int version = oldVersion; version < newVersion; version++) {
+        int ret = UpgradeStep(store, version);
+        if (ret != OHOS::NativeRdb::E_OK) {
+            DOWNLOAD_HILOGE("Download DB upgrade from version %{public}d fail :%{public}d", version, ret);
+            return ret;
+        }
+    }
     return OHOS::NativeRdb::E_OK;
 }
 
@@ -16,6 +16,9 @@
 #include "predicates_convert.h"
 
 namespace OHOS::Request::Download {
+constexpr const char *PAGE_KEY = "taskid";
+constexpr int NO_OFFSET = -1;
+
 PredicatesConvert::PredicatesConvert(void)
 {
 }
@@ -35,6 +38,25 @@ OHOS::NativeRdb::RdbPredicates PredicatesConvert::ConvertPredicates(
     return predicates;
 }
 
+OHOS::NativeRdb::RdbPredicates PredicatesConvert::ConvertPagePredicates(std::string tableName,
+    OHOS::NativeRdb::DataAbilityPredicates &dataPredicates, const QueryPage &page)
+{
+    OHOS::NativeRdb::RdbPredicates predicates(tableName);
+    std::string whereClause = dataPredicates.GetWhereClause();
+    std::vector<std::string> whereArgs = dataPredicates.GetWhereArgs();
+    if (page.hasCursor) {
+        std::string keyset = std::string(PAGE_KEY) + (page.descending ? " < ?" : " > ?");
+        whereClause = whereClause.empty() ? keyset : "(" + whereClause + ") AND " + keyset;
+        whereArgs.push_back(std::to_string(page.cursor));
+    }
+    OHOS::NativeRdb::PredicatesUtils::SetWhereClauseAndArgs(&predicates, whereClause, whereArgs);
+    // the page order must follow the key, any order or offset of the caller would break the cursor
+    std::string order = std::string(PAGE_KEY) + (page.descending ? " DESC" : " ASC");
+    OHOS::NativeRdb::PredicatesUtils::SetAttributes(&predicates, dataPredicates.IsDistinct(), dataPredicates.GetIndex(),
+        dataPredicates.GetGroup(), order, page.limit, NO_OFFSET);
+    return predicates;
+}
+
 OHOS::NativeRdb::RdbPredicates PredicatesConvert::CopyPredicates(
     std::string tableName, OHOS::NativeRdb::RdbPredicates &oldRdbPredicates)
 {
@@ -13,10 +13,81 @@
  * limitations under the License.
  */
 #include "sql_analyzer.h"
+
+#include <cstdint>
+#include <cstring>
+
 #include "log.h"
 
 namespace OHOS::Request::Download {
-constexpr int POS_ADD_TWO = 2;
+namespace {
+constexpr std::size_t POS_ADD_TWO = 2;
+constexpr uint64_t LOW_BITS = 0x0101010101010101ULL;
+constexpr uint64_t HIGH_BITS = 0x8080808080808080ULL;
+constexpr char SPECIAL_CHARS[] = { '\'', '"', '`', ';', '-', '/', '[' };
+
+// non-zero if any byte of word equals ch
+inline uint64_t MatchByte(uint64_t word, unsigned char ch)
+{
+    uint64_t diff = word ^ (LOW_BITS * ch);
+    return (diff - LOW_BITS) & ~diff & HIGH_BITS;
+}
+
+/*
+ * Answers "is there a closing token at or after pos" in O(1) by remembering the last index of each
+ * token, which is computed once on first use. This keeps the scan linear in the length of the value.
+ */
+class ClosingIndex {
+public:
+    explicit ClosingIndex(const std::string &sql) : sql_(sql)
+    {
+        for (auto &last : lastChar_) {
+            last = UNKNOWN;
+        }
+    }
+
+    bool HasChar(char ch, std::size_t pos)
+    {
+        std::size_t &last = lastChar_[Slot(ch)];
+        if (last == UNKNOWN) {
+            last = sql_.rfind(ch);
+        }
+        return last != std::string::npos && last >= pos;
+    }
+
+    bool HasCommentEnd(std::size_t pos)
+    {
+        if (lastCommentEnd_ == UNKNOWN) {
+            lastCommentEnd_ = sql_.rfind("*/");
+        }
+        return lastCommentEnd_ != std::string::npos && lastCommentEnd_ >= pos;
+    }
+
+private:
+    static constexpr std::size_t UNKNOWN = std::string::npos - 1;
+    static constexpr std::size_t SLOT_NUM = 5;
+
+    static std::size_t Slot(char ch)
+    {
+        switch (ch) {
+            case '\'':
+                return 0;
+            case '"':
+                return 1;
+            case '`':
+                return 2;
+            case ']':
+                return 3;
+            default:
+                return 4; // '\n'
+        }
+    }
+
+    const std::string &sql_;
+    std::size_t lastChar_[SLOT_NUM];
+    std::size_t lastCommentEnd_ = UNKNOWN;
+};
+} // namespace
 
 SqlAnalyzer::SqlAnalyzer()
 {
@@ -30,17 +101,17 @@ bool SqlAnalyzer::CheckValuesBucket(const NativeRdb::ValuesBucket &value)
 {
     std::map<std::string, NativeRdb::ValueObject> valuesMap;
     value.GetAll(valuesMap);
+    std::string str;
     for (auto it = valuesMap.begin(); it != valuesMap.end(); ++it) {
-        std::string key = it->first;
+        const std::string &key = it->first;
         bool isKey = FindIllegalWords(key);
         if (isKey) {
             DOWNLOAD_HILOGE("SqlAnalyzer CheckValuesBucket key is %{public}s error", key.c_str());
             return false;
         }
-        NativeRdb::ValueObject value = it->second;
-        if (value.GetType() == NativeRdb::ValueObjectType::TYPE_STRING) {
-            std::string str;
-            value.GetString(str);
+        const NativeRdb::ValueObject &object = it->second;
+        if (object.GetType() == NativeRdb::ValueObjectType::TYPE_STRING) {
+            object.GetString(str);
             bool isValue = FindIllegalWords(str);
             if (isValue) {
                 DOWNLOAD_HILOGE("SqlAnalyzer CheckValuesBucket value is %{public}s error", str.c_str());
@@ -51,88 +122,92 @@ bool SqlAnalyzer::CheckValuesBucket(const NativeRdb::ValuesBucket &value)
     return true;
 }
 
-bool SqlAnalyzer::CharCheck(char &ch, std::string sql, std::size_t &pos)
+/*
+ * Only quotes, ";", "--", comment openers and "[" can make a value illegal, so a value without any of them is
+ * accepted without scanning. Eight bytes are tested per step.
+ */
+bool SqlAnalyzer::HasSpecialChar(const std::string &sql)
 {
-    if (ch == '[') {
-        pos++;
-        std::size_t found = sql.find(']', pos);
-        if (found == std::string::npos) {
-            return true;
+    const char *data = sql.data();
+    std::size_t length = sql.length();
+    std::size_t pos = 0;
+    for (; pos + sizeof(uint64_t) <= length; pos += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        memcpy(&word, data + pos, sizeof(uint64_t));
+        uint64_t match = 0;
+        for (char ch : SPECIAL_CHARS) {
+            match |= MatchByte(word, static_cast<unsigned char>(ch));
         }
-        pos++;
-    }
-    if (ch == '-' && PickChar(sql, pos + 1) == '-') {
-        pos += POS_ADD_TWO;
-        std::size_t found = sql.find('\n', pos);
-        if (found == std::string::npos) {
+        if (match != 0) {
             return true;
         }
-        pos++;
     }
-    if (ch == '/' && PickChar(sql, pos + 1) == '*') {
-        pos += POS_ADD_TWO;
-        std::size_t found = sql.find("*/", pos);
-        if (found == std::string::npos) {
+    for (; pos < length; pos++) {
+        if (memchr(SPECIAL_CHARS, data[pos], sizeof(SPECIAL_CHARS)) != nullptr) {
             return true;
         }
-        pos += POS_ADD_TWO;
-    }
-    if (ch == ';') {
-        return true;
     }
-    pos++;
     return false;
 }
 
-bool SqlAnalyzer::StrCheck(char &ch, std::size_t strlen, std::string sql, std::size_t &pos)
-{
-    if (IsInStr(ch, "'\"`") == 0) {
-        pos++;
-        while (pos < strlen) {
-            std::size_t found = sql.find(ch, pos);
-            if (found == std::string::npos) {
-                return true;
-            }
-            if (PickChar(sql, pos + 1) != ch) {
-                break;
-            }
-            pos += POS_ADD_TWO;
-        }
-    }
-    return false;
-}
-
-bool SqlAnalyzer::FindIllegalWords(std::string sql)
+/*
+ * Single pass over the value without copies. The accepted language is the same as before: the
+ * character following an identifier is skipped, and quoted text, "[", "--" and comment openers only need a
+ * closing token somewhere behind them.
+ */
+bool SqlAnalyzer::FindIllegalWords(const std::string &sql)
 {
-    if (sql.empty()) {
+    if (sql.empty() || !HasSpecialChar(sql)) {
         return false;
     }
-    std::size_t pos = 0;
+    ClosingIndex closing(sql);
+    const char *data = sql.data();
     std::size_t strlen = sql.length();
+    auto pickChar = [data, strlen](std::size_t index) { return index < strlen ? data[index] : '\0'; };
+    std::size_t pos = 0;
     while (pos < strlen) {
-        char ch = PickChar(sql, pos);
+        char ch = data[pos];
+        if (IsQuote(ch)) {
+            pos++;
+            while (pos < strlen) {
+                if (!closing.HasChar(ch, pos)) {
+                    return true;
+                }
+                if (pickChar(pos + 1) != ch) {
+                    break;
+                }
+                pos += POS_ADD_TWO;
+            }
+            continue;
+        }
         if (IsLetter(ch)) {
-            std::size_t start = pos;
             pos++;
-            while (IsLetterNumber(PickChar(sql, pos))) {
+            while (IsLetterNumber(pickChar(pos))) {
                 pos++;
             }
-            std::size_t count = pos - start + 1;
-            sql.substr(start, count);
-        }
-        if (IsInStr(ch, "'\"`") == 0) {
-            if (StrCheck(ch, strlen, sql, pos)) {
+        } else if (ch == '[') {
+            pos++;
+            if (!closing.HasChar(']', pos)) {
                 return true;
-            } else {
-                continue;
             }
-        }
-        if (CharCheck(ch, sql, pos)) {
+            pos++;
+        } else if (ch == '-' && pickChar(pos + 1) == '-') {
+            pos += POS_ADD_TWO;
+            if (!closing.HasChar('\n', pos)) {
+                return true;
+            }
+            pos++;
+        } else if (ch == '/' && pickChar(pos + 1) == '*') {
+            pos += POS_ADD_TWO;
+            if (!closing.HasCommentEnd(pos)) {
+                return true;
+            }
+            pos += POS_ADD_TWO;
+        } else if (ch == ';') {
             return true;
-        } else {
-            continue;
         }
+        pos++;
     }
     return false;
 }
-} // namespace OHOS::Request::Download
\ No newline at end of file
+} // namespace OHOS::Request::Download
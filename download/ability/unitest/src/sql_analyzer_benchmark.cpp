@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+
+#include "sql_analyzer.h"
+
+namespace OHOS::Request::Download {
+namespace {
+constexpr int64_t URL_MIN_LENGTH = 256;
+constexpr int64_t URL_MAX_LENGTH = 1024 * 1024;
+constexpr int64_t URL_LENGTH_STEP = 16;
+constexpr int64_t QUERY_EVERY = 8;
+
+// a description made of words only, none of the characters that can make a value illegal
+std::string MakeText(int64_t length)
+{
+    std::string text;
+    while (static_cast<int64_t>(text.length()) < length) {
+        text += "download of the nightly build ";
+    }
+    text.resize(static_cast<std::size_t>(length));
+    return text;
+}
+
+// a plausible download url of the given length, made of path segments and query parameters
+std::string MakeUrl(int64_t length, const std::string &tail)
+{
+    std::string url = "https://cdn.example.com/releases/v1.2.3/";
+    int64_t segment = 0;
+    while (static_cast<int64_t>(url.length() + tail.length()) < length) {
+        segment++;
+        url += "part" + std::to_string(segment) + ((segment % QUERY_EVERY == 0) ? "?key=value&" : "/");
+    }
+    url.resize(static_cast<std::size_t>(length) - tail.length());
+    return url + tail;
+}
+
+/* plain text is accepted by the eight byte pre-scan without entering the scanner */
+void BM_FindIllegalWordsText(benchmark::State &state)
+{
+    std::string text = MakeText(state.range(0));
+    SqlAnalyzer analyzer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.FindIllegalWords(text));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FindIllegalWordsText)->RangeMultiplier(URL_LENGTH_STEP)->Range(URL_MIN_LENGTH, URL_MAX_LENGTH);
+
+/* every url has slashes and usually dashes, so it always takes the full scan over each identifier */
+void BM_FindIllegalWordsUrl(benchmark::State &state)
+{
+    std::string url = MakeUrl(state.range(0), "/file-name.bin");
+    SqlAnalyzer analyzer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.FindIllegalWords(url));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FindIllegalWordsUrl)->RangeMultiplier(URL_LENGTH_STEP)->Range(URL_MIN_LENGTH, URL_MAX_LENGTH);
+
+/* quoted text makes every quote look up its closing partner */
+void BM_FindIllegalWordsQuotedUrl(benchmark::State &state)
+{
+    std::string url = MakeUrl(state.range(0), "?name='a''b'");
+    SqlAnalyzer analyzer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.FindIllegalWords(url));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_FindIllegalWordsQuotedUrl)->RangeMultiplier(URL_LENGTH_STEP)->Range(URL_MIN_LENGTH, URL_MAX_LENGTH);
+
+/* the same values going through the insert path, one url plus short columns */
+void BM_CheckValuesBucket(benchmark::State &state)
+{
+    NativeRdb::ValuesBucket values;
+    values.PutInt("taskid", 1);
+    values.PutString("url", MakeUrl(state.range(0), "/file-name.bin"));
+    values.PutString("title", "download");
+    values.PutString("description", "benchmark record");
+    values.PutString("filePath", "/data/storage/el2/base/files/file-name.bin");
+    SqlAnalyzer analyzer;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(analyzer.CheckValuesBucket(values));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+BENCHMARK(BM_CheckValuesBucket)->RangeMultiplier(URL_LENGTH_STEP)->Range(URL_MIN_LENGTH, URL_MAX_LENGTH);
+} // namespace
+} // namespace OHOS::Request::Download
+
+BENCHMARK_MAIN();
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+
+#include "sql_analyzer.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Download {
+constexpr std::size_t ANALYZER_TEST_WORD = 8;
+constexpr std::size_t ANALYZER_TEST_MAX_LENGTH = 3 * ANALYZER_TEST_WORD + 1;
+constexpr std::size_t ANALYZER_TEST_RANDOM_CASES = 200000;
+constexpr std::size_t ANALYZER_TEST_RANDOM_LENGTH = 40;
+constexpr const char ANALYZER_TEST_SPECIAL[] = "'\"`;-/[]*\n";
+constexpr const char ANALYZER_TEST_ALPHABET[] = "a1 _'\"`;-/*[]\n";
+
+class SqlAnalyzerTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+
+    static bool ReferenceFindIllegalWords(const std::string &sql);
+};
+
+void SqlAnalyzerTest::SetUpTestCase(void)
+{
+}
+
+void SqlAnalyzerTest::TearDownTestCase(void)
+{
+}
+
+void SqlAnalyzerTest::SetUp()
+{
+}
+
+void SqlAnalyzerTest::TearDown()
+{
+}
+
+/*
+ * The scanner as it was before the word-at-a-time pre-scan, kept as the reference for the accepted language:
+ * every search runs over the whole rest of the value.
+ */
+bool SqlAnalyzerTest::ReferenceFindIllegalWords(const std::string &sql)
+{
+    auto pickChar = [&sql](std::size_t index) { return index < sql.length() ? sql[index] : '\0'; };
+    auto isLetter = [](char ch) { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || ch == '_'; };
+    auto isLetterNumber = [&isLetter](char ch) { return isLetter(ch) || (ch >= '0' && ch <= '9'); };
+    std::size_t pos = 0;
+    while (pos < sql.length()) {
+        char ch = sql[pos];
+        if (isLetter(ch)) {
+            pos++;
+            while (isLetterNumber(pickChar(pos))) {
+                pos++;
+            }
+        }
+        if (ch == '\'' || ch == '"' || ch == '`') {
+            pos++;
+            while (pos < sql.length()) {
+                if (sql.find(ch, pos) == std::string::npos) {
+                    return true;
+                }
+                if (pickChar(pos + 1) != ch) {
+                    break;
+                }
+                pos += 2;
+            }
+            continue;
+        }
+        if (ch == '[') {
+            pos++;
+            if (sql.find(']', pos) == std::string::npos) {
+                return true;
+            }
+            pos++;
+        }
+        if (ch == '-' && pickChar(pos + 1) == '-') {
+            pos += 2;
+            if (sql.find('\n', pos) == std::string::npos) {
+                return true;
+            }
+            pos++;
+        }
+        if (ch == '/' && pickChar(pos + 1) == '*') {
+            pos += 2;
+            if (sql.find("*/", pos) == std::string::npos) {
+                return true;
+            }
+            pos += 2;
+        }
+        if (ch == ';') {
+            return true;
+        }
+        pos++;
+    }
+    return false;
+}
+
+/**
+ * @tc.name: SqlAnalyzerTest_001
+ * @tc.desc: plain values are accepted, a statement separator or an unclosed token is rejected
+ * @tc.type: FUNC
+ */
+HWTEST_F(SqlAnalyzerTest, SqlAnalyzerTest_001, TestSize.Level1)
+{
+    SqlAnalyzer analyzer;
+    EXPECT_FALSE(analyzer.FindIllegalWords(""));
+    EXPECT_FALSE(analyzer.FindIllegalWords("https://cdn.example.com/releases/v1.2.3/part1?key=value&x=1"));
+    EXPECT_FALSE(analyzer.FindIllegalWords("download of the nightly build"));
+    EXPECT_TRUE(analyzer.FindIllegalWords(";"));
+    EXPECT_TRUE(analyzer.FindIllegalWords("1; DROP TABLE downloadInfo"));
+    EXPECT_TRUE(analyzer.FindIllegalWords("[taskid"));
+    EXPECT_FALSE(analyzer.FindIllegalWords("[taskid]"));
+    EXPECT_TRUE(analyzer.FindIllegalWords("1 -- comment"));
+    EXPECT_FALSE(analyzer.FindIllegalWords("1 -- comment\n"));
+    EXPECT_TRUE(analyzer.FindIllegalWords("1 /* comment"));
+    EXPECT_FALSE(analyzer.FindIllegalWords("1 /* comment */"));
+    EXPECT_FALSE(analyzer.FindIllegalWords("1 - 2 / 3"));
+}
+
+/**
+ * @tc.name: SqlAnalyzerTest_002
+ * @tc.desc: every quote needs a later quote of its kind and doubled quotes are escapes. The quoted text is
+ *           still scanned, so nested quotes and separators inside quotes count as well.
+ * @tc.type: FUNC
+ */
+HWTEST_F(SqlAnalyzerTest, SqlAnalyzerTest_002, TestSize.Level1)
+{
+    SqlAnalyzer analyzer;
+    const std::pair<const char *, bool> cases[] = {
+        { "'title'", false },
+        { "'title", true },
+        { "\"title\"", false },
+        { "\"title", true },
+        { "`title`", false },
+        { "`title", true },
+        { "'it''s'", false },
+        { "'it'''", false },
+        { "''", false },
+        { "x '", false },
+        { "' x", true },
+        { "'a \"b\" c'", true },
+        { "'a \"b\" `c`'", true },
+        { "\"a 'b\"", true },
+        { "\"a 'b' c\"", true },
+        { "'a \"b'", true },
+        { "' ;'", true },
+        { "' -- '", true },
+        { "' -- \n'", false },
+        { "' [ '", true },
+        { "' [ ] '", false },
+    };
+    for (const auto &it : cases) {
+        EXPECT_EQ(analyzer.FindIllegalWords(it.first), it.second) << it.first;
+        EXPECT_EQ(ReferenceFindIllegalWords(it.first), it.second) << it.first;
+    }
+}
+
+/**
+ * @tc.name: SqlAnalyzerTest_003
+ * @tc.desc: keywords and separators at the start and end of the value and around word boundaries
+ * @tc.type: FUNC
+ */
+HWTEST_F(SqlAnalyzerTest, SqlAnalyzerTest_003, TestSize.Level1)
+{
+    SqlAnalyzer analyzer;
+    const std::string keywords[] = { "SELECT", "DROP TABLE x", "OR 1=1", "UNION", "taskid" };
+    const std::string separators[] = { ";", " ;", "--", " --", "/*", " /*", "[", " [", "'", " '" };
+    for (const auto &keyword : keywords) {
+        for (const auto &separator : separators) {
+            for (std::size_t pad = 0; pad <= ANALYZER_TEST_WORD * 2; pad++) {
+                std::string filler(pad, 'x');
+                const std::string values[] = {
+                    separator + keyword,
+                    keyword + separator,
+                    filler + keyword + separator,
+                    filler + " " + keyword + separator,
+                    filler + separator + keyword,
+                    keyword + separator + filler,
+                };
+                for (const auto &value : values) {
+                    ASSERT_EQ(analyzer.FindIllegalWords(value), ReferenceFindIllegalWords(value)) << value;
+                }
+            }
+        }
+    }
+    // the character right after an identifier is skipped, so only a separator that starts a token counts
+    EXPECT_FALSE(analyzer.FindIllegalWords("taskid;"));
+    EXPECT_TRUE(analyzer.FindIllegalWords("taskid ;"));
+    EXPECT_TRUE(analyzer.FindIllegalWords(";taskid"));
+}
+
+/**
+ * @tc.name: SqlAnalyzerTest_004
+ * @tc.desc: a special character is found at every offset, in the eight byte words and in the tail
+ * @tc.type: FUNC
+ */
+HWTEST_F(SqlAnalyzerTest, SqlAnalyzerTest_004, TestSize.Level1)
+{
+    SqlAnalyzer analyzer;
+    const char fillers[] = { ' ', 'a', '1', '.' };
+    for (char filler : fillers) {
+        for (std::size_t length = 1; length <= ANALYZER_TEST_MAX_LENGTH; length++) {
+            ASSERT_FALSE(analyzer.FindIllegalWords(std::string(length, filler)));
+            for (std::size_t offset = 0; offset < length; offset++) {
+                for (const char *special = ANALYZER_TEST_SPECIAL; *special != '\0'; special++) {
+                    std::string value(length, filler);
+                    value[offset] = *special;
+                    ASSERT_EQ(analyzer.FindIllegalWords(value), ReferenceFindIllegalWords(value))
+                        << "filler '" << filler << "' length " << length << " offset " << offset;
+                }
+            }
+        }
+    }
+    // a lone separator is rejected wherever it sits relative to the word size
+    for (std::size_t offset = 0; offset < ANALYZER_TEST_MAX_LENGTH; offset++) {
+        std::string value(ANALYZER_TEST_MAX_LENGTH, ' ');
+        value[offset] = ';';
+        EXPECT_TRUE(analyzer.FindIllegalWords(value)) << "offset " << offset;
+    }
+    // bytes with the high bit set must not be mistaken for special characters
+    EXPECT_FALSE(analyzer.FindIllegalWords(std::string(ANALYZER_TEST_MAX_LENGTH, '\xa7')));
+    EXPECT_FALSE(analyzer.FindIllegalWords(std::string(ANALYZER_TEST_MAX_LENGTH, '\xbb')));
+}
+
+/**
+ * @tc.name: SqlAnalyzerTest_005
+ * @tc.desc: random values over the characters the scanner cares about are judged like the reference
+ * @tc.type: FUNC
+ */
+HWTEST_F(SqlAnalyzerTest, SqlAnalyzerTest_005, TestSize.Level1)
+{
+    SqlAnalyzer analyzer;
+    const std::size_t alphabet = sizeof(ANALYZER_TEST_ALPHABET) - 1;
+    uint32_t state = 1;
+    for (std::size_t i = 0; i < ANALYZER_TEST_RANDOM_CASES; i++) {
+        state = state * 1103515245u + 12345u;
+        std::string value((state >> 16) % ANALYZER_TEST_RANDOM_LENGTH, ' ');
+        for (auto &ch : value) {
+            state = state * 1103515245u + 12345u;
+            ch = ANALYZER_TEST_ALPHABET[(state >> 16) % alphabet];
+        }
+        ASSERT_EQ(analyzer.FindIllegalWords(value), ReferenceFindIllegalWords(value)) << value;
+    }
+}
+} // namespace OHOS::Request::Download
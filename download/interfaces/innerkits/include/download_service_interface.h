@@ -17,8 +17,10 @@
 #define DOWNLOAD_SERVICE_INTERFACE_H
 
 #include <string>
+#include <vector>
 
 #include "download_config.h"
+#include "download_filter.h"
 #include "download_info.h"
 #include "download_notify_interface.h"
 #include "iremote_broker.h"
@@ -36,9 +38,15 @@ public:
     virtual bool On(uint32_t taskId, const std::string &type, const sptr<DownloadNotifyInterface> &listener) = 0;
     virtual bool Off(uint32_t taskId, const std::string &type) = 0;
     virtual bool CheckPermission() = 0;
-    virtual bool SetStartId(uint32_t startId) = 0;
+    virtual uint32_t RequestGroup(const std::vector<DownloadConfig> &configs, std::vector<uint32_t> &taskIds) = 0;
+    virtual bool GroupAction(uint32_t groupId, uint32_t action) = 0;
+    virtual bool BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds) = 0;
+    virtual bool BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos) = 0;
 };
 
+static constexpr uint32_t GROUP_MAX_TASKS = 500;
+static constexpr uint32_t BATCH_MAX_TASKS = 10000;
+
 enum {
     CMD_REQUEST,
     CMD_PAUSE,
@@ -49,7 +57,12 @@ enum {
     CMD_ON,
     CMD_OFF,
     CMD_CHECKPERMISSION,
-    CMD_SETSTARTID,
+    /* retired SetStartId, the slot stays so the codes after it keep their values */
+    CMD_RESERVED,
+    CMD_REQUEST_GROUP,
+    CMD_GROUP_ACTION,
+    CMD_BATCH_ACTION,
+    CMD_BATCH_QUERY,
 };
 } // namespace OHOS::Request::Download
 #endif // DOWNLOAD_SERVICE_INTERFACE_H
\ No newline at end of file
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_BATCH_H
+#define DOWNLOAD_BATCH_H
+
+#include <vector>
+
+#include "async_call.h"
+#include "download_filter.h"
+#include "download_info.h"
+#include "napi/native_api.h"
+#include "noncopyable.h"
+
+namespace OHOS::Request::Download {
+class DownloadBatch final {
+public:
+    ACE_DISALLOW_COPY_AND_MOVE(DownloadBatch);
+
+    DownloadBatch() = default;
+    ~DownloadBatch() = default;
+
+    static napi_value Action(napi_env env, napi_callback_info info);
+    static napi_value Query(napi_env env, napi_callback_info info);
+
+private:
+    static bool ParseFilter(napi_env env, napi_value filterValue, DownloadFilter &filter);
+
+    struct BatchContext : public AsyncCall::Context {
+        DownloadFilter filter;
+        uint32_t action = 0;
+        std::vector<uint32_t> taskIds;
+        std::vector<DownloadInfo> infos;
+        napi_status status = napi_generic_failure;
+        BatchContext() : Context(nullptr, nullptr) {};
+        BatchContext(InputAction input, OutputAction output) : Context(std::move(input), std::move(output)) {};
+        virtual ~BatchContext() {};
+
+        napi_status operator()(napi_env env, size_t argc, napi_value *argv, napi_value self) override
+        {
+            return Context::operator()(env, argc, argv, self);
+        }
+        napi_status operator()(napi_env env, napi_value *result) override
+        {
+            if (status != napi_ok) {
+                return status;
+            }
+            return Context::operator()(env, result);
+        }
+    };
+};
+} // namespace OHOS::Request::Download
+
+#endif // DOWNLOAD_BATCH_H
@@ -16,8 +16,10 @@
 #ifndef DOWNLOAD_CONFIG_H
 #define DOWNLOAD_CONFIG_H
 
+#include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace OHOS::Request::Download {
 class DownloadConfig final {
@@ -44,6 +46,22 @@ public:
 
     void SetFDError(int32_t fdError);
 
+    void SetCacheable(bool enableCache);
+
+    void SetCallerUid(int32_t callerUid);
+
+    void AddMirror(const std::string &url);
+
+    void SetExpectedSize(uint64_t expectedSize);
+
+    void SetChecksum(const std::string &checksum);
+
+    void SetBlockIndex(const std::string &blockIndex);
+
+    void SetBasePath(const std::string &basePath);
+
+    void SetBaseFD(int32_t fd);
+
     [[nodiscard]] const std::string &GetUrl() const;
 
     [[nodiscard]] const std::map<std::string, std::string> &GetHeader() const;
@@ -64,6 +82,22 @@ public:
 
     int32_t GetFDError() const;
 
+    [[nodiscard]] bool GetCacheable() const;
+
+    [[nodiscard]] int32_t GetCallerUid() const;
+
+    [[nodiscard]] const std::vector<std::string> &GetMirrors() const;
+
+    [[nodiscard]] uint64_t GetExpectedSize() const;
+
+    [[nodiscard]] const std::string &GetChecksum() const;
+
+    [[nodiscard]] const std::string &GetBlockIndex() const;
+
+    [[nodiscard]] const std::string &GetBasePath() const;
+
+    [[nodiscard]] int32_t GetBaseFD() const;
+
     void Dump(bool isFull = true) const;
 
 private:
@@ -86,6 +120,22 @@ private:
     int32_t fd_;
 
     int32_t fdError_;
+
+    bool enableCache_;
+
+    int32_t callerUid_;
+
+    std::vector<std::string> mirrors_;
+
+    uint64_t expectedSize_;
+
+    std::string checksum_;
+
+    std::string blockIndex_;
+
+    std::string basePath_;
+
+    int32_t baseFd_;
 };
 } // namespace OHOS::Request::Download
 
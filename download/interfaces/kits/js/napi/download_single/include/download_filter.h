@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_FILTER_H
+#define DOWNLOAD_FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "constant.h"
+
+namespace OHOS::Request::Download {
+enum DownloadFilterMask : uint32_t {
+    FILTER_NONE = 0,
+    FILTER_BY_STATUS = 1 << 0,
+    FILTER_BY_PAUSED_REASON = 1 << 1,
+    FILTER_BY_CALLER = 1 << 2,
+};
+
+/*
+ * Selects tasks for the batch commands. A non empty taskIds limits the selection to those ids, the
+ * bits of mask narrow it further. callerUid is filled in by the service from the IPC caller.
+ */
+struct DownloadFilter {
+    std::vector<uint32_t> taskIds;
+    uint32_t mask = FILTER_NONE;
+    DownloadStatus status = SESSION_UNKNOWN;
+    PausedReason pausedReason = PAUSED_UNKNOWN;
+    int32_t callerUid = -1;
+    uint32_t startId = 0;
+    uint32_t limit = 0;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_FILTER_H
@@ -17,6 +17,7 @@
 #define DOWNLOAD_MANAGER_H
 
 #include <map>
+#include <vector>
 
 #include "data_ability_helper.h"
 #include "iremote_object.h"
@@ -26,7 +27,9 @@
 #include "download_service_interface.h"
 
 #include "download_config.h"
+#include "download_filter.h"
 #include "download_info.h"
+#include "download_record_writer.h"
 #include "download_task.h"
 
 namespace OHOS::Request::Download {
@@ -42,7 +45,11 @@ public:
     DownloadManager();
     ~DownloadManager();
     static sptr<DownloadManager> GetInstance();
-    DownloadTask *EnqueueTask(const DownloadConfig &config);
+    bool EnqueueTask(const DownloadConfig &config, uint32_t &taskId);
+    bool EnqueueGroup(const std::vector<DownloadConfig> &configs, uint32_t &groupId);
+    bool GroupAction(uint32_t groupId, uint32_t action);
+    bool BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds);
+    bool BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos);
     bool Pause(uint32_t taskId);
     bool Query(uint32_t taskId, DownloadInfo &info);
     bool QueryMimeType(uint32_t taskId, std::string &mimeType);
@@ -56,17 +63,23 @@ public:
     
     void OnRemoteSaDied(const wptr<IRemoteObject> &object);
     void SetDataAbilityHelper(std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper);
+    void SaveStatus(uint32_t taskId, DownloadStatus status, uint32_t reason);
 
 private:
     sptr<DownloadServiceInterface> GetDownloadServiceProxy();
+    sptr<DownloadServiceInterface> LockedGetProxy();
+    void SaveRecord(const DownloadConfig &config, uint32_t taskId);
+    void WatchStatus(sptr<DownloadServiceInterface> proxy, uint32_t taskId);
 
 private:
     static std::mutex instanceLock_;
     static sptr<DownloadManager> instance_;
 	
+    std::mutex mutex_;
     sptr<DownloadServiceInterface> downloadServiceProxy_;
     sptr<DownloadSaDeathRecipient> deathRecipient_;
     std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper_;
+    DownloadRecordWriter recordWriter_;
 };
 } // namespace OHOS::Request::Download
 #endif // DOWNLOAD_MANAGER_H
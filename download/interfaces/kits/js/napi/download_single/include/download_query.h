@@ -32,6 +32,7 @@ public:
     ~DownloadQuery() = default;
 
     static napi_value Exec(napi_env env, napi_callback_info info);
+    static napi_value CreateInfo(napi_env env, const DownloadInfo &info);
 
 private:
     struct QueryContext : public AsyncCall::Context {
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_RECORD_WRITER_H
+#define DOWNLOAD_RECORD_WRITER_H
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "data_ability_helper.h"
+#include "values_bucket.h"
+
+namespace OHOS::Request::Download {
+/*
+ * Write-behind queue for download records. Records are pushed from any thread and written to the
+ * download data ability in one BatchInsert, i.e. one transaction, per flush. A single flush thread
+ * keeps the records in push order, and each flush applies its updates after its inserts, so an update
+ * always finds the record it was pushed after.
+ */
+class DownloadRecordWriter final {
+public:
+    DownloadRecordWriter();
+    ~DownloadRecordWriter();
+
+    void SetDataAbilityHelper(std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper);
+    void Push(const OHOS::NativeRdb::ValuesBucket &record);
+    void PushUpdate(uint32_t taskId, const OHOS::NativeRdb::ValuesBucket &values);
+
+private:
+    void Run();
+    void WriteRecords(const std::vector<OHOS::NativeRdb::ValuesBucket> &records);
+    void WriteUpdates(const std::vector<std::pair<uint32_t, OHOS::NativeRdb::ValuesBucket>> &updates);
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<OHOS::NativeRdb::ValuesBucket> pending_;
+    std::vector<std::pair<uint32_t, OHOS::NativeRdb::ValuesBucket>> pendingUpdates_;
+    std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper_;
+    std::thread thread_;
+    bool stop_;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_RECORD_WRITER_H
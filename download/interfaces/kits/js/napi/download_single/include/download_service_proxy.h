@@ -37,9 +37,16 @@ public:
     bool On(uint32_t taskId, const std::string &type, const sptr<DownloadNotifyInterface> &listener) override;
     bool Off(uint32_t taskId, const std::string &type) override;
     bool CheckPermission() override;
-    bool SetStartId(uint32_t startId) override;
+    uint32_t RequestGroup(const std::vector<DownloadConfig> &configs, std::vector<uint32_t> &taskIds) override;
+    bool GroupAction(uint32_t groupId, uint32_t action) override;
+    bool BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds) override;
+    bool BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos) override;
 
 private:
+    static bool WriteConfig(MessageParcel &data, const DownloadConfig &config);
+    static void WriteFilter(MessageParcel &data, const DownloadFilter &filter);
+    static void ReadInfo(MessageParcel &reply, DownloadInfo &info);
+
     static inline BrokerDelegator<DownloadServiceProxy> delegator_;
 };
 } // namespace OHOS::Request::Download
@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef DOWNLOAD_STATUS_NOTIFY_H
+#define DOWNLOAD_STATUS_NOTIFY_H
+
+#include <string>
+#include "download_notify_stub.h"
+#include "noncopyable.h"
+
+namespace OHOS::Request::Download {
+/*
+ * Listener for the terminal "complete" and "fail" events. It writes the final status into the task's
+ * download record, which the data ability's retention keys on, and forwards the event to the app's
+ * listener when one is registered for the same type.
+ */
+class DownloadStatusNotify final : public DownloadNotifyStub {
+public:
+    ACE_DISALLOW_COPY_AND_MOVE(DownloadStatusNotify);
+    DownloadStatusNotify(uint32_t taskId, const std::string &type, const sptr<DownloadNotifyInterface> &listener);
+    virtual ~DownloadStatusNotify();
+    void OnCallBack(MessageParcel &data) override;
+
+    static bool IsStatusEvent(const std::string &type);
+
+private:
+    uint32_t taskId_;
+    std::string type_;
+    sptr<DownloadNotifyInterface> listener_;
+};
+} // namespace OHOS::Request::Download
+
+#endif // DOWNLOAD_STATUS_NOTIFY_H
@@ -28,6 +28,8 @@ static constexpr const char *EVENT_REMOVE = "remove";
 static constexpr const char *EVENT_PROGRESS = "progress";
 static constexpr const char *EVENT_FAIL = "fail";
 
+static constexpr uint32_t INVALID_TASK_ID = static_cast<uint32_t>(-1);
+
 namespace OHOS::Request::Download {
 class DownloadTask {
 public:
@@ -35,6 +37,7 @@ public:
     ~DownloadTask();
 
     uint32_t GetId() const;
+    void SetId(uint32_t taskId);
 
     bool AddListener(const std::string &type, sptr<DownloadNotifyInterface> listener);
     void RemoveListener(const std::string &type, sptr<DownloadNotifyInterface> listener);
@@ -28,16 +28,21 @@ namespace OHOS::Request::Download {
 class DownloadTaskNapi {
 public:
     static napi_value JsMain(napi_env env, napi_callback_info info);
+    static napi_value JsGroup(napi_env env, napi_callback_info info);
 
 private:
     static napi_value GetCtor(napi_env env);
+    static napi_value GetGroupCtor(napi_env env);
+    static bool ParseConfigList(napi_env env, napi_value listValue, std::vector<DownloadConfig> &configs);
     static napi_value Initialize(napi_env env, napi_callback_info info);
     static bool ParseConfig(napi_env env, napi_value configValue, DownloadConfig &config);
     static bool ParseHeader(napi_env env, napi_value configValue, DownloadConfig &config);
+    static bool ParseMirrors(napi_env env, napi_value configValue, DownloadConfig &config);
     static std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> GetDataAbilityHelper(napi_env env);
 
 private:
     static __thread napi_ref globalCtor;
+    static __thread napi_ref groupCtor;
 };
 } // namespace OHOS::Request::Download
 #endif // DOWNLOAD_TASK_NAPI_H
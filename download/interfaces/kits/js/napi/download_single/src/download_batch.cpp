@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_batch.h"
+
+#include "download_manager.h"
+#include "download_query.h"
+#include "log.h"
+#include "napi_utils.h"
+
+static constexpr const char *PARAM_KEY_TASK_IDS = "taskIds";
+static constexpr const char *PARAM_KEY_STATUS = "status";
+static constexpr const char *PARAM_KEY_PAUSED_REASON = "pausedReason";
+static constexpr const char *PARAM_KEY_OWN_ONLY = "ownOnly";
+
+namespace OHOS::Request::Download {
+napi_value DownloadBatch::Action(napi_env env, napi_callback_info info)
+{
+    DOWNLOAD_HILOGD("Enter ---->");
+    if (!DownloadManager::GetInstance()->CheckPermission()) {
+        DOWNLOAD_HILOGD("no permission to access download service");
+        return nullptr;
+    }
+    auto context = std::make_shared<BatchContext>();
+    auto input = [context](napi_env env, size_t argc, napi_value *argv, napi_value self) -> napi_status {
+        NAPI_ASSERT_BASE(env, argc == NapiUtils::TWO_ARG, " should 2 parameters!", napi_invalid_arg);
+        NAPI_ASSERT_BASE(env, ParseFilter(env, argv[NapiUtils::FIRST_ARGV], context->filter),
+            " filter has wrong type!", napi_invalid_arg);
+        NAPI_ASSERT_BASE(env, NapiUtils::GetValueType(env, argv[NapiUtils::SECOND_ARGV]) == napi_number,
+            " action should be a number!", napi_invalid_arg);
+        context->action = NapiUtils::GetUint32FromValue(env, argv[NapiUtils::SECOND_ARGV]);
+        return napi_ok;
+    };
+    auto output = [context](napi_env env, napi_value *result) -> napi_status {
+        napi_status status = napi_create_array_with_length(env, context->taskIds.size(), result);
+        for (uint32_t i = 0; i < context->taskIds.size() && status == napi_ok; i++) {
+            status = napi_set_element(env, *result, i, NapiUtils::CreateUint32(env, context->taskIds[i]));
+        }
+        DOWNLOAD_HILOGD("output ---- [%{public}zu] tasks, status[%{public}d]", context->taskIds.size(), status);
+        return status;
+    };
+    auto exec = [context](AsyncCall::Context *ctx) {
+        if (DownloadManager::GetInstance()->BatchAction(context->filter, context->action, context->taskIds)) {
+            context->status = napi_ok;
+        }
+    };
+    context->SetAction(std::move(input), std::move(output));
+    AsyncCall asyncCall(env, info, std::dynamic_pointer_cast<AsyncCall::Context>(context), NapiUtils::TWO_ARG);
+    return asyncCall.Call(env, exec);
+}
+
+napi_value DownloadBatch::Query(napi_env env, napi_callback_info info)
+{
+    DOWNLOAD_HILOGD("Enter ---->");
+    if (!DownloadManager::GetInstance()->CheckPermission()) {
+        DOWNLOAD_HILOGD("no permission to access download service");
+        return nullptr;
+    }
+    auto context = std::make_shared<BatchContext>();
+    auto input = [context](napi_env env, size_t argc, napi_value *argv, napi_value self) -> napi_status {
+        NAPI_ASSERT_BASE(env, argc == NapiUtils::ONE_ARG, " should 1 parameter!", napi_invalid_arg);
+        NAPI_ASSERT_BASE(env, ParseFilter(env, argv[NapiUtils::FIRST_ARGV], context->filter),
+            " filter has wrong type!", napi_invalid_arg);
+        return napi_ok;
+    };
+    auto output = [context](napi_env env, napi_value *result) -> napi_status {
+        napi_status status = napi_create_array_with_length(env, context->infos.size(), result);
+        for (uint32_t i = 0; i < context->infos.size() && status == napi_ok; i++) {
+            status = napi_set_element(env, *result, i, DownloadQuery::CreateInfo(env, context->infos[i]));
+        }
+        DOWNLOAD_HILOGD("output ---- [%{public}zu] infos, status[%{public}d]", context->infos.size(), status);
+        return status;
+    };
+    auto exec = [context](AsyncCall::Context *ctx) {
+        if (DownloadManager::GetInstance()->BatchQuery(context->filter, context->infos)) {
+            context->status = napi_ok;
+        }
+    };
+    context->SetAction(std::move(input), std::move(output));
+    AsyncCall asyncCall(env, info, std::dynamic_pointer_cast<AsyncCall::Context>(context), NapiUtils::ONE_ARG);
+    return asyncCall.Call(env, exec);
+}
+
+bool DownloadBatch::ParseFilter(napi_env env, napi_value filterValue, DownloadFilter &filter)
+{
+    if (NapiUtils::GetValueType(env, filterValue) != napi_object) {
+        return false;
+    }
+    if (NapiUtils::HasNamedProperty(env, filterValue, PARAM_KEY_TASK_IDS)) {
+        napi_value idList = NapiUtils::GetNamedProperty(env, filterValue, PARAM_KEY_TASK_IDS);
+        bool isArray = false;
+        uint32_t length = 0;
+        napi_is_array(env, idList, &isArray);
+        if (!isArray || napi_get_array_length(env, idList, &length) != napi_ok || length > BATCH_MAX_TASKS) {
+            return false;
+        }
+        for (uint32_t i = 0; i < length; i++) {
+            napi_value idValue = nullptr;
+            napi_get_element(env, idList, i, &idValue);
+            filter.taskIds.push_back(NapiUtils::GetUint32FromValue(env, idValue));
+        }
+    }
+    if (NapiUtils::HasNamedProperty(env, filterValue, PARAM_KEY_STATUS)) {
+        filter.mask |= FILTER_BY_STATUS;
+        filter.status = static_cast<DownloadStatus>(NapiUtils::GetUint32Property(env, filterValue, PARAM_KEY_STATUS));
+    }
+    if (NapiUtils::HasNamedProperty(env, filterValue, PARAM_KEY_PAUSED_REASON)) {
+        filter.mask |= FILTER_BY_PAUSED_REASON;
+        filter.pausedReason =
+            static_cast<PausedReason>(NapiUtils::GetUint32Property(env, filterValue, PARAM_KEY_PAUSED_REASON));
+    }
+    if (NapiUtils::GetBooleanProperty(env, filterValue, PARAM_KEY_OWN_ONLY)) {
+        filter.mask |= FILTER_BY_CALLER;
+    }
+    return true;
+}
+} // namespace OHOS::Request::Download
@@ -20,7 +20,8 @@
 namespace OHOS::Request::Download {
 DownloadConfig::DownloadConfig()
     : url_(""), enableMetered_(false), enableRoaming_(false), description_(""), networkType_(0),
-      filePath_(""), title_(""), fd_(-1), fdError_(0) {
+      filePath_(""), title_(""), fd_(-1), fdError_(0), enableCache_(false), callerUid_(-1),
+      expectedSize_(0), checksum_(""), blockIndex_(""), basePath_(""), baseFd_(-1) {
 }
 
 void DownloadConfig::SetUrl(const std::string &url)
@@ -73,6 +74,11 @@ void DownloadConfig::SetFDError(int32_t fdError)
     fdError_ = fdError;
 }
 
+void DownloadConfig::SetCacheable(bool enableCache)
+{
+    enableCache_ = enableCache;
+}
+
 const std::string &DownloadConfig::GetUrl() const
 {
     return url_;
@@ -123,6 +129,81 @@ int32_t DownloadConfig::GetFDError() const
     return fdError_;
 }
 
+bool DownloadConfig::GetCacheable() const
+{
+    return enableCache_;
+}
+
+void DownloadConfig::SetCallerUid(int32_t callerUid)
+{
+    callerUid_ = callerUid;
+}
+
+int32_t DownloadConfig::GetCallerUid() const
+{
+    return callerUid_;
+}
+
+void DownloadConfig::AddMirror(const std::string &url)
+{
+    mirrors_.push_back(url);
+}
+
+void DownloadConfig::SetExpectedSize(uint64_t expectedSize)
+{
+    expectedSize_ = expectedSize;
+}
+
+void DownloadConfig::SetChecksum(const std::string &checksum)
+{
+    checksum_ = checksum;
+}
+
+void DownloadConfig::SetBlockIndex(const std::string &blockIndex)
+{
+    blockIndex_ = blockIndex;
+}
+
+void DownloadConfig::SetBasePath(const std::string &basePath)
+{
+    basePath_ = basePath;
+}
+
+void DownloadConfig::SetBaseFD(int32_t fd)
+{
+    baseFd_ = fd;
+}
+
+const std::vector<std::string> &DownloadConfig::GetMirrors() const
+{
+    return mirrors_;
+}
+
+uint64_t DownloadConfig::GetExpectedSize() const
+{
+    return expectedSize_;
+}
+
+const std::string &DownloadConfig::GetChecksum() const
+{
+    return checksum_;
+}
+
+const std::string &DownloadConfig::GetBlockIndex() const
+{
+    return blockIndex_;
+}
+
+const std::string &DownloadConfig::GetBasePath() const
+{
+    return basePath_;
+}
+
+int32_t DownloadConfig::GetBaseFD() const
+{
+    return baseFd_;
+}
+
 void DownloadConfig::Dump(bool isFull) const
 {
     DOWNLOAD_HILOGD("fd: %{public}d", fd_);
@@ -130,6 +211,8 @@ void DownloadConfig::Dump(bool isFull) const
     DOWNLOAD_HILOGD("URL: %{public}s", url_.c_str());
     DOWNLOAD_HILOGD("enableMetered: %{public}s", enableMetered_ ? "true" : "false");
     DOWNLOAD_HILOGD("enableRoaming: %{public}s", enableRoaming_ ? "true" : "false");
+    DOWNLOAD_HILOGD("enableCache: %{public}s", enableCache_ ? "true" : "false");
+    DOWNLOAD_HILOGD("callerUid: %{public}d", callerUid_);
     DOWNLOAD_HILOGD("description: %{public}s", description_.c_str());
     std::string networkDesc = "WLAN and Mobile";
     if ((networkType_ & NETWORK_MASK) == NETWORK_MOBILE) {
@@ -140,6 +223,9 @@ void DownloadConfig::Dump(bool isFull) const
     DOWNLOAD_HILOGD("networkType: %{public}s", networkDesc.c_str());
     DOWNLOAD_HILOGD("filePath: %{public}s", filePath_.c_str());
     DOWNLOAD_HILOGD("title: %{public}s", title_.c_str());
+    DOWNLOAD_HILOGD("mirrors: %{public}zu, expected size: %{public}llu", mirrors_.size(),
+        static_cast<unsigned long long>(expectedSize_));
+    DOWNLOAD_HILOGD("blockIndex: %{public}s, base: %{public}s", blockIndex_.c_str(), basePath_.c_str());
     if (isFull) {
         DOWNLOAD_HILOGD("Header Information:");
         std::for_each(header_.begin(), header_.end(), [](std::pair<std::string, std::string> p) {
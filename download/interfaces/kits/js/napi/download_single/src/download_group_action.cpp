@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_group_action.h"
+
+#include "download_manager.h"
+#include "log.h"
+
+namespace OHOS::Request::Download {
+napi_value DownloadGroupAction::Pause(napi_env env, napi_callback_info info)
+{
+    return Exec(env, info, DOWNLOAD_ACTION_PAUSE);
+}
+
+napi_value DownloadGroupAction::Resume(napi_env env, napi_callback_info info)
+{
+    return Exec(env, info, DOWNLOAD_ACTION_RESUME);
+}
+
+napi_value DownloadGroupAction::Remove(napi_env env, napi_callback_info info)
+{
+    return Exec(env, info, DOWNLOAD_ACTION_REMOVE);
+}
+
+napi_value DownloadGroupAction::Exec(napi_env env, napi_callback_info info, uint32_t action)
+{
+    DOWNLOAD_HILOGD("Enter ----> action [%{public}d]", action);
+    if (!DownloadManager::GetInstance()->CheckPermission()) {
+        DOWNLOAD_HILOGD("no permission to access download service");
+        return nullptr;
+    }
+    auto context = std::make_shared<GroupActionContext>();
+    context->action = action;
+    auto input = [context](napi_env env, size_t argc, napi_value *argv, napi_value self) -> napi_status {
+        NAPI_ASSERT_BASE(env, argc == 0, " should 0 parameter!", napi_invalid_arg);
+        return napi_ok;
+    };
+    auto output = [context](napi_env env, napi_value *result) -> napi_status {
+        napi_status status = napi_get_boolean(env, context->result, result);
+        DOWNLOAD_HILOGD("output ---- [%{public}s], status[%{public}d]", context->result ? "true" : "false", status);
+        return status;
+    };
+    auto exec = [context](AsyncCall::Context *ctx) {
+        context->result = DownloadManager::GetInstance()->GroupAction(context->task_->GetId(), context->action);
+        if (context->result == true) {
+            context->status = napi_ok;
+        }
+    };
+    context->SetAction(std::move(input), std::move(output));
+    AsyncCall asyncCall(env, info, std::dynamic_pointer_cast<AsyncCall::Context>(context), 0);
+    return asyncCall.Call(env, exec);
+}
+} // namespace OHOS::Request::Download
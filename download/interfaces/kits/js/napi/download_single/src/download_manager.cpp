@@ -26,6 +26,7 @@
 #include "rdb_store.h"
 #include "result_set.h"
 
+#include "download_status_notify.h"
 #include "log.h"
 
 namespace OHOS::Request::Download {
@@ -53,58 +54,94 @@ sptr<DownloadManager> DownloadManager::GetInstance()
 
 void DownloadManager::SetDataAbilityHelper(std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper)
 {
-    if (dataAbilityHelper_ == nullptr && dataAbilityHelper != nullptr) {
-        dataAbilityHelper_ = dataAbilityHelper;
-        std::vector<std::string> columns;
-        columns.push_back("taskid");
-        OHOS::NativeRdb::DataAbilityPredicates predicates;
-        predicates.GreaterThan("taskid", "0");
-        std::shared_ptr<OHOS::NativeRdb::AbsSharedResultSet> resultSet;
-        OHOS::Uri uriDownload("dataability:///com.ohos.download/download/downloadInfo");
-        resultSet = dataAbilityHelper_->Query(uriDownload, columns, predicates);
-        if (resultSet == nullptr) {
-            DOWNLOAD_HILOGE("Failed to get query result");
-            return;
-        }
-        int rowCount = 0;
-        resultSet->GetRowCount(rowCount);
-        DOWNLOAD_HILOGI("DownloadManager ResultSet rowCount = %{public}d", rowCount);
-        if (resultSet->GoToLastRow() == 0) {
-            int taskId;
-            std::string contactIdKey = "taskid";
-            int contactIndex = 0;
-            resultSet->GetColumnIndex(contactIdKey, contactIndex);
-            resultSet->GetInt(contactIndex, taskId);
-            DOWNLOAD_HILOGI("DownloadManager query result id  = %{public}d", taskId);
-            if (downloadServiceProxy_ == nullptr) {
-                DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-                downloadServiceProxy_ = GetDownloadServiceProxy();
-            }
-            if (downloadServiceProxy_ != nullptr) {
-                downloadServiceProxy_->SetStartId(taskId + 1);
-            }
-        }
-        resultSet->Close();
+    // task ids are allocated and persisted by the download service, nothing to seed from the database here
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (dataAbilityHelper_ != nullptr || dataAbilityHelper == nullptr) {
+        return;
     }
+    dataAbilityHelper_ = dataAbilityHelper;
+    recordWriter_.SetDataAbilityHelper(dataAbilityHelper);
 }
 
-DownloadTask* DownloadManager::EnqueueTask(const DownloadConfig &config)
+bool DownloadManager::EnqueueTask(const DownloadConfig &config, uint32_t &taskId)
 {
     DOWNLOAD_HILOGD("DownloadManager EnqueueTask start.");
-
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
+    // the lock only guards the proxy pointer, the IPC itself runs unlocked so callers don't queue behind it
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("EnqueueTask quit because redoing GetDownloadServiceProxy failed.");
+        return false;
     }
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGE("Pause quit because redoing GetDownloadServiceProxy failed.");
-        return nullptr;
+    taskId = proxy->Request(config);
+    if (taskId == static_cast<uint32_t>(-1)) {
+        DOWNLOAD_HILOGE("DownloadManager EnqueueTask failed.");
+        return false;
     }
-    uint32_t taskId = downloadServiceProxy_->Request(config);
     DOWNLOAD_HILOGD("DownloadManager EnqueueTask succeeded.");
-    
-    DOWNLOAD_HILOGD("DownloadManager EnqueueTask Save Data.");
-    OHOS::Uri uriDownload("dataability:///com.ohos.download/download/downloadInfo");
+    SaveRecord(config, taskId);
+    WatchStatus(proxy, taskId);
+    return true;
+}
+
+bool DownloadManager::EnqueueGroup(const std::vector<DownloadConfig> &configs, uint32_t &groupId)
+{
+    DOWNLOAD_HILOGD("DownloadManager EnqueueGroup start.");
+    // the lock only guards the proxy pointer, the IPC itself runs unlocked so callers don't queue behind it
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("EnqueueGroup quit because redoing GetDownloadServiceProxy failed.");
+        return false;
+    }
+    std::vector<uint32_t> taskIds;
+    groupId = proxy->RequestGroup(configs, taskIds);
+    if (groupId == static_cast<uint32_t>(-1) || taskIds.size() != configs.size()) {
+        DOWNLOAD_HILOGE("DownloadManager EnqueueGroup failed.");
+        return false;
+    }
+    DOWNLOAD_HILOGD("DownloadManager EnqueueGroup succeeded.");
+    for (size_t i = 0; i < configs.size(); i++) {
+        SaveRecord(configs[i], taskIds[i]);
+        WatchStatus(proxy, taskIds[i]);
+    }
+    return true;
+}
+
+bool DownloadManager::GroupAction(uint32_t groupId, uint32_t action)
+{
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("GroupAction quit because redoing GetDownloadServiceProxy failed.");
+        return false;
+    }
+    DOWNLOAD_HILOGD("DownloadManager GroupAction succeeded.");
+    return proxy->GroupAction(groupId, action);
+}
+
+bool DownloadManager::BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds)
+{
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("BatchAction quit because redoing GetDownloadServiceProxy failed.");
+        return false;
+    }
+    DOWNLOAD_HILOGD("DownloadManager BatchAction succeeded.");
+    return proxy->BatchAction(filter, action, taskIds);
+}
+
+bool DownloadManager::BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos)
+{
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("BatchQuery quit because redoing GetDownloadServiceProxy failed.");
+        return false;
+    }
+    DOWNLOAD_HILOGD("DownloadManager BatchQuery succeeded.");
+    return proxy->BatchQuery(filter, infos);
+}
+
+void DownloadManager::SaveRecord(const DownloadConfig &config, uint32_t taskId)
+{
+    DOWNLOAD_HILOGD("DownloadManager Save Data of Task[%{public}d].", taskId);
     OHOS::NativeRdb::ValuesBucket rawContactValues;
     rawContactValues.PutInt("taskId", taskId);
     rawContactValues.PutString("url", config.GetUrl().c_str());
@@ -115,125 +152,133 @@ DownloadTask* DownloadManager::EnqueueTask(const DownloadConfig &config)
     rawContactValues.PutBool("roaming", config.GetRoaming());
     rawContactValues.PutInt("network", config.GetNetworkType());
 
-    if (dataAbilityHelper_ != nullptr) {
-        int rowId = dataAbilityHelper_->Insert(uriDownload, rawContactValues);
-        DOWNLOAD_HILOGI("DownloadManager EnqueueTask rowId = %{public}d", rowId);
+    // written behind in batches, a burst of downloads costs one transaction instead of one per task
+    recordWriter_.Push(rawContactValues);
+}
+
+void DownloadManager::SaveStatus(uint32_t taskId, DownloadStatus status, uint32_t reason)
+{
+    DOWNLOAD_HILOGD("DownloadManager Save Status %{public}d of Task[%{public}d].", status, taskId);
+    OHOS::NativeRdb::ValuesBucket values;
+    values.PutInt("status", status);
+    if (status == SESSION_FAILED) {
+        values.PutInt("reason", reason);
     }
+    recordWriter_.PushUpdate(taskId, values);
+}
 
-    return new DownloadTask(taskId);
+void DownloadManager::WatchStatus(sptr<DownloadServiceInterface> proxy, uint32_t taskId)
+{
+    // the record's terminal status is what lets the data ability prune it, the app's own listeners for
+    // the same events are wrapped by On and put back to these by Off
+    proxy->On(taskId, EVENT_COMPLETE, new DownloadStatusNotify(taskId, EVENT_COMPLETE, nullptr));
+    proxy->On(taskId, EVENT_FAIL, new DownloadStatusNotify(taskId, EVENT_FAIL, nullptr));
 }
 
 bool DownloadManager::Pause(uint32_t taskId)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
         DOWNLOAD_HILOGE("Pause quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager Pause succeeded.");
-    return downloadServiceProxy_->Pause(taskId);
+    return proxy->Pause(taskId);
 }
 
 bool DownloadManager::Query(uint32_t taskId, DownloadInfo &info)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
         DOWNLOAD_HILOGE("Query quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager Query succeeded.");
-    return downloadServiceProxy_->Query(taskId, info);
+    return proxy->Query(taskId, info);
 }
 
 bool DownloadManager::QueryMimeType(uint32_t taskId, std::string &mimeType)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
         DOWNLOAD_HILOGE("QueryMimeType quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager QueryMimeType succeeded.");
-    return downloadServiceProxy_->QueryMimeType(taskId, mimeType);
+    return proxy->QueryMimeType(taskId, mimeType);
 }
 
 bool DownloadManager::Remove(uint32_t taskId)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
         DOWNLOAD_HILOGE("Remove quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager Remove succeeded.");
-    return downloadServiceProxy_->Remove(taskId);
+    return proxy->Remove(taskId);
 }
 
 bool DownloadManager::Resume(uint32_t taskId)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
         DOWNLOAD_HILOGE("Resume quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager Resume succeeded.");
-    return downloadServiceProxy_->Resume(taskId);
+    return proxy->Resume(taskId);
 }
 
 bool DownloadManager::On(uint32_t taskId, const std::string &type, const sptr<DownloadNotifyInterface> &listener)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGE("Resume quit because redoing GetDownloadServiceProxy failed.");
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("On quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager On succeeded.");
-    return downloadServiceProxy_->On(taskId, type, listener);
+    if (DownloadStatusNotify::IsStatusEvent(type)) {
+        return proxy->On(taskId, type, new DownloadStatusNotify(taskId, type, listener));
+    }
+    return proxy->On(taskId, type, listener);
 }
 
 bool DownloadManager::Off(uint32_t taskId, const std::string &type)
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGE("Resume quit because redoing GetDownloadServiceProxy failed.");
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("Off quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager Off succeeded.");
-    return downloadServiceProxy_->Off(taskId, type);
+    if (DownloadStatusNotify::IsStatusEvent(type)) {
+        // the service keeps one listener per event, dropping the app's one must not stop the status write
+        return proxy->On(taskId, type, new DownloadStatusNotify(taskId, type, nullptr));
+    }
+    return proxy->Off(taskId, type);
 }
 
 bool DownloadManager::CheckPermission()
 {
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
-        downloadServiceProxy_ = GetDownloadServiceProxy();
-    }
-    if (downloadServiceProxy_ == nullptr) {
-        DOWNLOAD_HILOGE("Resume quit because redoing GetDownloadServiceProxy failed.");
+    sptr<DownloadServiceInterface> proxy = LockedGetProxy();
+    if (proxy == nullptr) {
+        DOWNLOAD_HILOGE("CheckPermission quit because redoing GetDownloadServiceProxy failed.");
         return false;
     }
     DOWNLOAD_HILOGD("DownloadManager CheckPermission succeeded.");
     DOWNLOAD_HILOGD("Check Permission enable");
-    return downloadServiceProxy_->CheckPermission();
+    return proxy->CheckPermission();
+}
+
+sptr<DownloadServiceInterface> DownloadManager::LockedGetProxy()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (downloadServiceProxy_ == nullptr) {
+        DOWNLOAD_HILOGW("Redo GetDownloadServiceProxy");
+        downloadServiceProxy_ = GetDownloadServiceProxy();
+    }
+    return downloadServiceProxy_;
 }
 
 sptr<DownloadServiceInterface> DownloadManager::GetDownloadServiceProxy()
@@ -262,7 +307,9 @@ sptr<DownloadServiceInterface> DownloadManager::GetDownloadServiceProxy()
 
 void DownloadManager::OnRemoteSaDied(const wptr<IRemoteObject> &remote)
 {
-    downloadServiceProxy_ = GetDownloadServiceProxy();
+    // the next call reconnects through LockedGetProxy
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    downloadServiceProxy_ = nullptr;
 }
 
 DownloadSaDeathRecipient::DownloadSaDeathRecipient()
@@ -44,19 +44,7 @@ napi_value DownloadQuery::Exec(napi_env env, napi_callback_info info)
         DOWNLOAD_HILOGD("targetURI: %{public}s", context->info.GetTargetURI().c_str());
         DOWNLOAD_HILOGD("downloadTitle: %{public}s", context->info.GetDownloadTitle().c_str());
         DOWNLOAD_HILOGD("downloadTotalBytes: %{public}d", context->info.GetDownloadTotalBytes());
-        napi_create_object(env, result);
-
-        NapiUtils::SetStringPropertyUtf8(env, *result, "description",  context->info.GetDescription().c_str());
-        NapiUtils::SetUint32Property(env, *result, "downloadedBytes", context->info.GetDownloadedBytes());
-        NapiUtils::SetUint32Property(env, *result, "downloadId", context->info.GetDownloadId());
-        NapiUtils::SetUint32Property(env, *result, "failedReason", context->info.GetFailedReason());
-        NapiUtils::SetStringPropertyUtf8(env, *result, "fileName",  context->info.GetFileName().c_str());
-        NapiUtils::SetStringPropertyUtf8(env, *result, "filePath",  context->info.GetFilePath().c_str());
-        NapiUtils::SetUint32Property(env, *result, "pausedReason", context->info.GetPausedReason());
-        NapiUtils::SetUint32Property(env, *result, "status", context->info.GetStatus());
-        NapiUtils::SetStringPropertyUtf8(env, *result, "targetURI",  context->info.GetTargetURI().c_str());
-        NapiUtils::SetStringPropertyUtf8(env, *result, "downloadTitle", context->info.GetDownloadTitle().c_str());
-        NapiUtils::SetUint32Property(env, *result, "downloadTotalBytes", context->info.GetDownloadTotalBytes());
+        *result = CreateInfo(env, context->info);
         return napi_ok;
     };
     auto exec = [context](AsyncCall::Context *ctx) {
@@ -68,4 +56,23 @@ napi_value DownloadQuery::Exec(napi_env env, napi_callback_info info)
     AsyncCall asyncCall(env, info, std::dynamic_pointer_cast<AsyncCall::Context>(context), 0);
     return asyncCall.Call(env, exec);
 }
+
+napi_value DownloadQuery::CreateInfo(napi_env env, const DownloadInfo &info)
+{
+    napi_value result = nullptr;
+    napi_create_object(env, &result);
+
+    NapiUtils::SetStringPropertyUtf8(env, result, "description",  info.GetDescription().c_str());
+    NapiUtils::SetUint32Property(env, result, "downloadedBytes", info.GetDownloadedBytes());
+    NapiUtils::SetUint32Property(env, result, "downloadId", info.GetDownloadId());
+    NapiUtils::SetUint32Property(env, result, "failedReason", info.GetFailedReason());
+    NapiUtils::SetStringPropertyUtf8(env, result, "fileName",  info.GetFileName().c_str());
+    NapiUtils::SetStringPropertyUtf8(env, result, "filePath",  info.GetFilePath().c_str());
+    NapiUtils::SetUint32Property(env, result, "pausedReason", info.GetPausedReason());
+    NapiUtils::SetUint32Property(env, result, "status", info.GetStatus());
+    NapiUtils::SetStringPropertyUtf8(env, result, "targetURI",  info.GetTargetURI().c_str());
+    NapiUtils::SetStringPropertyUtf8(env, result, "downloadTitle", info.GetDownloadTitle().c_str());
+    NapiUtils::SetUint32Property(env, result, "downloadTotalBytes", info.GetDownloadTotalBytes());
+    return result;
+}
 } // namespace OHOS::Request::Download
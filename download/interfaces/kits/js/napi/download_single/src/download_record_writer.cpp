@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_record_writer.h"
+
+#include <chrono>
+#include <string>
+
+#include "data_ability_predicates.h"
+#include "log.h"
+#include "uri.h"
+
+namespace OHOS::Request::Download {
+static constexpr const char *DOWNLOAD_INFO_URI = "dataability:///com.ohos.download/download/downloadInfo";
+static constexpr int32_t FLUSH_INTERVAL_MS = 20;
+static constexpr size_t FLUSH_BATCH_SIZE = 100;
+
+DownloadRecordWriter::DownloadRecordWriter() : dataAbilityHelper_(nullptr), stop_(false)
+{
+}
+
+DownloadRecordWriter::~DownloadRecordWriter()
+{
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void DownloadRecordWriter::SetDataAbilityHelper(
+    std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (dataAbilityHelper_ == nullptr) {
+        dataAbilityHelper_ = dataAbilityHelper;
+    }
+}
+
+void DownloadRecordWriter::Push(const OHOS::NativeRdb::ValuesBucket &record)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (dataAbilityHelper_ == nullptr) {
+        DOWNLOAD_HILOGE("no data ability helper, drop download record");
+        return;
+    }
+    pending_.push_back(record);
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&DownloadRecordWriter::Run, this);
+    }
+    if (pending_.size() == 1 || pending_.size() >= FLUSH_BATCH_SIZE) {
+        cond_.notify_one();
+    }
+}
+
+void DownloadRecordWriter::PushUpdate(uint32_t taskId, const OHOS::NativeRdb::ValuesBucket &values)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (dataAbilityHelper_ == nullptr) {
+        DOWNLOAD_HILOGE("no data ability helper, drop download record update");
+        return;
+    }
+    pendingUpdates_.emplace_back(taskId, values);
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&DownloadRecordWriter::Run, this);
+    }
+    if (pendingUpdates_.size() == 1) {
+        cond_.notify_one();
+    }
+}
+
+void DownloadRecordWriter::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // sleep until a record arrives, the flush interval only runs while a batch is gathering
+        cond_.wait(lock, [this] { return stop_ || !pending_.empty() || !pendingUpdates_.empty(); });
+        if (!stop_ && pending_.size() < FLUSH_BATCH_SIZE) {
+            cond_.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                [this] { return stop_ || pending_.size() >= FLUSH_BATCH_SIZE; });
+        }
+        if (pending_.empty() && pendingUpdates_.empty()) {
+            // only reached once stopped, everything pushed before has been written
+            break;
+        }
+        std::vector<OHOS::NativeRdb::ValuesBucket> records;
+        records.swap(pending_);
+        std::vector<std::pair<uint32_t, OHOS::NativeRdb::ValuesBucket>> updates;
+        updates.swap(pendingUpdates_);
+        lock.unlock();
+        if (!records.empty()) {
+            WriteRecords(records);
+        }
+        if (!updates.empty()) {
+            WriteUpdates(updates);
+        }
+        lock.lock();
+    }
+}
+
+void DownloadRecordWriter::WriteRecords(const std::vector<OHOS::NativeRdb::ValuesBucket> &records)
+{
+    OHOS::Uri uriDownload(DOWNLOAD_INFO_URI);
+    int ret = dataAbilityHelper_->BatchInsert(uriDownload, records);
+    DOWNLOAD_HILOGI("DownloadRecordWriter write %{public}zu records, ret = %{public}d", records.size(), ret);
+    if (ret >= 0) {
+        return;
+    }
+    // a failed batch may already have committed its first chunks, so each record is written as an upsert:
+    // one bad record must not drop the others and a committed one must not be inserted twice
+    for (const auto &record : records) {
+        OHOS::NativeRdb::ValueObject taskId;
+        if (!record.GetObject("taskId", taskId)) {
+            continue;
+        }
+        int32_t id = 0;
+        taskId.GetInt(id);
+        OHOS::NativeRdb::DataAbilityPredicates predicates;
+        predicates.EqualTo("taskid", std::to_string(id));
+        int rows = dataAbilityHelper_->Update(uriDownload, record, predicates);
+        if (rows > 0) {
+            continue;
+        }
+        int rowId = dataAbilityHelper_->Insert(uriDownload, record);
+        DOWNLOAD_HILOGI("DownloadRecordWriter rowId = %{public}d", rowId);
+    }
+}
+
+void DownloadRecordWriter::WriteUpdates(
+    const std::vector<std::pair<uint32_t, OHOS::NativeRdb::ValuesBucket>> &updates)
+{
+    OHOS::Uri uriDownload(DOWNLOAD_INFO_URI);
+    for (const auto &update : updates) {
+        OHOS::NativeRdb::DataAbilityPredicates predicates;
+        predicates.EqualTo("taskid", std::to_string(update.first));
+        int rows = dataAbilityHelper_->Update(uriDownload, update.second, predicates);
+        DOWNLOAD_HILOGD("DownloadRecordWriter update task[%{public}u], rows = %{public}d", update.first, rows);
+    }
+}
+} // namespace OHOS::Request::Download
@@ -32,19 +32,15 @@ DownloadServiceProxy::DownloadServiceProxy(const sptr<IRemoteObject> &object)
 {
 }
 
-uint32_t DownloadServiceProxy::Request(const DownloadConfig &config)
+bool DownloadServiceProxy::WriteConfig(MessageParcel &data, const DownloadConfig &config)
 {
-    MessageParcel data, reply;
-    MessageOption option;
-    data.WriteInterfaceToken(GetDescriptor());
-
     int32_t fd = -1;
     int32_t err = 0;
 
     const char *inputPath = config.GetFilePath().c_str();
     char path[PATH_MAX + 1] = { 0x00 };
     if (strlen(inputPath) > PATH_MAX || realpath(inputPath, path) == nullptr) {
-        return -1;
+        return false;
     }
     fd = open(path, O_RDWR);
     if (fd > 0) {
@@ -76,6 +72,33 @@ uint32_t DownloadServiceProxy::Request(const DownloadConfig &config)
         data.WriteString(iter->first);
         data.WriteString(iter->second);
     }
+    data.WriteBool(config.GetCacheable());
+    data.WriteUint32(config.GetMirrors().size());
+    for (const auto &mirror : config.GetMirrors()) {
+        data.WriteString(mirror);
+    }
+    data.WriteUint64(config.GetExpectedSize());
+    data.WriteString(config.GetChecksum());
+    data.WriteString(config.GetBlockIndex());
+    data.WriteString(config.GetBasePath());
+    // the old version of the file, blocks it shares with the new one are copied instead of downloaded
+    int32_t baseFd = config.GetBasePath().empty() ? -1 : open(config.GetBasePath().c_str(), O_RDONLY);
+    data.WriteBool(baseFd >= 0);
+    if (baseFd >= 0) {
+        data.WriteFileDescriptor(baseFd);
+        close(baseFd);
+    }
+    return true;
+}
+
+uint32_t DownloadServiceProxy::Request(const DownloadConfig &config)
+{
+    MessageParcel data, reply;
+    MessageOption option;
+    data.WriteInterfaceToken(GetDescriptor());
+    if (!WriteConfig(data, config)) {
+        return -1;
+    }
 
     config.Dump();
     DOWNLOAD_HILOGD("DownloadServiceProxy Request started.");
@@ -118,6 +141,13 @@ bool DownloadServiceProxy::Query(uint32_t taskId, DownloadInfo &info)
         return false;
     }
     DOWNLOAD_HILOGD("DownloadServiceProxy Query succeeded.");
+    ReadInfo(reply, info);
+    info.Dump();
+    return true;
+}
+
+void DownloadServiceProxy::ReadInfo(MessageParcel &reply, DownloadInfo &info)
+{
     info.SetDescription(reply.ReadString());
     info.SetDownloadedBytes(reply.ReadUint32());
     info.SetDownloadId(reply.ReadUint32());
@@ -129,8 +159,6 @@ bool DownloadServiceProxy::Query(uint32_t taskId, DownloadInfo &info)
     info.SetTargetURI(reply.ReadString());
     info.SetDownloadTitle(reply.ReadString());
     info.SetDownloadTotalBytes(reply.ReadUint32());
-    info.Dump();
-    return true;
 }
 
 bool DownloadServiceProxy::QueryMimeType(uint32_t taskId, std::string &mimeType)
@@ -273,24 +301,147 @@ bool DownloadServiceProxy::CheckPermission()
     return ret;
 }
 
-bool DownloadServiceProxy::SetStartId(uint32_t startId)
+uint32_t DownloadServiceProxy::RequestGroup(const std::vector<DownloadConfig> &configs, std::vector<uint32_t> &taskIds)
 {
-    DOWNLOAD_HILOGD("DownloadServiceProxy::SetStartId in");
+    if (configs.empty() || configs.size() > GROUP_MAX_TASKS) {
+        DOWNLOAD_HILOGE("invalid group size %{public}zu", configs.size());
+        return -1;
+    }
     MessageParcel data, reply;
     MessageOption option;
-    if (!data.WriteInterfaceToken(GetDescriptor())) {
-        DOWNLOAD_HILOGE(" Failed to write parcelable ");
+    data.WriteInterfaceToken(GetDescriptor());
+    data.WriteUint32(configs.size());
+    for (const auto &config : configs) {
+        if (!WriteConfig(data, config)) {
+            DOWNLOAD_HILOGE("invalid file path in group");
+            return -1;
+        }
+    }
+    DOWNLOAD_HILOGD("DownloadServiceProxy RequestGroup started.");
+    int32_t ret = Remote()->SendRequest(CMD_REQUEST_GROUP, data, reply, option);
+    if (ret != ERR_NONE) {
+        DOWNLOAD_HILOGE("RequestGroup, ret = %{public}d", ret);
+        return -1;
+    }
+    uint32_t groupId = reply.ReadUint32();
+    uint32_t taskCount = reply.ReadUint32();
+    if (taskCount > configs.size()) {
+        return -1;
+    }
+    taskIds.clear();
+    for (uint32_t i = 0; i < taskCount; i++) {
+        taskIds.push_back(reply.ReadUint32());
+    }
+    DOWNLOAD_HILOGD("DownloadServiceProxy RequestGroup succeeded. GroupId = %{public}d", groupId);
+    return groupId;
+}
+
+bool DownloadServiceProxy::GroupAction(uint32_t groupId, uint32_t action)
+{
+    MessageParcel data, reply;
+    MessageOption option;
+    data.WriteInterfaceToken(GetDescriptor());
+    data.WriteUint32(groupId);
+    data.WriteUint32(action);
+    int32_t ret = Remote()->SendRequest(CMD_GROUP_ACTION, data, reply, option);
+    if (ret != ERR_NONE) {
+        DOWNLOAD_HILOGE("GroupAction, ret = %{public}d", ret);
         return false;
     }
-    data.WriteUint32(startId);
-    
-    int32_t result = Remote()->SendRequest(CMD_SETSTARTID, data, reply, option);
-    if (result != ERR_NONE) {
-        DOWNLOAD_HILOGE(" DownloadServiceProxy::SetStartId fail, ret = %{public}d ", result);
+    return reply.ReadBool();
+}
+
+void DownloadServiceProxy::WriteFilter(MessageParcel &data, const DownloadFilter &filter)
+{
+    data.WriteUint32(filter.mask);
+    data.WriteUint32(filter.status);
+    data.WriteUint32(filter.pausedReason);
+    data.WriteUint32(filter.startId);
+    data.WriteUint32(filter.taskIds.size());
+    for (auto taskId : filter.taskIds) {
+        data.WriteUint32(taskId);
+    }
+}
+
+bool DownloadServiceProxy::BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds)
+{
+    if (filter.taskIds.size() > BATCH_MAX_TASKS) {
+        DOWNLOAD_HILOGE("too many tasks in batch %{public}zu", filter.taskIds.size());
         return false;
     }
-    bool ret = reply.ReadBool();
-    DOWNLOAD_HILOGD("DownloadServiceProxy::SetStartId out [ret: %{public}d]", ret);
-    return ret;
+    MessageParcel data, reply;
+    MessageOption option;
+    data.WriteInterfaceToken(GetDescriptor());
+    WriteFilter(data, filter);
+    data.WriteUint32(action);
+    DOWNLOAD_HILOGD("DownloadServiceProxy BatchAction started.");
+    int32_t ret = Remote()->SendRequest(CMD_BATCH_ACTION, data, reply, option);
+    if (ret != ERR_NONE) {
+        DOWNLOAD_HILOGE("BatchAction, ret = %{public}d", ret);
+        return false;
+    }
+    if (!reply.ReadBool()) {
+        return false;
+    }
+    uint32_t count = reply.ReadUint32();
+    if (count > BATCH_MAX_TASKS) {
+        return false;
+    }
+    taskIds.clear();
+    for (uint32_t i = 0; i < count; i++) {
+        taskIds.push_back(reply.ReadUint32());
+    }
+    DOWNLOAD_HILOGD("DownloadServiceProxy BatchAction succeeded on %{public}d tasks.", count);
+    return true;
+}
+
+/**
+ * @brief Collect the infos of all selected tasks. The service answers page by page as the infos carry
+ * strings, so large selections take a few transactions instead of one per task
+ */
+bool DownloadServiceProxy::BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos)
+{
+    if (filter.taskIds.size() > BATCH_MAX_TASKS) {
+        DOWNLOAD_HILOGE("too many tasks in batch %{public}zu", filter.taskIds.size());
+        return false;
+    }
+    DownloadFilter page = filter;
+    infos.clear();
+    bool hasMore = true;
+    while (hasMore) {
+        MessageParcel data, reply;
+        MessageOption option;
+        data.WriteInterfaceToken(GetDescriptor());
+        WriteFilter(data, page);
+        int32_t ret = Remote()->SendRequest(CMD_BATCH_QUERY, data, reply, option);
+        if (ret != ERR_NONE) {
+            DOWNLOAD_HILOGE("BatchQuery, ret = %{public}d", ret);
+            return false;
+        }
+        uint32_t count = reply.ReadUint32();
+        if (count > BATCH_MAX_TASKS) {
+            return false;
+        }
+        for (uint32_t i = 0; i < count; i++) {
+            DownloadInfo info;
+            ReadInfo(reply, info);
+            infos.push_back(info);
+        }
+        hasMore = reply.ReadBool();
+        if (infos.size() >= BATCH_MAX_TASKS) {
+            // the lowest ids are kept, a narrower filter reaches the rest
+            DOWNLOAD_HILOGW("BatchQuery truncated to %{public}u tasks", BATCH_MAX_TASKS);
+            infos.resize(BATCH_MAX_TASKS);
+            break;
+        }
+        uint32_t nextId = reply.ReadUint32();
+        if (hasMore && nextId <= page.startId) {
+            DOWNLOAD_HILOGE("BatchQuery cursor does not advance");
+            return false;
+        }
+        page.startId = nextId;
+    }
+    DOWNLOAD_HILOGD("DownloadServiceProxy BatchQuery succeeded with %{public}zu tasks.", infos.size());
+    return true;
 }
 } // namespace OHOS::Request::Download
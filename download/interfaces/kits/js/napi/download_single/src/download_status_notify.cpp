@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2021-2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "download_status_notify.h"
+
+#include "constant.h"
+#include "download_manager.h"
+#include "download_task.h"
+#include "log.h"
+
+namespace OHOS::Request::Download {
+DownloadStatusNotify::DownloadStatusNotify(uint32_t taskId, const std::string &type,
+    const sptr<DownloadNotifyInterface> &listener)
+    : DownloadNotifyStub(), taskId_(taskId), type_(type), listener_(listener)
+{
+}
+
+DownloadStatusNotify::~DownloadStatusNotify()
+{
+    DOWNLOAD_HILOGD("");
+}
+
+bool DownloadStatusNotify::IsStatusEvent(const std::string &type)
+{
+    return type == EVENT_COMPLETE || type == EVENT_FAIL;
+}
+
+void DownloadStatusNotify::OnCallBack(MessageParcel &data)
+{
+    DOWNLOAD_HILOGD("Status callback in, task[%{public}u] %{public}s", taskId_, type_.c_str());
+    // the app's listener reads the same arguments, so the read position is restored before forwarding
+    size_t position = data.GetReadPosition();
+    uint32_t reason = data.ReadUint32();
+    data.RewindRead(position);
+    if (type_ == EVENT_FAIL) {
+        DownloadManager::GetInstance()->SaveStatus(taskId_, SESSION_FAILED, reason);
+    } else {
+        DownloadManager::GetInstance()->SaveStatus(taskId_, SESSION_SUCCESS, 0);
+    }
+    if (listener_ != nullptr) {
+        listener_->OnCallBack(data);
+    }
+}
+} // namespace OHOS::Request::Download
@@ -38,6 +38,11 @@ uint32_t DownloadTask::GetId() const
     return taskId_;
 }
 
+void DownloadTask::SetId(uint32_t taskId)
+{
+    taskId_ = taskId;
+}
+
 bool DownloadTask::AddListener(const std::string &type, sptr<DownloadNotifyInterface> listener)
 {
     std::lock_guard<std::mutex> autoLock(mutex_);
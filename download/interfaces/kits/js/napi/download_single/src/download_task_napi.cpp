@@ -21,6 +21,7 @@
 #include "ability.h"
 #include "async_call.h"
 #include "download_event.h"
+#include "download_group_action.h"
 #include "download_manager.h"
 #include "download_pause.h"
 #include "download_query.h"
@@ -47,9 +48,16 @@ static constexpr const char *PARAM_KEY_DESCRIPTION = "description";
 static constexpr const char *PARAM_KEY_NETWORKTYPE = "networkType";
 static constexpr const char *PARAM_KEY_FILE_PATH = "filePath";
 static constexpr const char *PARAM_KEY_TITLE = "title";
+static constexpr const char *PARAM_KEY_CACHE = "enableCache";
+static constexpr const char *PARAM_KEY_MIRRORS = "mirrors";
+static constexpr const char *PARAM_KEY_SIZE = "size";
+static constexpr const char *PARAM_KEY_SHA256 = "sha256";
+static constexpr const char *PARAM_KEY_BLOCK_INDEX = "blockIndex";
+static constexpr const char *PARAM_KEY_BASE_FILE = "baseFile";
 
 namespace OHOS::Request::Download {
 __thread napi_ref DownloadTaskNapi::globalCtor = nullptr;
+__thread napi_ref DownloadTaskNapi::groupCtor = nullptr;
 std::mutex mutex_;
 napi_value DownloadTaskNapi::JsMain(napi_env env, napi_callback_info info)
 {
@@ -59,34 +67,146 @@ napi_value DownloadTaskNapi::JsMain(napi_env env, napi_callback_info info)
         return Legacy::DownloadManager::Download(env, info);
     }
 
-    if (!DownloadManager::GetInstance()->CheckPermission()) {
-        DOWNLOAD_HILOGD("no permission to access download service");
-        return nullptr;
-    }
     struct ContextInfo {
         napi_ref ref = nullptr;
+        DownloadTask *task = nullptr;
+        DownloadConfig config;
+        std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper = nullptr;
+        bool result = false;
     };
     auto ctxInfo = std::make_shared<ContextInfo>();
     auto input = [ctxInfo](napi_env env, size_t argc, napi_value *argv, napi_value self) -> napi_status {
         DOWNLOAD_HILOGD("download parser to native params %{public}d!", static_cast<int>(argc));
         NAPI_ASSERT_BASE(env, (argc > 0) && (argc <= 2), " need 1 or 2 parameters!", napi_invalid_arg);
+        if (!ParseConfig(env, argv[0], ctxInfo->config)) {
+            DOWNLOAD_HILOGE("download config has wrong type");
+            return napi_invalid_arg;
+        }
+        // the helper is created from the JS ability object, so fetch it here on the JS thread
+        ctxInfo->dataAbilityHelper = GetDataAbilityHelper(env);
         napi_value proxy = nullptr;
         napi_status status = napi_new_instance(env, GetCtor(env), argc, argv, &proxy);
         if ((proxy == nullptr) || (status != napi_ok)) {
             DOWNLOAD_HILOGE("Failed to create download task");
             return napi_generic_failure;
         }
+        status = napi_unwrap(env, proxy, reinterpret_cast<void **>(&ctxInfo->task));
+        if ((ctxInfo->task == nullptr) || (status != napi_ok)) {
+            DOWNLOAD_HILOGE("Failed to get download task");
+            return napi_generic_failure;
+        }
+        napi_create_reference(env, proxy, 1, &(ctxInfo->ref));
+        return napi_ok;
+    };
+    auto output = [ctxInfo](napi_env env, napi_value *result) -> napi_status {
+        if (!ctxInfo->result) {
+            napi_delete_reference(env, ctxInfo->ref);
+            return napi_generic_failure;
+        }
+        napi_status status = napi_get_reference_value(env, ctxInfo->ref, result);
+        napi_delete_reference(env, ctxInfo->ref);
+        return status;
+    };
+    auto exec = [ctxInfo](AsyncCall::Context *ctx) {
+        if (!DownloadManager::GetInstance()->CheckPermission()) {
+            DOWNLOAD_HILOGD("no permission to access download service");
+            return;
+        }
+        DownloadManager::GetInstance()->SetDataAbilityHelper(ctxInfo->dataAbilityHelper);
+        uint32_t taskId = INVALID_TASK_ID;
+        ctxInfo->result = DownloadManager::GetInstance()->EnqueueTask(ctxInfo->config, taskId);
+        if (ctxInfo->result) {
+            // the JS object is not handed out before output, so nobody reads the id concurrently
+            ctxInfo->task->SetId(taskId);
+        }
+    };
+    auto context = std::make_shared<AsyncCall::Context>(input, output);
+    AsyncCall asyncCall(env, info, context, 1);
+    return asyncCall.Call(env, exec);
+}
+
+/**
+ * @brief downloadGroup(configs): enqueue a list of downloads with one IPC. The returned object carries
+ * the group id, so on/off reuse the event plumbing of a single task and receive aggregated events
+ */
+napi_value DownloadTaskNapi::JsGroup(napi_env env, napi_callback_info info)
+{
+    DOWNLOAD_HILOGD("Enter downloadGroup JsGroup.");
+    struct ContextInfo {
+        napi_ref ref = nullptr;
+        DownloadTask *task = nullptr;
+        std::vector<DownloadConfig> configs;
+        std::shared_ptr<OHOS::AppExecFwk::DataAbilityHelper> dataAbilityHelper = nullptr;
+        bool result = false;
+    };
+    auto ctxInfo = std::make_shared<ContextInfo>();
+    auto input = [ctxInfo](napi_env env, size_t argc, napi_value *argv, napi_value self) -> napi_status {
+        NAPI_ASSERT_BASE(env, (argc > 0) && (argc <= 2), " need 1 or 2 parameters!", napi_invalid_arg);
+        if (!ParseConfigList(env, argv[0], ctxInfo->configs)) {
+            DOWNLOAD_HILOGE("download group configs have wrong type");
+            return napi_invalid_arg;
+        }
+        ctxInfo->dataAbilityHelper = GetDataAbilityHelper(env);
+        napi_value proxy = nullptr;
+        napi_status status = napi_new_instance(env, GetGroupCtor(env), 0, nullptr, &proxy);
+        if ((proxy == nullptr) || (status != napi_ok)) {
+            DOWNLOAD_HILOGE("Failed to create download group");
+            return napi_generic_failure;
+        }
+        status = napi_unwrap(env, proxy, reinterpret_cast<void **>(&ctxInfo->task));
+        if ((ctxInfo->task == nullptr) || (status != napi_ok)) {
+            DOWNLOAD_HILOGE("Failed to get download group");
+            return napi_generic_failure;
+        }
         napi_create_reference(env, proxy, 1, &(ctxInfo->ref));
         return napi_ok;
     };
     auto output = [ctxInfo](napi_env env, napi_value *result) -> napi_status {
+        if (!ctxInfo->result) {
+            napi_delete_reference(env, ctxInfo->ref);
+            return napi_generic_failure;
+        }
         napi_status status = napi_get_reference_value(env, ctxInfo->ref, result);
         napi_delete_reference(env, ctxInfo->ref);
         return status;
     };
+    auto exec = [ctxInfo](AsyncCall::Context *ctx) {
+        if (!DownloadManager::GetInstance()->CheckPermission()) {
+            DOWNLOAD_HILOGD("no permission to access download service");
+            return;
+        }
+        DownloadManager::GetInstance()->SetDataAbilityHelper(ctxInfo->dataAbilityHelper);
+        uint32_t groupId = INVALID_TASK_ID;
+        ctxInfo->result = DownloadManager::GetInstance()->EnqueueGroup(ctxInfo->configs, groupId);
+        if (ctxInfo->result) {
+            ctxInfo->task->SetId(groupId);
+        }
+    };
     auto context = std::make_shared<AsyncCall::Context>(input, output);
     AsyncCall asyncCall(env, info, context, 1);
-    return asyncCall.Call(env);
+    return asyncCall.Call(env, exec);
+}
+
+napi_value DownloadTaskNapi::GetGroupCtor(napi_env env)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    napi_value cons;
+    if (groupCtor != nullptr) {
+        NAPI_CALL(env, napi_get_reference_value(env, groupCtor, &cons));
+        return cons;
+    }
+
+    napi_property_descriptor clzDes[] = {
+        {FUNCTION_ON, 0, DownloadEvent::On, 0, 0, 0, napi_default, 0},
+        {FUNCTION_OFF, 0, DownloadEvent::Off, 0, 0, 0, napi_default, 0},
+        {FUNCTION_PAUSE, 0, DownloadGroupAction::Pause, 0, 0, 0, napi_default, 0},
+        {FUNCTION_REMOVE, 0, DownloadGroupAction::Remove, 0, 0, 0, napi_default, 0},
+        {FUNCTION_RESUME, 0, DownloadGroupAction::Resume, 0, 0, 0, napi_default, 0},
+    };
+    NAPI_CALL(env, napi_define_class(env, "DownloadGroupNapi", NAPI_AUTO_LENGTH, Initialize, nullptr,
+                       sizeof(clzDes) / sizeof(napi_property_descriptor), clzDes, &cons));
+    NAPI_CALL(env, napi_create_reference(env, cons, 1, &groupCtor));
+    return cons;
 }
 
 napi_value DownloadTaskNapi::GetCtor(napi_env env)
@@ -121,13 +241,8 @@ napi_value DownloadTaskNapi::Initialize(napi_env env, napi_callback_info info)
     napi_value argv[NapiUtils::MAX_ARGC] = {nullptr};
     NAPI_CALL(env, napi_get_cb_info(env, info, &argc, argv, &self, nullptr));
 
-    DownloadConfig config;
-    if (!ParseConfig(env, argv[0], config)) {
-        DOWNLOAD_HILOGE("download config has wrong type");
-        return nullptr;
-    }
-    DownloadManager::GetInstance()->SetDataAbilityHelper(GetDataAbilityHelper(env));
-    auto *task = DownloadManager::GetInstance()->EnqueueTask(config);
+    // the task is enqueued by the async work of JsMain, which assigns the real id
+    auto *task = new DownloadTask(INVALID_TASK_ID);
 
     auto finalize = [](napi_env env, void *data, void *hint) {
         DOWNLOAD_HILOGD("destructed download task");
@@ -154,6 +269,67 @@ bool DownloadTaskNapi::ParseConfig(napi_env env, napi_value configValue, Downloa
     config.SetNetworkType(NapiUtils::GetUint32Property(env, configValue, PARAM_KEY_NETWORKTYPE));
     config.SetFilePath(NapiUtils::GetStringPropertyUtf8(env, configValue, PARAM_KEY_FILE_PATH));
     config.SetTitle(NapiUtils::GetStringPropertyUtf8(env, configValue, PARAM_KEY_TITLE));
+    config.SetCacheable(NapiUtils::GetBooleanProperty(env, configValue, PARAM_KEY_CACHE));
+    config.SetChecksum(NapiUtils::ToLower(NapiUtils::GetStringPropertyUtf8(env, configValue, PARAM_KEY_SHA256)));
+    config.SetBlockIndex(NapiUtils::GetStringPropertyUtf8(env, configValue, PARAM_KEY_BLOCK_INDEX));
+    config.SetBasePath(NapiUtils::GetStringPropertyUtf8(env, configValue, PARAM_KEY_BASE_FILE));
+    if (NapiUtils::HasNamedProperty(env, configValue, PARAM_KEY_SIZE)) {
+        int64_t size = 0;
+        napi_get_value_int64(env, NapiUtils::GetNamedProperty(env, configValue, PARAM_KEY_SIZE), &size);
+        config.SetExpectedSize(size > 0 ? static_cast<uint64_t>(size) : 0);
+    }
+    return ParseMirrors(env, configValue, config);
+}
+
+bool DownloadTaskNapi::ParseConfigList(napi_env env, napi_value listValue, std::vector<DownloadConfig> &configs)
+{
+    bool isArray = false;
+    napi_is_array(env, listValue, &isArray);
+    if (!isArray) {
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, listValue, &length);
+    if (length == 0 || length > GROUP_MAX_TASKS) {
+        DOWNLOAD_HILOGE("invalid group size %{public}d", length);
+        return false;
+    }
+    configs.resize(length);
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value configValue = nullptr;
+        napi_get_element(env, listValue, i, &configValue);
+        if (NapiUtils::GetValueType(env, configValue) != napi_object || !ParseConfig(env, configValue, configs[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DownloadTaskNapi::ParseMirrors(napi_env env, napi_value configValue, DownloadConfig &config)
+{
+    if (!NapiUtils::HasNamedProperty(env, configValue, PARAM_KEY_MIRRORS)) {
+        return true;
+    }
+    napi_value mirrors = NapiUtils::GetNamedProperty(env, configValue, PARAM_KEY_MIRRORS);
+    bool isArray = false;
+    napi_is_array(env, mirrors, &isArray);
+    if (!isArray) {
+        return false;
+    }
+    uint32_t length = 0;
+    napi_get_array_length(env, mirrors, &length);
+    if (length > DOWNLOAD_MAX_MIRRORS) {
+        DOWNLOAD_HILOGE("too many mirrors %{public}d", length);
+        return false;
+    }
+    for (uint32_t i = 0; i < length; i++) {
+        napi_value mirror = nullptr;
+        napi_get_element(env, mirrors, i, &mirror);
+        if (NapiUtils::GetValueType(env, mirror) != napi_string) {
+            return false;
+        }
+        config.AddMirror(NapiUtils::GetStringFromValueUtf8(env, mirror));
+    }
     return true;
 }
 
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_BLOCK_INDEX_H
+#define DOWNLOAD_BLOCK_INDEX_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "download_segment_fetcher.h"
+
+namespace OHOS::Request::Download {
+/*
+ * Block checksum index of a file, published next to it by the server as text:
+ *
+ *     blockindex 1
+ *     length <file size>
+ *     blocksize <block size>
+ *     <weak sum as 8 hex digits> <sha256 as hex>      one line per block
+ *
+ * The weak sum is the rsync rolling checksum, so blocks of an older local copy are found at any offset.
+ * A plain index has blocks but no sums, it only tracks which ranges of a file without an index are in place.
+ */
+class DownloadBlockIndex final {
+public:
+    DownloadBlockIndex() = default;
+    ~DownloadBlockIndex() = default;
+
+    FetchResult Load(const std::string &url, const std::vector<std::string> &headerLines, CURLSH *share);
+    bool Parse(const std::string &content);
+    void InitPlain(uint64_t length, const std::string &identity);
+
+    uint64_t GetLength() const;
+    const std::string &GetIndexDigest() const;
+    size_t GetBlockCount() const;
+    FetchRange GetBlock(size_t index) const;
+    const std::string &GetDigest(size_t index) const;
+
+    uint64_t CopyMatches(int32_t baseFd, int32_t fd, std::vector<bool> &present,
+        const std::function<bool()> &stop) const;
+    std::vector<FetchRange> GetMissingRanges(const std::vector<bool> &present) const;
+
+    static uint32_t WeakSum(const unsigned char *data, size_t len);
+    static uint32_t RollWeakSum(uint32_t sum, unsigned char out, unsigned char in, size_t len);
+
+private:
+    static size_t WriteCallback(void *buffer, size_t size, size_t num, void *param);
+
+    struct BlockSum {
+        uint32_t weak = 0;
+        std::string digest;
+    };
+
+    uint64_t length_ = 0;
+    uint64_t blockSize_ = 0;
+    std::vector<BlockSum> blocks_;
+    std::string indexDigest_;
+};
+
+/*
+ * Checks every block of the index as soon as all of its bytes are written and asks for a corrupted one
+ * again, a block of a plain index counts as verified once all of its bytes are written. Verified blocks are
+ * recorded in a checkpoint file so a resumed task never fetches them twice.
+ */
+class DownloadBlockVerifier final {
+public:
+    DownloadBlockVerifier(const DownloadBlockIndex &index, int32_t fd, const std::string &checkpointPath);
+    ~DownloadBlockVerifier() = default;
+
+    std::vector<bool> &GetVerified();
+    uint64_t GetVerifiedBytes() const;
+    bool IsCorrupted() const;
+
+    void OnWritten(const FetchRange &written, std::vector<FetchRange> &refetch);
+
+    bool LoadCheckpoint();
+    void SaveCheckpoint(bool force);
+    void RemoveCheckpoint();
+
+private:
+    const DownloadBlockIndex &index_;
+    int32_t fd_;
+    std::string checkpointPath_;
+    std::vector<bool> verified_;
+    std::vector<uint64_t> received_;
+    std::vector<uint32_t> retries_;
+    bool corrupted_;
+    bool dirty_;
+    std::chrono::steady_clock::time_point lastSave_;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_BLOCK_INDEX_H
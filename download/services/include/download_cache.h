@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_CACHE_H
+#define DOWNLOAD_CACHE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <openssl/sha.h>
+
+namespace OHOS::Request::Download {
+struct CacheHeaders {
+    std::string etag;
+    std::string lastModified;
+    std::vector<std::string> vary;
+    int64_t maxAge = -1;
+    /* a 304 without Cache-Control keeps the freshness of the stored entry */
+    bool hasCacheControl = false;
+    bool noStore = false;
+    bool noCache = false;
+    bool isPrivate = false;
+};
+
+struct CacheEntry {
+    std::string url;
+    std::string key;
+    std::string etag;
+    std::string lastModified;
+    std::string mimeType;
+    std::string digest;
+    uint64_t size = 0;
+    int64_t storedTime = 0;
+    int64_t maxAge = -1;
+    bool noCache = false;
+};
+
+/*
+ * Local HTTP cache of the download service. Index entries are keyed by the URL plus the request values
+ * of the headers named by Vary and point to a blob named by the SHA-256 of the body, so identical bodies
+ * fetched from different URLs are stored once. Entries are revalidated with If-None-Match and
+ * If-Modified-Since unless Cache-Control max-age keeps them fresh.
+ */
+class DownloadCache final {
+public:
+    static DownloadCache &GetInstance();
+
+    bool Lookup(const std::string &url, const std::map<std::string, std::string> &requestHeader, CacheEntry &entry);
+    bool IsFresh(const CacheEntry &entry) const;
+    bool CopyTo(const CacheEntry &entry, int32_t fd);
+    bool Refresh(CacheEntry &entry, const CacheHeaders &headers);
+    bool Store(const std::string &url, const std::map<std::string, std::string> &requestHeader,
+        const CacheHeaders &headers, CacheEntry &entry, const std::string &tmpPath);
+    std::string MakeTempPath();
+
+    static void ParseHeader(const std::string &line, CacheHeaders &headers);
+    static bool IsStorable(const std::map<std::string, std::string> &requestHeader, const CacheHeaders &headers);
+    static std::vector<std::string> MakeValidators(const CacheEntry &entry);
+    static std::string ToHex(const unsigned char *data, size_t len);
+
+private:
+    DownloadCache();
+    DownloadCache(const DownloadCache &) = delete;
+    DownloadCache &operator=(const DownloadCache &) = delete;
+
+    bool PrepareDirs();
+    std::string MakeKey(const std::string &url, const std::vector<std::string> &vary,
+        const std::map<std::string, std::string> &requestHeader) const;
+    bool ReadVary(const std::string &url, std::vector<std::string> &vary);
+    bool WriteVary(const std::string &url, const std::vector<std::string> &vary);
+    bool ReadEntry(const std::string &key, CacheEntry &entry);
+    bool WriteEntry(const CacheEntry &entry);
+    void RemoveEntry(const std::string &key);
+    void Evict();
+
+private:
+    std::mutex mutex_;
+    bool dirsReady_;
+    uint32_t tmpSeq_;
+};
+
+/*
+ * Tees a response body into a temporary cache file while hashing it. Commit hands the file to
+ * DownloadCache, Abort drops it. Bodies larger than the cache entry limit are not kept.
+ */
+class DownloadCacheWriter final {
+public:
+    DownloadCacheWriter();
+    ~DownloadCacheWriter();
+
+    bool Open();
+    bool IsOpen() const;
+    void Write(const void *buffer, size_t len);
+    bool Commit(const std::string &url, const std::map<std::string, std::string> &requestHeader,
+        const CacheHeaders &headers, const std::string &mimeType);
+    void Abort();
+
+private:
+    int32_t fd_;
+    std::string tmpPath_;
+    uint64_t size_;
+    SHA256_CTX ctx_;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_CACHE_H
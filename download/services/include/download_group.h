@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_GROUP_H
+#define DOWNLOAD_GROUP_H
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "curl/curl.h"
+#include "download_service_task.h"
+
+namespace OHOS::Request::Download {
+/*
+ * DNS cache and TLS sessions shared by the members of a group, so a manifest of files on the same host
+ * resolves once and resumes the TLS session instead of a full handshake. Connections are not shared,
+ * members run on different download threads.
+ */
+class DownloadShare final {
+public:
+    DownloadShare();
+    ~DownloadShare();
+
+    CURLSH *GetHandle() const;
+
+private:
+    DownloadShare(const DownloadShare &) = delete;
+    DownloadShare &operator=(const DownloadShare &) = delete;
+
+    static void Lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *param);
+    static void Unlock(CURL *handle, curl_lock_data data, void *param);
+
+private:
+    CURLSH *share_;
+    std::mutex locks_[CURL_LOCK_DATA_LAST];
+};
+
+/*
+ * Tracks the members of a group download and turns their events into one stream keyed by the group id:
+ * throttled "progress" with the summed sizes, "pause" once every unfinished member is paused, then a
+ * single "complete", or "fail" carrying the number of failed members.
+ */
+class DownloadGroup final {
+public:
+    DownloadGroup(uint32_t groupId, DownloadTaskCallback eventCb);
+    ~DownloadGroup() = default;
+
+    uint32_t GetId() const;
+    std::shared_ptr<DownloadShare> GetShare() const;
+    std::vector<uint32_t> GetMembers();
+    bool IsFinished();
+
+    void AddMember(uint32_t taskId);
+    void RemoveMember(uint32_t taskId);
+    void OnMemberEvent(const std::string &type, uint32_t taskId, uint32_t argv1, uint32_t argv2);
+    void OnResume();
+    void NotifyRemove();
+
+private:
+    struct MemberState {
+        uint32_t received = 0;
+        uint32_t total = 0;
+        DownloadStatus status = SESSION_UNKNOWN;
+    };
+
+    struct GroupEvent {
+        std::string type;
+        uint32_t argv1 = 0;
+        uint32_t argv2 = 0;
+    };
+
+    void CollectProgress(std::vector<GroupEvent> &events, bool force);
+    void CollectSettled(std::vector<GroupEvent> &events);
+    void Emit(const std::vector<GroupEvent> &events);
+
+private:
+    uint32_t groupId_;
+    DownloadTaskCallback eventCb_;
+    std::shared_ptr<DownloadShare> share_;
+
+    std::mutex mutex_;
+    std::map<uint32_t, MemberState> members_;
+    std::chrono::steady_clock::time_point lastProgress_;
+    bool pauseReported_;
+    bool finished_;
+    bool removed_;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_GROUP_H
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DOWNLOAD_SEGMENT_FETCHER_H
+#define DOWNLOAD_SEGMENT_FETCHER_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "curl/curl.h"
+
+namespace OHOS::Request::Download {
+struct FetchRange {
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
+
+enum class FetchResult {
+    SUCCESS,
+    STOPPED,
+    NETWORK_ERROR,
+    /* no source honours Range requests, only a single stream download can work */
+    RANGE_UNSUPPORTED,
+    FAILED,
+};
+
+/*
+ * Fills byte ranges of a file from one or more sources holding the same content. Ranges are cut into
+ * segments that run in parallel on one curl multi handle, each segment going to the source that currently
+ * delivers fastest. A failed segment is requeued from the byte it stopped at, a source that keeps failing is
+ * dropped, and near the end an idle fast source takes over the tail of a segment stuck on a slow one.
+ */
+class DownloadSegmentFetcher final {
+public:
+    using ProgressHook = std::function<void(uint64_t bytes)>;
+    using StopHook = std::function<bool()>;
+    using WrittenHook = std::function<void(const FetchRange &written)>;
+
+    DownloadSegmentFetcher(int32_t fd, const std::vector<std::string> &sources,
+        const std::vector<std::string> &headerLines);
+    ~DownloadSegmentFetcher();
+
+    void SetShare(CURLSH *share);
+    void SetProgressHook(ProgressHook hook);
+    void SetStopHook(StopHook hook);
+    void SetWrittenHook(WrittenHook hook);
+
+    FetchResult Fetch(const std::vector<FetchRange> &ranges);
+    void Requeue(const FetchRange &range);
+
+    static bool HashRange(int32_t fd, uint64_t offset, uint64_t length, std::string &hex);
+    static void ApplyOptions(CURL *handle, struct curl_slist *header, CURLSH *share);
+    static bool IsNetworkError(CURLcode code);
+
+private:
+    DownloadSegmentFetcher(const DownloadSegmentFetcher &) = delete;
+    DownloadSegmentFetcher &operator=(const DownloadSegmentFetcher &) = delete;
+
+    struct Source {
+        std::string url;
+        uint32_t active = 0;
+        uint32_t failures = 0;
+        double rate = 0.0;
+        bool measured = false;
+        bool disabled = false;
+    };
+
+    struct Transfer {
+        DownloadSegmentFetcher *owner = nullptr;
+        CURL *handle = nullptr;
+        size_t source = 0;
+        uint64_t offset = 0;
+        uint64_t length = 0;
+        uint64_t received = 0;
+        bool badStatus = false;
+        bool ignoresRange = false;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    int32_t PickSource() const;
+    bool StartTransfer(size_t source, const FetchRange &range);
+    void FinishTransfer(CURL *handle, CURLcode code);
+    void StealTail();
+    void UpdateRate(Source &source, uint64_t bytes, std::chrono::steady_clock::time_point start);
+    void FlushProgress(bool force);
+    void Cleanup();
+
+    static size_t WriteCallback(void *buffer, size_t size, size_t num, void *param);
+
+private:
+    int32_t fd_;
+    std::vector<Source> sources_;
+    std::vector<std::string> headerLines_;
+    struct curl_slist *header_;
+    CURLSH *share_;
+    CURLM *multi_;
+    ProgressHook progressHook_;
+    StopHook stopHook_;
+    WrittenHook writtenHook_;
+
+    std::deque<FetchRange> pending_;
+    std::map<CURL *, std::unique_ptr<Transfer>> transfers_;
+    bool fileError_;
+    bool networkError_;
+    bool rangeIgnored_;
+    uint64_t unreported_;
+    std::chrono::steady_clock::time_point lastReport_;
+};
+} // namespace OHOS::Request::Download
+#endif // DOWNLOAD_SEGMENT_FETCHER_H
@@ -52,7 +52,11 @@ public:
 
     bool CheckPermission() override;
 
-    bool SetStartId(uint32_t startId) override;
+
+    uint32_t RequestGroup(const std::vector<DownloadConfig> &configs, std::vector<uint32_t> &taskIds) override;
+    bool GroupAction(uint32_t groupId, uint32_t action) override;
+    bool BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds) override;
+    bool BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos) override;
 
     static void NotifyHandler(const std::string& type, uint32_t taskId, uint32_t argv1, uint32_t argv2);
 
@@ -65,6 +69,8 @@ private:
     int32_t Init();
     void InitServiceHandler();
     void ManualStart();
+    static bool IsNativeCaller();
+    static void NotifyFinished(uint32_t taskId, const std::string &type, const sptr<DownloadNotifyInterface> &listener);
 
 private:
     ServiceRunningState state_;
@@ -23,6 +23,8 @@
 
 #include "constant.h"
 #include "download_config.h"
+#include "download_filter.h"
+#include "download_group.h"
 #include "download_info.h"
 #include "download_service_task.h"
 #include "download_thread.h"
@@ -35,22 +37,26 @@ public:
 
     static std::shared_ptr<DownloadServiceManager> Get();
 
-    bool Create(uint32_t threadNum);
+    bool Create(uint32_t threadNum, DownloadTaskCallback eventCb);
     void Destroy();
 
     uint32_t AddTask(const DownloadConfig &config);
     void InstallCallback(uint32_t taskId, DownloadTaskCallback eventCb);
     bool ProcessTask();
 
+    uint32_t AddGroup(const std::vector<DownloadConfig> &configs, DownloadTaskCallback eventCb,
+        std::vector<uint32_t> &taskIds);
+    bool GroupAction(uint32_t groupId, uint32_t action);
+
+    bool BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds);
+    bool BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos);
+
     bool Pause(uint32_t taskId);
     bool Resume(uint32_t taskId);
     bool Remove(uint32_t taskId);
     bool Query(uint32_t taskId, DownloadInfo &info);
     bool QueryMimeType(uint32_t taskId, std::string &mimeType);
 
-    void SetStartId(uint32_t startId);
-    uint32_t GetStartId() const;
-
     void SetInterval(uint32_t interval);
     uint32_t GetInterval() const;
 
@@ -65,8 +71,25 @@ private:
     QueueType DecideQueueType(DownloadStatus status);
     void MoveTaskToQueue(uint32_t taskId, std::shared_ptr<DownloadServiceTask> task);
     void PushQueue(std::queue<uint32_t> &queue, uint32_t taskId);
+    std::vector<std::shared_ptr<DownloadServiceTask>> SelectTasks(const DownloadFilter &filter);
+    static bool MatchFilter(std::shared_ptr<DownloadServiceTask> task, const DownloadFilter &filter);
     void RemoveFromQueue(std::queue<uint32_t> &queue, uint32_t taskId);
 
+    bool JoinInFlight(uint32_t taskId, std::shared_ptr<DownloadServiceTask> task);
+    void ReleaseFollowers(std::shared_ptr<DownloadServiceTask> leader);
+    void LeaveLeader(uint32_t taskId);
+
+    std::shared_ptr<DownloadGroup> FindGroupOf(uint32_t taskId);
+    void LeaveGroup(uint32_t taskId);
+    void ReleaseGroup(std::shared_ptr<DownloadGroup> group);
+    static void GroupEventHandler(const std::string& type, uint32_t taskId, uint32_t argv1, uint32_t argv2);
+
+    void RestoreSnapshot(DownloadTaskCallback eventCb);
+    bool SaveSnapshot();
+    void MarkSnapshotDirty();
+    static uint32_t LoadTaskIdMark();
+    bool SaveTaskIdMark();
+
     bool GetNetworkStatus();
     void ResumeTaskByNetwork();
     static void MonitorNetwork(DownloadServiceManager *thisVal);
@@ -77,6 +100,12 @@ private:
     std::map<uint32_t, std::shared_ptr<DownloadServiceTask>> taskMap_;
     std::queue<uint32_t> pendingQueue_;
     std::queue<uint32_t> pausedQueue_;
+    /* follower task id -> id of the task running the shared transfer */
+    std::map<uint32_t, uint32_t> followerMap_;
+    /* group state has its own lock, member events arrive while the task lock is held */
+    std::mutex groupMutex_;
+    std::map<uint32_t, std::shared_ptr<DownloadGroup>> groups_;
+    std::map<uint32_t, uint32_t> taskGroup_;
     std::vector<std::shared_ptr<DownloadThread>> threadList_;
 
     /* configuration for download service manager */
@@ -87,6 +116,9 @@ private:
     std::shared_ptr<std::thread> networkThread_;
 
     uint32_t taskId_;
+    /* ids below reservedId_ are persisted as handed out, so a restart never reuses them */
+    uint32_t reservedId_;
+    bool snapshotDirty_;
     static std::recursive_mutex instanceLock_;
     static std::shared_ptr<DownloadServiceManager> instance_;
 };
@@ -35,7 +35,13 @@ private:
     bool OnEventOn(MessageParcel &data, MessageParcel &reply);
     bool OnEventOff(MessageParcel &data, MessageParcel &reply);
     bool OnCheckPermission(MessageParcel &data, MessageParcel &reply);
-    bool OnSetStartId(MessageParcel &data, MessageParcel &reply);
+    bool OnRequestGroup(MessageParcel &data, MessageParcel &reply);
+    bool OnGroupAction(MessageParcel &data, MessageParcel &reply);
+    bool OnBatchAction(MessageParcel &data, MessageParcel &reply);
+    bool OnBatchQuery(MessageParcel &data, MessageParcel &reply);
+    static void ReadConfig(MessageParcel &data, DownloadConfig &config);
+    static bool ReadFilter(MessageParcel &data, DownloadFilter &filter);
+    static void WriteInfo(MessageParcel &reply, const DownloadInfo &info);
 };
 } // namespace OHOS::Request::Download
 #endif // DOWNLOAD_SERVICE_STUB_H
@@ -16,24 +16,32 @@
 #ifndef DOWNLOAD_TASK_H
 #define DOWNLOAD_TASK_H
 
+#include <memory>
 #include <mutex>
 #include <string>
 #include <vector>
 
 #include "constant.h"
 #include "curl/curl.h"
+#include "download_cache.h"
 #include "download_config.h"
 #include "download_info.h"
+#include "download_segment_fetcher.h"
 
 namespace OHOS::Request::Download {
     using DownloadTaskCallback = void(*)(const std::string& type, uint32_t taskId, uint32_t argv1, uint32_t argv2);
 
+class DownloadShare;
+class DownloadBlockIndex;
+class DownloadBlockVerifier;
+
 class DownloadServiceTask {
 public:
     DownloadServiceTask(uint32_t taskId, const DownloadConfig &config);
     ~DownloadServiceTask(void);
 
     uint32_t GetId() const;
+    const DownloadConfig &GetConfig() const;
     bool Run();
     bool Pause();
     bool Resume();
@@ -44,8 +52,18 @@ public:
     void InstallCallback(DownloadTaskCallback cb);
     void GetRunResult(DownloadStatus &status, ErrorCode &code, PausedReason &reason);
 
+    void RestoreStatus(DownloadStatus status, PausedReason reason);
+
     void SetRetryTime(uint32_t retryTime);
     void SetNetworkStatus(bool isOnline);
+    void SetShare(std::shared_ptr<DownloadShare> share);
+
+    // a leader runs the transfer for identical requests and fans the body out to its followers
+    bool CanLead(const DownloadConfig &config);
+    bool AttachFollower(std::shared_ptr<DownloadServiceTask> follower);
+    bool DropFollower(uint32_t taskId);
+    std::vector<std::shared_ptr<DownloadServiceTask>> DetachFollowers();
+    void FinishFollowing(bool leaderSucceeded, const std::string &mimeType);
 
 private:
     void SetStatus(DownloadStatus status, ErrorCode code, PausedReason reason);
@@ -58,13 +76,24 @@ private:
     void DumpPausedReason();
 
     bool ExecHttp();
+    bool ExecSegmented();
+    bool ExecBlocks();
+    bool FetchMissing(const DownloadBlockIndex &index, DownloadBlockVerifier &verifier);
+    bool FetchRanges(const std::vector<FetchRange> &ranges, uint64_t total, DownloadBlockVerifier &verifier);
+    bool FetchSingleStream();
+    std::string GetCheckpointPath();
+    int32_t StageBaseFile();
+    bool PrepareRangedFile(uint64_t total);
+    bool VerifyContent(uint64_t size);
+    std::vector<std::string> MakeHeaderLines();
     bool SetFileSizeOption(CURL *curl, struct curl_slist *requestHeader);
     bool SetOption(CURL *curl, struct curl_slist *requestHeader);
     struct curl_slist *MakeHeaders(const std::vector<std::string> &vec);
+    static bool IsRanged(const DownloadConfig &config);
 
     void SetResumeFromLarge(CURL *curl, long long pos);
 
-    bool GetFileSize(uint32_t &result);
+    bool GetFileSize(int64_t &result);
     std::string GetTmpPath();
     void HandleResponseCode(CURLcode code, int32_t httpCode);
     void HandleCleanup(DownloadStatus status);
@@ -77,6 +106,14 @@ private:
     void ForceStopRunning();
     bool HandleFileError();
 
+    bool PrepareCache();
+    bool ServeFromCache();
+    void FinishCache(CURLcode code, int32_t httpCode);
+
+    void FanOut(const void *buffer, size_t len);
+    void NotifyProgress();
+    bool CopyPrefixTo(int32_t fd);
+
 private:
     uint32_t taskId_;
     DownloadConfig config_;
@@ -86,8 +123,8 @@ private:
     PausedReason reason_;
     std::string mimeType_;
     FILE *file_;
-    uint32_t totalSize_;
-    uint32_t downloadSize_;
+    int64_t totalSize_;
+    int64_t downloadSize_;
     bool isPartialMode_;
 
     bool forceStop_;
@@ -98,7 +135,21 @@ private:
     std::recursive_mutex mutex_;
     bool hasFileSize_;
     bool isOnline_;
-    uint32_t prevSize_;
+    int64_t prevSize_;
+
+    CacheEntry cacheEntry_;
+    CacheHeaders responseCache_;
+    DownloadCacheWriter cacheWriter_;
+    bool hasCacheEntry_;
+    bool isRevalidating_;
+    bool isSingleStream_;
+
+    std::mutex followerMutex_;
+    std::vector<std::shared_ptr<DownloadServiceTask>> followers_;
+    bool isFollower_;
+    bool isStreaming_;
+
+    std::shared_ptr<DownloadShare> share_;
 };
 } // namespace OHOS::Request::Download
 #endif // DOWNLOAD_TASK_H
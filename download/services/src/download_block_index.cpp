@@ -0,0 +1,418 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_block_index.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <openssl/sha.h>
+
+#include "download_cache.h"
+#include "log.h"
+
+namespace OHOS::Request::Download {
+static constexpr const char *INDEX_MAGIC = "blockindex";
+static constexpr uint32_t INDEX_VERSION = 1;
+static constexpr uint64_t MIN_BLOCK_SIZE = 512;
+static constexpr uint64_t MAX_BLOCK_SIZE = 64 * 1024 * 1024;
+static constexpr uint32_t WEAK_SUM_MASK = 0xffff;
+static constexpr uint32_t WEAK_SUM_SHIFT = 16;
+static constexpr size_t DIGEST_HEX_LENGTH = SHA256_DIGEST_LENGTH * 2;
+static constexpr uint64_t STOP_CHECK_INTERVAL = 1024 * 1024;
+static constexpr size_t MAX_INDEX_BYTES = 16 * 1024 * 1024;
+static constexpr const char *CHECKPOINT_MAGIC = "checkpoint";
+static constexpr uint32_t CHECKPOINT_VERSION = 1;
+static constexpr uint32_t MAX_BLOCK_RETRIES = 3;
+static constexpr int64_t CHECKPOINT_INTERVAL_MS = 1000;
+static constexpr uint64_t PLAIN_BLOCK_SIZE = 1024 * 1024;
+static constexpr uint64_t MAX_PLAIN_BLOCKS = 16 * 1024;
+
+FetchResult DownloadBlockIndex::Load(const std::string &url, const std::vector<std::string> &headerLines,
+    CURLSH *share)
+{
+    std::unique_ptr<CURL, decltype(&curl_easy_cleanup)> handle(curl_easy_init(), curl_easy_cleanup);
+    if (!handle) {
+        return FetchResult::FAILED;
+    }
+    struct curl_slist *header = nullptr;
+    for (const auto &line : headerLines) {
+        header = curl_slist_append(header, line.c_str());
+    }
+    std::unique_ptr<struct curl_slist, decltype(&curl_slist_free_all)> headerGuard(header, curl_slist_free_all);
+    std::string content;
+    curl_easy_setopt(handle.get(), CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle.get(), CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(handle.get(), CURLOPT_WRITEDATA, &content);
+    DownloadSegmentFetcher::ApplyOptions(handle.get(), header, share);
+    CURLcode code = curl_easy_perform(handle.get());
+    if (code != CURLE_OK) {
+        DOWNLOAD_HILOGE("load block index failed, code %{public}d", code);
+        return DownloadSegmentFetcher::IsNetworkError(code) ? FetchResult::NETWORK_ERROR : FetchResult::FAILED;
+    }
+    return Parse(content) ? FetchResult::SUCCESS : FetchResult::FAILED;
+}
+
+size_t DownloadBlockIndex::WriteCallback(void *buffer, size_t size, size_t num, void *param)
+{
+    std::string *content = static_cast<std::string *>(param);
+    if (content->size() + size * num > MAX_INDEX_BYTES) {
+        return 0;
+    }
+    content->append(static_cast<const char *>(buffer), size * num);
+    return size * num;
+}
+
+bool DownloadBlockIndex::Parse(const std::string &content)
+{
+    std::istringstream in(content);
+    std::string magic;
+    std::string lengthKey;
+    std::string blockSizeKey;
+    uint32_t version = 0;
+    if (!(in >> magic >> version >> lengthKey >> length_ >> blockSizeKey >> blockSize_) || magic != INDEX_MAGIC ||
+        version != INDEX_VERSION || lengthKey != "length" || blockSizeKey != "blocksize") {
+        DOWNLOAD_HILOGE("invalid block index header");
+        return false;
+    }
+    if (blockSize_ < MIN_BLOCK_SIZE || blockSize_ > MAX_BLOCK_SIZE) {
+        DOWNLOAD_HILOGE("invalid block size %{public}llu", static_cast<unsigned long long>(blockSize_));
+        return false;
+    }
+    uint64_t count = (length_ + blockSize_ - 1) / blockSize_;
+    // every block takes a line, an index claiming more blocks than it has lines is rejected before allocating
+    if (count > content.size() / DIGEST_HEX_LENGTH) {
+        return false;
+    }
+    blocks_.resize(count);
+    for (auto &block : blocks_) {
+        if (!(in >> std::hex >> block.weak >> std::dec >> block.digest) || block.digest.size() != DIGEST_HEX_LENGTH) {
+            DOWNLOAD_HILOGE("invalid block index entry");
+            blocks_.clear();
+            return false;
+        }
+    }
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256(reinterpret_cast<const unsigned char *>(content.data()), content.size(), digest);
+    indexDigest_ = DownloadCache::ToHex(digest, sizeof(digest));
+    return true;
+}
+
+/**
+ * @brief Cut a file without a block index into plain blocks
+ *
+ * @param identity what the content is fetched from, a checkpoint of a different identity is not loaded
+ */
+void DownloadBlockIndex::InitPlain(uint64_t length, const std::string &identity)
+{
+    length_ = length;
+    blockSize_ = std::max(PLAIN_BLOCK_SIZE, (length + MAX_PLAIN_BLOCKS - 1) / MAX_PLAIN_BLOCKS);
+    blocks_.assign((length_ + blockSize_ - 1) / blockSize_, BlockSum());
+    std::string content = "plain " + std::to_string(length_) + " " + std::to_string(blockSize_) + "\n" + identity;
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256(reinterpret_cast<const unsigned char *>(content.data()), content.size(), digest);
+    indexDigest_ = DownloadCache::ToHex(digest, sizeof(digest));
+}
+
+uint64_t DownloadBlockIndex::GetLength() const
+{
+    return length_;
+}
+
+const std::string &DownloadBlockIndex::GetIndexDigest() const
+{
+    return indexDigest_;
+}
+
+size_t DownloadBlockIndex::GetBlockCount() const
+{
+    return blocks_.size();
+}
+
+FetchRange DownloadBlockIndex::GetBlock(size_t index) const
+{
+    uint64_t offset = index * blockSize_;
+    return { offset, std::min(blockSize_, length_ - offset) };
+}
+
+const std::string &DownloadBlockIndex::GetDigest(size_t index) const
+{
+    return blocks_[index].digest;
+}
+
+/**
+ * @brief Slide over the base file looking for blocks of the new file and copy every one found into fd
+ *
+ * @param present marks the blocks now in place, blocks already marked are not looked for
+ * @return the number of bytes copied
+ */
+uint64_t DownloadBlockIndex::CopyMatches(int32_t baseFd, int32_t fd, std::vector<bool> &present,
+    const std::function<bool()> &stop) const
+{
+    struct stat baseStat = {};
+    if (baseFd < 0 || fstat(baseFd, &baseStat) != 0 || static_cast<uint64_t>(baseStat.st_size) < blockSize_) {
+        return 0;
+    }
+    std::unordered_map<uint32_t, std::vector<size_t>> candidates;
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        // only whole blocks can be matched at an arbitrary offset
+        if (!present[i] && GetBlock(i).length == blockSize_) {
+            candidates[blocks_[i].weak].push_back(i);
+        }
+    }
+    if (candidates.empty()) {
+        return 0;
+    }
+    uint64_t size = static_cast<uint64_t>(baseStat.st_size);
+    void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, baseFd, 0);
+    if (mapped == MAP_FAILED) {
+        DOWNLOAD_HILOGE("map base file failed, errno %{public}d", errno);
+        return 0;
+    }
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    const unsigned char *base = static_cast<const unsigned char *>(mapped);
+    uint64_t copied = 0;
+    uint64_t pos = 0;
+    uint64_t nextCheck = STOP_CHECK_INTERVAL;
+    uint32_t weak = WeakSum(base, blockSize_);
+    while (pos + blockSize_ <= size) {
+        if (pos >= nextCheck) {
+            if (stop && stop()) {
+                break;
+            }
+            nextCheck = pos + STOP_CHECK_INTERVAL;
+        }
+        bool matched = false;
+        auto it = candidates.find(weak);
+        if (it != candidates.end()) {
+            unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+            SHA256(base + pos, blockSize_, digest);
+            std::string hex = DownloadCache::ToHex(digest, sizeof(digest));
+            for (size_t index : it->second) {
+                if (present[index] || blocks_[index].digest != hex) {
+                    continue;
+                }
+                if (pwrite(fd, base + pos, blockSize_, index * blockSize_) == static_cast<ssize_t>(blockSize_)) {
+                    present[index] = true;
+                    copied += blockSize_;
+                    matched = true;
+                }
+            }
+        }
+        if (matched && pos + blockSize_ * 2 <= size) {
+            pos += blockSize_;
+            weak = WeakSum(base + pos, blockSize_);
+            continue;
+        }
+        if (matched || pos + blockSize_ >= size) {
+            break;
+        }
+        weak = RollWeakSum(weak, base[pos], base[pos + blockSize_], blockSize_);
+        pos++;
+    }
+    munmap(mapped, size);
+    return copied;
+}
+
+std::vector<FetchRange> DownloadBlockIndex::GetMissingRanges(const std::vector<bool> &present) const
+{
+    std::vector<FetchRange> ranges;
+    for (size_t i = 0; i < blocks_.size(); i++) {
+        if (present[i]) {
+            continue;
+        }
+        FetchRange block = GetBlock(i);
+        if (!ranges.empty() && ranges.back().offset + ranges.back().length == block.offset) {
+            ranges.back().length += block.length;
+        } else {
+            ranges.push_back(block);
+        }
+    }
+    return ranges;
+}
+
+uint32_t DownloadBlockIndex::WeakSum(const unsigned char *data, size_t len)
+{
+    uint32_t a = 0;
+    uint32_t b = 0;
+    for (size_t i = 0; i < len; i++) {
+        a += data[i];
+        b += static_cast<uint32_t>(len - i) * data[i];
+    }
+    return (a & WEAK_SUM_MASK) | ((b & WEAK_SUM_MASK) << WEAK_SUM_SHIFT);
+}
+
+uint32_t DownloadBlockIndex::RollWeakSum(uint32_t sum, unsigned char out, unsigned char in, size_t len)
+{
+    uint32_t a = sum & WEAK_SUM_MASK;
+    uint32_t b = sum >> WEAK_SUM_SHIFT;
+    a = (a - out + in) & WEAK_SUM_MASK;
+    b = (b - static_cast<uint32_t>(len) * out + a) & WEAK_SUM_MASK;
+    return a | (b << WEAK_SUM_SHIFT);
+}
+
+DownloadBlockVerifier::DownloadBlockVerifier(const DownloadBlockIndex &index, int32_t fd,
+    const std::string &checkpointPath)
+    : index_(index), fd_(fd), checkpointPath_(checkpointPath), verified_(index.GetBlockCount(), false),
+      received_(index.GetBlockCount(), 0), retries_(index.GetBlockCount(), 0), corrupted_(false), dirty_(false),
+      lastSave_(std::chrono::steady_clock::now())
+{
+}
+
+std::vector<bool> &DownloadBlockVerifier::GetVerified()
+{
+    return verified_;
+}
+
+uint64_t DownloadBlockVerifier::GetVerifiedBytes() const
+{
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < verified_.size(); i++) {
+        if (verified_[i]) {
+            bytes += index_.GetBlock(i).length;
+        }
+    }
+    return bytes;
+}
+
+bool DownloadBlockVerifier::IsCorrupted() const
+{
+    return corrupted_;
+}
+
+/**
+ * @brief Account the bytes written for a range and verify the blocks it completes
+ *
+ * @param refetch receives the blocks whose content did not match the index
+ */
+void DownloadBlockVerifier::OnWritten(const FetchRange &written, std::vector<FetchRange> &refetch)
+{
+    if (index_.GetBlockCount() == 0 || written.length == 0) {
+        return;
+    }
+    uint64_t blockSize = index_.GetBlock(0).length;
+    uint64_t end = written.offset + written.length;
+    for (size_t i = written.offset / blockSize; i < index_.GetBlockCount(); i++) {
+        FetchRange block = index_.GetBlock(i);
+        if (block.offset >= end) {
+            break;
+        }
+        uint64_t overlapStart = std::max(block.offset, written.offset);
+        uint64_t overlapEnd = std::min(block.offset + block.length, end);
+        received_[i] += overlapEnd - overlapStart;
+        if (verified_[i] || received_[i] < block.length) {
+            continue;
+        }
+        if (index_.GetDigest(i).empty()) {
+            verified_[i] = true;
+            dirty_ = true;
+            continue;
+        }
+        std::string digest;
+        if (DownloadSegmentFetcher::HashRange(fd_, block.offset, block.length, digest) &&
+            digest == index_.GetDigest(i)) {
+            verified_[i] = true;
+            dirty_ = true;
+            continue;
+        }
+        received_[i] = 0;
+        if (++retries_[i] > MAX_BLOCK_RETRIES) {
+            DOWNLOAD_HILOGE("block %{public}zu keeps failing verification", i);
+            corrupted_ = true;
+            continue;
+        }
+        DOWNLOAD_HILOGW("block %{public}zu corrupted, fetch it again", i);
+        refetch.push_back(block);
+    }
+    SaveCheckpoint(false);
+}
+
+/**
+ * @brief Restore the verified blocks of an earlier run of the same index into the same file
+ */
+bool DownloadBlockVerifier::LoadCheckpoint()
+{
+    std::ifstream in(checkpointPath_);
+    std::string magic;
+    uint32_t version = 0;
+    std::string indexDigest;
+    size_t count = 0;
+    std::string bitmap;
+    if (!in.is_open() || !(in >> magic >> version >> indexDigest >> count >> bitmap) || magic != CHECKPOINT_MAGIC ||
+        version != CHECKPOINT_VERSION || indexDigest != index_.GetIndexDigest() || count != verified_.size() ||
+        bitmap.size() != count) {
+        return false;
+    }
+    struct stat fileStat = {};
+    if (fstat(fd_, &fileStat) != 0 || static_cast<uint64_t>(fileStat.st_size) != index_.GetLength()) {
+        return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+        verified_[i] = bitmap[i] == '1';
+    }
+    return true;
+}
+
+void DownloadBlockVerifier::SaveCheckpoint(bool force)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (checkpointPath_.empty() || (!force && (!dirty_ ||
+        std::chrono::duration_cast<std::chrono::milliseconds>(now - lastSave_).count() < CHECKPOINT_INTERVAL_MS))) {
+        return;
+    }
+    lastSave_ = now;
+    // the blocks have to be on disk before the checkpoint claims them
+    if (fdatasync(fd_) != 0) {
+        return;
+    }
+    std::string bitmap(verified_.size(), '0');
+    for (size_t i = 0; i < verified_.size(); i++) {
+        if (verified_[i]) {
+            bitmap[i] = '1';
+        }
+    }
+    std::ostringstream out;
+    out << CHECKPOINT_MAGIC << ' ' << CHECKPOINT_VERSION << '\n' << index_.GetIndexDigest() << '\n' <<
+        verified_.size() << '\n' << bitmap << '\n';
+    std::string content = out.str();
+    std::string tmpPath = checkpointPath_ + ".tmp";
+    int32_t fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        DOWNLOAD_HILOGE("open checkpoint failed, errno %{public}d", errno);
+        return;
+    }
+    bool result = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    close(fd);
+    if (!result || rename(tmpPath.c_str(), checkpointPath_.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return;
+    }
+    dirty_ = false;
+}
+
+void DownloadBlockVerifier::RemoveCheckpoint()
+{
+    if (!checkpointPath_.empty()) {
+        unlink(checkpointPath_.c_str());
+    }
+}
+} // namespace OHOS::Request::Download
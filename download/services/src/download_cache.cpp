@@ -0,0 +1,569 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_cache.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <dirent.h>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/fs.h>
+
+#include "log.h"
+
+namespace OHOS::Request::Download {
+namespace {
+constexpr const char *CACHE_DIR = "/data/service/el1/public/download/cache";
+constexpr const char *CACHE_INDEX_DIR = "/data/service/el1/public/download/cache/index/";
+constexpr const char *CACHE_VARY_DIR = "/data/service/el1/public/download/cache/vary/";
+constexpr const char *CACHE_BLOB_DIR = "/data/service/el1/public/download/cache/blobs/";
+constexpr const char *CACHE_TMP_DIR = "/data/service/el1/public/download/cache/tmp/";
+constexpr uint64_t CACHE_MAX_BYTES = 128 * 1024 * 1024;
+constexpr uint64_t CACHE_MAX_ENTRY_BYTES = 16 * 1024 * 1024;
+constexpr size_t CACHE_COPY_BUFFER = 64 * 1024;
+constexpr mode_t CACHE_DIR_MODE = S_IRWXU;
+constexpr mode_t CACHE_FILE_MODE = S_IRUSR | S_IWUSR;
+
+std::string Trim(const std::string &str)
+{
+    size_t begin = str.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = str.find_last_not_of(" \t\r\n");
+    return str.substr(begin, end - begin + 1);
+}
+
+std::string ToLower(std::string str)
+{
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
+
+std::string Sha256Hex(const std::string &data)
+{
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256(reinterpret_cast<const unsigned char *>(data.data()), data.size(), digest);
+    return DownloadCache::ToHex(digest, sizeof(digest));
+}
+
+bool WriteFileAtomic(const std::string &path, const std::string &content)
+{
+    std::string tmpPath = path + ".tmp";
+    int32_t fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, CACHE_FILE_MODE);
+    if (fd < 0) {
+        return false;
+    }
+    bool result = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    close(fd);
+    if (!result || rename(tmpPath.c_str(), path.c_str()) != 0) {
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool CopyByRead(int32_t srcFd, int32_t dstFd)
+{
+    std::vector<char> buffer(CACHE_COPY_BUFFER);
+    while (true) {
+        ssize_t len = read(srcFd, buffer.data(), buffer.size());
+        if (len == 0) {
+            return true;
+        }
+        if (len < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ssize_t offset = 0;
+        while (offset < len) {
+            ssize_t written = write(dstFd, buffer.data() + offset, len - offset);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            offset += written;
+        }
+    }
+}
+} // namespace
+
+DownloadCache &DownloadCache::GetInstance()
+{
+    static DownloadCache instance;
+    return instance;
+}
+
+DownloadCache::DownloadCache() : dirsReady_(false), tmpSeq_(0)
+{
+}
+
+std::string DownloadCache::ToHex(const unsigned char *data, size_t len)
+{
+    static const char *digits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        hex.push_back(digits[data[i] >> 4]);
+        hex.push_back(digits[data[i] & 0x0f]);
+    }
+    return hex;
+}
+
+bool DownloadCache::PrepareDirs()
+{
+    if (dirsReady_) {
+        return true;
+    }
+    for (const char *dir : { CACHE_DIR, CACHE_INDEX_DIR, CACHE_VARY_DIR, CACHE_BLOB_DIR, CACHE_TMP_DIR }) {
+        if (mkdir(dir, CACHE_DIR_MODE) != 0 && errno != EEXIST) {
+            DOWNLOAD_HILOGE("create cache dir failed, errno %{public}d", errno);
+            return false;
+        }
+    }
+    // bodies left behind by a previous run of the service are never committed
+    DIR *dir = opendir(CACHE_TMP_DIR);
+    if (dir != nullptr) {
+        struct dirent *item = nullptr;
+        while ((item = readdir(dir)) != nullptr) {
+            if (item->d_name[0] != '.') {
+                unlinkat(dirfd(dir), item->d_name, 0);
+            }
+        }
+        closedir(dir);
+    }
+    dirsReady_ = true;
+    return true;
+}
+
+void DownloadCache::ParseHeader(const std::string &line, CacheHeaders &headers)
+{
+    // a new status line starts the headers of a redirected or final response
+    if (line.compare(0, strlen("HTTP/"), "HTTP/") == 0) {
+        headers = CacheHeaders();
+        return;
+    }
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+        return;
+    }
+    std::string name = ToLower(Trim(line.substr(0, colon)));
+    std::string value = Trim(line.substr(colon + 1));
+    if (name == "etag") {
+        headers.etag = value;
+    } else if (name == "last-modified") {
+        headers.lastModified = value;
+    } else if (name == "vary") {
+        size_t start = 0;
+        while (start <= value.size()) {
+            size_t comma = value.find(',', start);
+            std::string field = ToLower(Trim(value.substr(start, comma - start)));
+            if (!field.empty()) {
+                headers.vary.push_back(field);
+            }
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+    } else if (name == "cache-control") {
+        std::string directives = ToLower(value);
+        headers.hasCacheControl = true;
+        headers.noStore = directives.find("no-store") != std::string::npos;
+        headers.noCache = directives.find("no-cache") != std::string::npos;
+        headers.isPrivate = directives.find("private") != std::string::npos;
+        size_t pos = directives.find("max-age=");
+        if (pos != std::string::npos) {
+            headers.maxAge = std::strtoll(directives.c_str() + pos + strlen("max-age="), nullptr, 10);
+        }
+    }
+}
+
+bool DownloadCache::IsStorable(const std::map<std::string, std::string> &requestHeader, const CacheHeaders &headers)
+{
+    // the cache is shared by all callers, never keep responses tied to credentials
+    for (const auto &header : requestHeader) {
+        std::string name = ToLower(header.first);
+        if (name == "authorization" || name == "cookie") {
+            return false;
+        }
+    }
+    if (headers.noStore || headers.isPrivate) {
+        return false;
+    }
+    if (std::find(headers.vary.begin(), headers.vary.end(), "*") != headers.vary.end()) {
+        return false;
+    }
+    return !headers.etag.empty() || !headers.lastModified.empty() || headers.maxAge > 0;
+}
+
+std::vector<std::string> DownloadCache::MakeValidators(const CacheEntry &entry)
+{
+    std::vector<std::string> validators;
+    if (!entry.etag.empty()) {
+        validators.emplace_back("If-None-Match: " + entry.etag);
+    }
+    if (!entry.lastModified.empty()) {
+        validators.emplace_back("If-Modified-Since: " + entry.lastModified);
+    }
+    return validators;
+}
+
+std::string DownloadCache::MakeKey(const std::string &url, const std::vector<std::string> &vary,
+    const std::map<std::string, std::string> &requestHeader) const
+{
+    std::string key = url;
+    for (const auto &name : vary) {
+        key += '\n' + name + ':';
+        for (const auto &header : requestHeader) {
+            if (ToLower(header.first) == name) {
+                key += header.second;
+                break;
+            }
+        }
+    }
+    return Sha256Hex(key);
+}
+
+bool DownloadCache::ReadVary(const std::string &url, std::vector<std::string> &vary)
+{
+    std::ifstream in(CACHE_VARY_DIR + Sha256Hex(url));
+    std::string name;
+    while (std::getline(in, name)) {
+        if (!name.empty()) {
+            vary.push_back(name);
+        }
+    }
+    return true;
+}
+
+bool DownloadCache::WriteVary(const std::string &url, const std::vector<std::string> &vary)
+{
+    std::string path = CACHE_VARY_DIR + Sha256Hex(url);
+    if (vary.empty()) {
+        unlink(path.c_str());
+        return true;
+    }
+    std::vector<std::string> names = vary;
+    std::sort(names.begin(), names.end());
+    std::string content;
+    for (const auto &name : names) {
+        content += name + '\n';
+    }
+    return WriteFileAtomic(path, content);
+}
+
+bool DownloadCache::ReadEntry(const std::string &key, CacheEntry &entry)
+{
+    std::ifstream in(CACHE_INDEX_DIR + key);
+    if (!in.is_open()) {
+        return false;
+    }
+    entry.key = key;
+    if (!std::getline(in, entry.url) || !std::getline(in, entry.etag) || !std::getline(in, entry.lastModified) ||
+        !std::getline(in, entry.mimeType) || !std::getline(in, entry.digest)) {
+        return false;
+    }
+    return static_cast<bool>(in >> entry.size >> entry.storedTime >> entry.maxAge >> entry.noCache);
+}
+
+bool DownloadCache::WriteEntry(const CacheEntry &entry)
+{
+    std::string content = entry.url + '\n' + entry.etag + '\n' + entry.lastModified + '\n' + entry.mimeType + '\n' +
+        entry.digest + '\n' + std::to_string(entry.size) + ' ' + std::to_string(entry.storedTime) + ' ' +
+        std::to_string(entry.maxAge) + ' ' + std::to_string(entry.noCache ? 1 : 0) + '\n';
+    return WriteFileAtomic(CACHE_INDEX_DIR + entry.key, content);
+}
+
+void DownloadCache::RemoveEntry(const std::string &key)
+{
+    std::string path = CACHE_INDEX_DIR + key;
+    unlink(path.c_str());
+}
+
+/**
+ * @brief Find the cache entry matching the url and the request headers named by Vary
+ *
+ * @return true if an entry with an intact blob exists
+ */
+bool DownloadCache::Lookup(
+    const std::string &url, const std::map<std::string, std::string> &requestHeader, CacheEntry &entry)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (!PrepareDirs()) {
+        return false;
+    }
+    std::vector<std::string> vary;
+    ReadVary(url, vary);
+    std::string key = MakeKey(url, vary, requestHeader);
+    if (!ReadEntry(key, entry) || entry.url != url) {
+        return false;
+    }
+    struct stat blobStat {};
+    std::string blobPath = CACHE_BLOB_DIR + entry.digest;
+    if (stat(blobPath.c_str(), &blobStat) != 0 || static_cast<uint64_t>(blobStat.st_size) != entry.size) {
+        DOWNLOAD_HILOGD("cache blob of %{public}s is gone", url.c_str());
+        RemoveEntry(key);
+        return false;
+    }
+    return true;
+}
+
+bool DownloadCache::IsFresh(const CacheEntry &entry) const
+{
+    if (entry.noCache || entry.maxAge <= 0) {
+        return false;
+    }
+    return static_cast<int64_t>(time(nullptr)) - entry.storedTime < entry.maxAge;
+}
+
+/**
+ * @brief Fill the empty target fd with the cached body, sharing extents where the file system allows
+ */
+bool DownloadCache::CopyTo(const CacheEntry &entry, int32_t fd)
+{
+    std::string blobPath = CACHE_BLOB_DIR + entry.digest;
+    int32_t blobFd = open(blobPath.c_str(), O_RDONLY);
+    if (blobFd < 0) {
+        DOWNLOAD_HILOGE("open cache blob failed, errno %{public}d", errno);
+        return false;
+    }
+    // keep recently used blobs out of eviction
+    futimens(blobFd, nullptr);
+    bool result = false;
+#ifdef FICLONE
+    result = ioctl(fd, FICLONE, blobFd) == 0;
+#endif
+    if (!result) {
+        off_t offset = 0;
+        while (offset < static_cast<off_t>(entry.size)) {
+            ssize_t sent = sendfile(fd, blobFd, &offset, entry.size - offset);
+            if (sent <= 0) {
+                break;
+            }
+        }
+        result = offset == static_cast<off_t>(entry.size);
+        if (!result && offset == 0) {
+            result = CopyByRead(blobFd, fd);
+        }
+    }
+    close(blobFd);
+    if (!result) {
+        DOWNLOAD_HILOGE("copy cache blob failed, errno %{public}d", errno);
+        return false;
+    }
+    lseek(fd, 0, SEEK_END);
+    return true;
+}
+
+/**
+ * @brief Update an entry revalidated by a 304 response
+ */
+bool DownloadCache::Refresh(CacheEntry &entry, const CacheHeaders &headers)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (!headers.etag.empty()) {
+        entry.etag = headers.etag;
+    }
+    if (!headers.lastModified.empty()) {
+        entry.lastModified = headers.lastModified;
+    }
+    if (headers.hasCacheControl) {
+        entry.maxAge = headers.maxAge;
+        entry.noCache = headers.noCache;
+    }
+    entry.storedTime = static_cast<int64_t>(time(nullptr));
+    return WriteEntry(entry);
+}
+
+/**
+ * @brief Take over a fully written body and index it under the url
+ *
+ * @param entry digest, size and mime type of the body; key and validators are filled in
+ * @param tmpPath body file created under MakeTempPath, moved or removed by this call
+ */
+bool DownloadCache::Store(const std::string &url, const std::map<std::string, std::string> &requestHeader,
+    const CacheHeaders &headers, CacheEntry &entry, const std::string &tmpPath)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    std::string blobPath = CACHE_BLOB_DIR + entry.digest;
+    if (access(blobPath.c_str(), F_OK) == 0) {
+        // same content already cached under another url
+        unlink(tmpPath.c_str());
+        utimensat(AT_FDCWD, blobPath.c_str(), nullptr, 0);
+    } else if (rename(tmpPath.c_str(), blobPath.c_str()) != 0) {
+        DOWNLOAD_HILOGE("store cache blob failed, errno %{public}d", errno);
+        unlink(tmpPath.c_str());
+        return false;
+    }
+    std::vector<std::string> vary = headers.vary;
+    std::sort(vary.begin(), vary.end());
+    entry.url = url;
+    entry.key = MakeKey(url, vary, requestHeader);
+    entry.etag = headers.etag;
+    entry.lastModified = headers.lastModified;
+    entry.maxAge = headers.maxAge;
+    entry.noCache = headers.noCache;
+    entry.storedTime = static_cast<int64_t>(time(nullptr));
+    if (!WriteVary(url, vary) || !WriteEntry(entry)) {
+        DOWNLOAD_HILOGE("store cache entry failed");
+        return false;
+    }
+    Evict();
+    return true;
+}
+
+std::string DownloadCache::MakeTempPath()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    if (!PrepareDirs()) {
+        return "";
+    }
+    return CACHE_TMP_DIR + std::to_string(getpid()) + "_" + std::to_string(tmpSeq_++);
+}
+
+/**
+ * @brief Drop the least recently used blobs until the cache fits CACHE_MAX_BYTES. Index entries of
+ * dropped blobs are removed lazily by Lookup.
+ */
+void DownloadCache::Evict()
+{
+    DIR *dir = opendir(CACHE_BLOB_DIR);
+    if (dir == nullptr) {
+        return;
+    }
+    std::vector<std::pair<time_t, std::pair<std::string, uint64_t>>> blobs;
+    uint64_t total = 0;
+    struct dirent *item = nullptr;
+    while ((item = readdir(dir)) != nullptr) {
+        if (item->d_name[0] == '.') {
+            continue;
+        }
+        std::string path = std::string(CACHE_BLOB_DIR) + item->d_name;
+        struct stat blobStat {};
+        if (stat(path.c_str(), &blobStat) != 0) {
+            continue;
+        }
+        total += static_cast<uint64_t>(blobStat.st_size);
+        blobs.push_back({ blobStat.st_mtime, { path, static_cast<uint64_t>(blobStat.st_size) } });
+    }
+    closedir(dir);
+    if (total <= CACHE_MAX_BYTES) {
+        return;
+    }
+    std::sort(blobs.begin(), blobs.end());
+    for (const auto &blob : blobs) {
+        if (total <= CACHE_MAX_BYTES) {
+            break;
+        }
+        unlink(blob.second.first.c_str());
+        total -= blob.second.second;
+    }
+}
+
+DownloadCacheWriter::DownloadCacheWriter() : fd_(-1), size_(0)
+{
+}
+
+DownloadCacheWriter::~DownloadCacheWriter()
+{
+    Abort();
+}
+
+bool DownloadCacheWriter::Open()
+{
+    Abort();
+    tmpPath_ = DownloadCache::GetInstance().MakeTempPath();
+    if (tmpPath_.empty()) {
+        return false;
+    }
+    fd_ = open(tmpPath_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, CACHE_FILE_MODE);
+    if (fd_ < 0) {
+        DOWNLOAD_HILOGE("open cache file failed, errno %{public}d", errno);
+        return false;
+    }
+    size_ = 0;
+    SHA256_Init(&ctx_);
+    return true;
+}
+
+bool DownloadCacheWriter::IsOpen() const
+{
+    return fd_ >= 0;
+}
+
+void DownloadCacheWriter::Write(const void *buffer, size_t len)
+{
+    if (fd_ < 0) {
+        return;
+    }
+    if (size_ + len > CACHE_MAX_ENTRY_BYTES ||
+        write(fd_, buffer, len) != static_cast<ssize_t>(len)) {
+        DOWNLOAD_HILOGD("stop caching body of %{public}llu bytes", (unsigned long long)(size_ + len));
+        Abort();
+        return;
+    }
+    SHA256_Update(&ctx_, buffer, len);
+    size_ += len;
+}
+
+bool DownloadCacheWriter::Commit(const std::string &url, const std::map<std::string, std::string> &requestHeader,
+    const CacheHeaders &headers, const std::string &mimeType)
+{
+    if (fd_ < 0) {
+        return false;
+    }
+    if (!DownloadCache::IsStorable(requestHeader, headers)) {
+        Abort();
+        return false;
+    }
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256_Final(digest, &ctx_);
+    close(fd_);
+    fd_ = -1;
+    CacheEntry entry;
+    entry.digest = DownloadCache::ToHex(digest, sizeof(digest));
+    entry.size = size_;
+    entry.mimeType = mimeType;
+    bool result = DownloadCache::GetInstance().Store(url, requestHeader, headers, entry, tmpPath_);
+    tmpPath_.clear();
+    return result;
+}
+
+void DownloadCacheWriter::Abort()
+{
+    if (fd_ >= 0) {
+        close(fd_);
+        fd_ = -1;
+    }
+    if (!tmpPath_.empty()) {
+        unlink(tmpPath_.c_str());
+        tmpPath_.clear();
+    }
+}
+} // namespace OHOS::Request::Download
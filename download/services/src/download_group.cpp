@@ -0,0 +1,247 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_group.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "log.h"
+
+namespace OHOS::Request::Download {
+static constexpr std::chrono::milliseconds GROUP_PROGRESS_INTERVAL(100);
+
+DownloadShare::DownloadShare() : share_(curl_share_init())
+{
+    if (share_ == nullptr) {
+        DOWNLOAD_HILOGE("Failed to create curl share handle");
+        return;
+    }
+    curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, Lock);
+    curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, Unlock);
+    curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+    // members run on different download threads, and curl does not support a connection cache shared
+    // between concurrent threads, so only name resolution and TLS sessions are shared
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+}
+
+DownloadShare::~DownloadShare()
+{
+    if (share_ != nullptr) {
+        curl_share_cleanup(share_);
+        share_ = nullptr;
+    }
+}
+
+CURLSH *DownloadShare::GetHandle() const
+{
+    return share_;
+}
+
+void DownloadShare::Lock(CURL *handle, curl_lock_data data, curl_lock_access access, void *param)
+{
+    auto share = static_cast<DownloadShare *>(param);
+    if (share != nullptr && data >= 0 && data < CURL_LOCK_DATA_LAST) {
+        share->locks_[data].lock();
+    }
+}
+
+void DownloadShare::Unlock(CURL *handle, curl_lock_data data, void *param)
+{
+    auto share = static_cast<DownloadShare *>(param);
+    if (share != nullptr && data >= 0 && data < CURL_LOCK_DATA_LAST) {
+        share->locks_[data].unlock();
+    }
+}
+
+DownloadGroup::DownloadGroup(uint32_t groupId, DownloadTaskCallback eventCb)
+    : groupId_(groupId), eventCb_(eventCb), share_(std::make_shared<DownloadShare>()),
+      lastProgress_(std::chrono::steady_clock::time_point::min()), pauseReported_(false), finished_(false),
+      removed_(false)
+{
+}
+
+uint32_t DownloadGroup::GetId() const
+{
+    return groupId_;
+}
+
+std::shared_ptr<DownloadShare> DownloadGroup::GetShare() const
+{
+    return share_;
+}
+
+std::vector<uint32_t> DownloadGroup::GetMembers()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    std::vector<uint32_t> members;
+    members.reserve(members_.size());
+    for (const auto &it : members_) {
+        members.push_back(it.first);
+    }
+    return members;
+}
+
+bool DownloadGroup::IsFinished()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    return finished_;
+}
+
+void DownloadGroup::AddMember(uint32_t taskId)
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    members_[taskId] = MemberState();
+}
+
+void DownloadGroup::RemoveMember(uint32_t taskId)
+{
+    std::vector<GroupEvent> events;
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        if (members_.erase(taskId) == 0 || removed_) {
+            return;
+        }
+        CollectSettled(events);
+    }
+    Emit(events);
+}
+
+void DownloadGroup::OnMemberEvent(const std::string &type, uint32_t taskId, uint32_t argv1, uint32_t argv2)
+{
+    std::vector<GroupEvent> events;
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        auto it = members_.find(taskId);
+        if (removed_ || it == members_.end()) {
+            return;
+        }
+        MemberState &member = it->second;
+        if (type == "progress") {
+            member.received = argv1;
+            member.total = argv2;
+            member.status = SESSION_RUNNING;
+            pauseReported_ = false;
+            CollectProgress(events, false);
+        } else if (type == "complete") {
+            member.status = SESSION_SUCCESS;
+            member.received = std::max(member.received, member.total);
+            CollectSettled(events);
+        } else if (type == "pause") {
+            member.status = SESSION_PAUSED;
+            CollectSettled(events);
+        } else if (type == "fail") {
+            member.status = SESSION_FAILED;
+            CollectSettled(events);
+        }
+        // member "remove" events are dropped, the group reports its own removal
+    }
+    Emit(events);
+}
+
+void DownloadGroup::OnResume()
+{
+    std::lock_guard<std::mutex> autoLock(mutex_);
+    pauseReported_ = false;
+    for (auto &it : members_) {
+        if (it.second.status == SESSION_PAUSED) {
+            it.second.status = SESSION_UNKNOWN;
+        }
+    }
+}
+
+void DownloadGroup::NotifyRemove()
+{
+    {
+        std::lock_guard<std::mutex> autoLock(mutex_);
+        removed_ = true;
+    }
+    if (eventCb_ != nullptr) {
+        eventCb_("remove", groupId_, 0, 0);
+    }
+}
+
+void DownloadGroup::CollectProgress(std::vector<GroupEvent> &events, bool force)
+{
+    auto now = std::chrono::steady_clock::now();
+    if (!force && now - lastProgress_ < GROUP_PROGRESS_INTERVAL) {
+        return;
+    }
+    lastProgress_ = now;
+    uint64_t received = 0;
+    uint64_t total = 0;
+    for (const auto &it : members_) {
+        received += it.second.received;
+        total += it.second.total;
+    }
+    // the event channel carries 32 bit sizes
+    constexpr uint64_t sizeLimit = std::numeric_limits<uint32_t>::max();
+    events.push_back({ "progress", static_cast<uint32_t>(std::min(received, sizeLimit)),
+        static_cast<uint32_t>(std::min(total, sizeLimit)) });
+}
+
+void DownloadGroup::CollectSettled(std::vector<GroupEvent> &events)
+{
+    if (finished_ || members_.empty()) {
+        return;
+    }
+    uint32_t failed = 0;
+    uint32_t settled = 0;
+    bool allPaused = true;
+    for (const auto &it : members_) {
+        switch (it.second.status) {
+            case SESSION_FAILED:
+                failed++;
+                settled++;
+                break;
+            case SESSION_SUCCESS:
+                settled++;
+                break;
+            case SESSION_PAUSED:
+                break;
+            default:
+                allPaused = false;
+                break;
+        }
+    }
+    if (settled == members_.size()) {
+        finished_ = true;
+        CollectProgress(events, true);
+        if (failed == 0) {
+            events.push_back({ "complete", 0, 0 });
+        } else {
+            events.push_back({ "fail", failed, 0 });
+        }
+        DOWNLOAD_HILOGI("Group[%{public}d] finished, %{public}d of %{public}zu failed", groupId_, failed,
+            members_.size());
+        return;
+    }
+    if (allPaused && !pauseReported_) {
+        pauseReported_ = true;
+        events.push_back({ "pause", 0, 0 });
+    }
+}
+
+void DownloadGroup::Emit(const std::vector<GroupEvent> &events)
+{
+    if (eventCb_ == nullptr) {
+        return;
+    }
+    for (const auto &event : events) {
+        eventCb_(event.type, groupId_, event.argv1, event.argv2);
+    }
+}
+} // namespace OHOS::Request::Download
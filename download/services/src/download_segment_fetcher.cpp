@@ -0,0 +1,435 @@
+/*
+ * Copyright (C) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "download_segment_fetcher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <unistd.h>
+#include <openssl/sha.h>
+
+#include "constant.h"
+#include "download_cache.h"
+#include "log.h"
+
+namespace OHOS::Request::Download {
+static constexpr uint64_t SEGMENT_SIZE = 1024 * 1024;
+static constexpr uint64_t STEAL_MIN_BYTES = 256 * 1024;
+static constexpr uint32_t MAX_CONNECTIONS_PER_SOURCE = 2;
+static constexpr uint32_t MAX_CONNECTIONS = 6;
+static constexpr uint32_t MAX_SOURCE_FAILURES = 3;
+static constexpr int WAIT_INTERVAL_MS = 100;
+static constexpr int64_t PROGRESS_INTERVAL_MS = 100;
+static constexpr double RATE_WEIGHT = 0.3;
+static constexpr double STEAL_RATE_RATIO = 1.5;
+static constexpr size_t HASH_BUFFER_SIZE = 64 * 1024;
+
+DownloadSegmentFetcher::DownloadSegmentFetcher(int32_t fd, const std::vector<std::string> &sources,
+    const std::vector<std::string> &headerLines)
+    : fd_(fd), headerLines_(headerLines), header_(nullptr), share_(nullptr), multi_(nullptr), fileError_(false),
+      networkError_(false), rangeIgnored_(false), unreported_(0)
+{
+    for (const auto &url : sources) {
+        Source source;
+        source.url = url;
+        sources_.push_back(source);
+    }
+}
+
+DownloadSegmentFetcher::~DownloadSegmentFetcher()
+{
+    Cleanup();
+}
+
+void DownloadSegmentFetcher::SetShare(CURLSH *share)
+{
+    share_ = share;
+}
+
+void DownloadSegmentFetcher::SetProgressHook(ProgressHook hook)
+{
+    progressHook_ = hook;
+}
+
+void DownloadSegmentFetcher::SetStopHook(StopHook hook)
+{
+    stopHook_ = hook;
+}
+
+void DownloadSegmentFetcher::SetWrittenHook(WrittenHook hook)
+{
+    writtenHook_ = hook;
+}
+
+FetchResult DownloadSegmentFetcher::Fetch(const std::vector<FetchRange> &ranges)
+{
+    Cleanup();
+    rangeIgnored_ = false;
+    for (const auto &range : ranges) {
+        Requeue(range);
+    }
+    if (pending_.empty()) {
+        return FetchResult::SUCCESS;
+    }
+    multi_ = curl_multi_init();
+    if (multi_ == nullptr || sources_.empty()) {
+        return FetchResult::FAILED;
+    }
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(MAX_CONNECTIONS_PER_SOURCE));
+    for (const auto &line : headerLines_) {
+        header_ = curl_slist_append(header_, line.c_str());
+    }
+    lastReport_ = std::chrono::steady_clock::now();
+    FetchResult result = FetchResult::SUCCESS;
+    while (true) {
+        if (stopHook_ && stopHook_()) {
+            result = FetchResult::STOPPED;
+            break;
+        }
+        while (!pending_.empty() && transfers_.size() < MAX_CONNECTIONS) {
+            int32_t source = PickSource();
+            if (source < 0 || !StartTransfer(static_cast<size_t>(source), pending_.front())) {
+                break;
+            }
+            pending_.pop_front();
+        }
+        if (pending_.empty() && transfers_.size() < MAX_CONNECTIONS) {
+            StealTail();
+        }
+        if (transfers_.empty()) {
+            if (!pending_.empty()) {
+                DOWNLOAD_HILOGE("no usable source left for %{public}zu segments", pending_.size());
+                result = rangeIgnored_ ? FetchResult::RANGE_UNSUPPORTED :
+                    (networkError_ ? FetchResult::NETWORK_ERROR : FetchResult::FAILED);
+            }
+            break;
+        }
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        int queued = 0;
+        CURLMsg *msg = nullptr;
+        while ((msg = curl_multi_info_read(multi_, &queued)) != nullptr) {
+            if (msg->msg == CURLMSG_DONE) {
+                FinishTransfer(msg->easy_handle, msg->data.result);
+            }
+        }
+        if (fileError_) {
+            result = FetchResult::FAILED;
+            break;
+        }
+        FlushProgress(false);
+        curl_multi_wait(multi_, nullptr, 0, WAIT_INTERVAL_MS, nullptr);
+    }
+    FlushProgress(true);
+    Cleanup();
+    return result;
+}
+
+/**
+ * @brief Queue a range for download, may be called from the written hook while fetching
+ */
+void DownloadSegmentFetcher::Requeue(const FetchRange &range)
+{
+    for (uint64_t done = 0; done < range.length; done += SEGMENT_SIZE) {
+        pending_.push_back({ range.offset + done, std::min(SEGMENT_SIZE, range.length - done) });
+    }
+}
+
+/**
+ * @brief Prefer a source nobody has measured yet, then the one with the best throughput
+ */
+int32_t DownloadSegmentFetcher::PickSource() const
+{
+    int32_t best = -1;
+    for (size_t i = 0; i < sources_.size(); i++) {
+        const Source &source = sources_[i];
+        if (source.disabled || source.active >= MAX_CONNECTIONS_PER_SOURCE) {
+            continue;
+        }
+        if (!source.measured) {
+            return static_cast<int32_t>(i);
+        }
+        if (best < 0 || source.rate > sources_[best].rate) {
+            best = static_cast<int32_t>(i);
+        }
+    }
+    return best;
+}
+
+bool DownloadSegmentFetcher::StartTransfer(size_t source, const FetchRange &range)
+{
+    CURL *handle = curl_easy_init();
+    if (handle == nullptr) {
+        return false;
+    }
+    auto transfer = std::make_unique<Transfer>();
+    transfer->owner = this;
+    transfer->handle = handle;
+    transfer->source = source;
+    transfer->offset = range.offset;
+    transfer->length = range.length;
+    transfer->start = std::chrono::steady_clock::now();
+
+    std::string byteRange = std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1);
+    curl_easy_setopt(handle, CURLOPT_URL, sources_[source].url.c_str());
+    curl_easy_setopt(handle, CURLOPT_RANGE, byteRange.c_str());
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer.get());
+    ApplyOptions(handle, header_, share_);
+
+    if (curl_multi_add_handle(multi_, handle) != CURLM_OK) {
+        curl_easy_cleanup(handle);
+        return false;
+    }
+    sources_[source].active++;
+    transfers_[handle] = std::move(transfer);
+    return true;
+}
+
+void DownloadSegmentFetcher::ApplyOptions(CURL *handle, struct curl_slist *header, CURLSH *share)
+{
+    if (header != nullptr) {
+        curl_easy_setopt(handle, CURLOPT_HTTPHEADER, header);
+    }
+    curl_easy_setopt(handle, CURLOPT_USERAGENT, HTTP_DEFAULT_USER_AGENT);
+    curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(handle, CURLOPT_FAILONERROR, 1L);
+#ifdef DOWNLOAD_USE_PROXY
+    curl_easy_setopt(handle, CURLOPT_PROXY, HTTP_PROXY_URL_PORT);
+    curl_easy_setopt(handle, CURLOPT_PROXYTYPE, HTTP_PROXY_TYPE);
+    curl_easy_setopt(handle, CURLOPT_HTTPPROXYTUNNEL, 1L);
+#ifdef DOWNLOAD_PROXY_PASS
+    curl_easy_setopt(handle, CURLOPT_PROXYUSERPWD, HTTP_PROXY_PASS);
+#endif // DOWNLOAD_PROXY_PASS
+#endif // DOWNLOAD_USE_PROXY
+
+#ifdef DOWNLOAD_SSL_CERTIFICATION
+    curl_easy_setopt(handle, CURLOPT_CAINFO, HTTP_DEFAULT_CA_PATH);
+#else
+    // NO_SSL_CERTIFICATION
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+#endif
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    if (share != nullptr) {
+        curl_easy_setopt(handle, CURLOPT_SHARE, share);
+    }
+    // a segment may legitimately take long on a slow mirror, only give up when it stalls
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+    curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, static_cast<long>(DEFAULT_READ_TIMEOUT));
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, DEFAULT_CONNECT_TIMEOUT);
+}
+
+void DownloadSegmentFetcher::FinishTransfer(CURL *handle, CURLcode code)
+{
+    auto it = transfers_.find(handle);
+    if (it == transfers_.end()) {
+        return;
+    }
+    Transfer &transfer = *it->second;
+    Source &source = sources_[transfer.source];
+    source.active--;
+    // a write error is how a segment whose tail was taken over stops once it has its share
+    bool complete = !transfer.badStatus && transfer.received >= transfer.length &&
+        (code == CURLE_OK || code == CURLE_WRITE_ERROR);
+    if (transfer.received > 0) {
+        UpdateRate(source, transfer.received, transfer.start);
+        if (writtenHook_ && !fileError_) {
+            writtenHook_({ transfer.offset, transfer.received });
+        }
+    }
+    if (complete) {
+        source.failures = 0;
+    } else if (!fileError_) {
+        pending_.push_front({ transfer.offset + transfer.received, transfer.length - transfer.received });
+        source.failures++;
+        networkError_ = IsNetworkError(code);
+        if (transfer.ignoresRange) {
+            DOWNLOAD_HILOGW("source %{public}zu ignores Range", transfer.source);
+            rangeIgnored_ = true;
+        }
+        if (transfer.badStatus || code == CURLE_HTTP_RETURNED_ERROR || source.failures >= MAX_SOURCE_FAILURES) {
+            DOWNLOAD_HILOGE("drop source %{public}zu, code %{public}d", transfer.source, code);
+            source.disabled = true;
+        }
+    }
+    curl_multi_remove_handle(multi_, handle);
+    curl_easy_cleanup(handle);
+    transfers_.erase(it);
+}
+
+/**
+ * @brief Hand the second half of the slowest remaining segment to an idle faster source
+ */
+void DownloadSegmentFetcher::StealTail()
+{
+    int32_t thief = PickSource();
+    if (thief < 0 || !sources_[thief].measured) {
+        return;
+    }
+    Transfer *victim = nullptr;
+    double victimTime = 0.0;
+    for (auto &it : transfers_) {
+        Transfer &transfer = *it.second;
+        uint64_t remaining = transfer.length - transfer.received;
+        if (transfer.source == static_cast<size_t>(thief) || remaining < STEAL_MIN_BYTES * 2) {
+            continue;
+        }
+        const Source &source = sources_[transfer.source];
+        if (source.measured && sources_[thief].rate < source.rate * STEAL_RATE_RATIO) {
+            continue;
+        }
+        double time = source.measured && source.rate > 0 ? remaining / source.rate : remaining;
+        if (victim == nullptr || time > victimTime) {
+            victim = &transfer;
+            victimTime = time;
+        }
+    }
+    if (victim == nullptr) {
+        return;
+    }
+    uint64_t keep = (victim->length - victim->received) / 2;
+    FetchRange tail = { victim->offset + victim->received + keep, victim->length - victim->received - keep };
+    if (StartTransfer(static_cast<size_t>(thief), tail)) {
+        victim->length = victim->received + keep;
+    }
+}
+
+void DownloadSegmentFetcher::UpdateRate(Source &source, uint64_t bytes, std::chrono::steady_clock::time_point start)
+{
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (seconds <= 0) {
+        return;
+    }
+    double sample = bytes / seconds;
+    source.rate = source.measured ? source.rate * (1 - RATE_WEIGHT) + sample * RATE_WEIGHT : sample;
+    source.measured = true;
+}
+
+void DownloadSegmentFetcher::FlushProgress(bool force)
+{
+    if (unreported_ == 0 || !progressHook_) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    if (!force && std::chrono::duration_cast<std::chrono::milliseconds>(now - lastReport_).count() <
+        PROGRESS_INTERVAL_MS) {
+        return;
+    }
+    lastReport_ = now;
+    uint64_t bytes = unreported_;
+    unreported_ = 0;
+    progressHook_(bytes);
+}
+
+void DownloadSegmentFetcher::Cleanup()
+{
+    for (auto &it : transfers_) {
+        // an interrupted transfer's bytes are on disk, reporting them lets a checkpoint keep them
+        if (writtenHook_ && !fileError_ && it.second->received > 0) {
+            writtenHook_({ it.second->offset, it.second->received });
+        }
+        if (multi_ != nullptr) {
+            curl_multi_remove_handle(multi_, it.first);
+        }
+        curl_easy_cleanup(it.first);
+    }
+    transfers_.clear();
+    pending_.clear();
+    for (auto &source : sources_) {
+        source.active = 0;
+    }
+    if (multi_ != nullptr) {
+        curl_multi_cleanup(multi_);
+        multi_ = nullptr;
+    }
+    if (header_ != nullptr) {
+        curl_slist_free_all(header_);
+        header_ = nullptr;
+    }
+}
+
+size_t DownloadSegmentFetcher::WriteCallback(void *buffer, size_t size, size_t num, void *param)
+{
+    Transfer *transfer = static_cast<Transfer *>(param);
+    size_t len = size * num;
+    if (transfer->received == 0) {
+        long httpCode = 0;
+        curl_easy_getinfo(transfer->handle, CURLINFO_RESPONSE_CODE, &httpCode);
+        if (httpCode == HTTP_OK) {
+            // a 200 carries the whole body, usable only when the segment is the whole file
+            curl_off_t bodySize = -1;
+            curl_easy_getinfo(transfer->handle, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &bodySize);
+            if (transfer->offset != 0 || bodySize < 0 || static_cast<uint64_t>(bodySize) != transfer->length) {
+                transfer->ignoresRange = true;
+                transfer->badStatus = true;
+                return 0;
+            }
+        } else if (httpCode != HTTP_PARIAL_FILE) {
+            transfer->badStatus = true;
+            return 0;
+        }
+    }
+    size_t want = static_cast<size_t>(std::min<uint64_t>(len, transfer->length - transfer->received));
+    if (want > 0 && pwrite(transfer->owner->fd_, buffer, want, transfer->offset + transfer->received) !=
+        static_cast<ssize_t>(want)) {
+        DOWNLOAD_HILOGE("write segment failed, errno %{public}d", errno);
+        transfer->owner->fileError_ = true;
+        return 0;
+    }
+    transfer->received += want;
+    transfer->owner->unreported_ += want;
+    return want;
+}
+
+bool DownloadSegmentFetcher::IsNetworkError(CURLcode code)
+{
+    switch (code) {
+        case CURLE_COULDNT_RESOLVE_PROXY:
+        case CURLE_COULDNT_RESOLVE_HOST:
+        case CURLE_COULDNT_CONNECT:
+        case CURLE_OPERATION_TIMEDOUT:
+        case CURLE_RECV_ERROR:
+        case CURLE_SEND_ERROR:
+        case CURLE_PARTIAL_FILE:
+        case CURLE_GOT_NOTHING:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+bool DownloadSegmentFetcher::HashRange(int32_t fd, uint64_t offset, uint64_t length, std::string &hex)
+{
+    SHA256_CTX ctx;
+    SHA256_Init(&ctx);
+    std::vector<unsigned char> buffer(HASH_BUFFER_SIZE);
+    uint64_t done = 0;
+    while (done < length) {
+        size_t len = static_cast<size_t>(std::min<uint64_t>(buffer.size(), length - done));
+        ssize_t readLen = pread(fd, buffer.data(), len, offset + done);
+        if (readLen <= 0) {
+            return false;
+        }
+        SHA256_Update(&ctx, buffer.data(), readLen);
+        done += static_cast<uint64_t>(readLen);
+    }
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256_Final(digest, &ctx);
+    hex = DownloadCache::ToHex(digest, sizeof(digest));
+    return true;
+}
+} // namespace OHOS::Request::Download
@@ -79,7 +79,7 @@ int32_t DownloadServiceAbility::Init()
     state_ = ServiceRunningState::STATE_RUNNING;
     uint32_t threadNum = 4;
     DOWNLOAD_HILOGI("Start Download Service Manager with %{public}d threas", threadNum);
-    DownloadServiceManager::Get()->Create(threadNum);
+    DownloadServiceManager::Get()->Create(threadNum, NotifyHandler);
     DOWNLOAD_HILOGE("state_  is %{public}d.", static_cast<int>(state_));
     DOWNLOAD_HILOGI("Init DownloadServiceAbility success.");
     return ERR_OK;
@@ -149,6 +149,47 @@ uint32_t DownloadServiceAbility::Request(const DownloadConfig &config)
     return taskId;
 }
 
+uint32_t DownloadServiceAbility::RequestGroup(const std::vector<DownloadConfig> &configs,
+    std::vector<uint32_t> &taskIds)
+{
+    ManualStart();
+    uint32_t groupId = DownloadServiceManager::Get()->AddGroup(configs, NotifyHandler, taskIds);
+    DOWNLOAD_HILOGI("DownloadServiceAbility Allocate Group[%{public}d] started.", groupId);
+    return groupId;
+}
+
+bool DownloadServiceAbility::GroupAction(uint32_t groupId, uint32_t action)
+{
+    ManualStart();
+    bool result = DownloadServiceManager::Get()->GroupAction(groupId, action);
+    DOWNLOAD_HILOGI("DownloadServiceAbility GroupAction [%{public}d] started.", action);
+    return result;
+}
+
+bool DownloadServiceAbility::BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds)
+{
+    ManualStart();
+    // an action never reaches the tasks of another caller, whatever the client asked for
+    DownloadFilter scoped = filter;
+    scoped.mask |= FILTER_BY_CALLER;
+    bool result = DownloadServiceManager::Get()->BatchAction(scoped, action, taskIds);
+    DOWNLOAD_HILOGI("DownloadServiceAbility BatchAction [%{public}d] on %{public}zu tasks.", action, taskIds.size());
+    return result;
+}
+
+bool DownloadServiceAbility::BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos)
+{
+    ManualStart();
+    // applications only see their own tasks, native services may look at all of them
+    DownloadFilter scoped = filter;
+    if (!IsNativeCaller()) {
+        scoped.mask |= FILTER_BY_CALLER;
+    }
+    bool result = DownloadServiceManager::Get()->BatchQuery(scoped, infos);
+    DOWNLOAD_HILOGI("DownloadServiceAbility BatchQuery found %{public}zu tasks.", infos.size());
+    return result;
+}
+
 bool DownloadServiceAbility::Pause(uint32_t taskId)
 {
     ManualStart();
@@ -207,10 +248,33 @@ bool DownloadServiceAbility::On(uint32_t taskId, const std::string &type, const
         DOWNLOAD_HILOGI("DownloadServiceAbility::On Replace listener.");
         registeredListeners_[combineType] = listener;
     }
+    NotifyFinished(taskId, type, listener);
     DOWNLOAD_HILOGI("DownloadServiceAbility::On end.");
     return true;
 }
 
+void DownloadServiceAbility::NotifyFinished(uint32_t taskId, const std::string &type,
+    const sptr<DownloadNotifyInterface> &listener)
+{
+    // a task can end before its listener arrives, the terminal event is then replayed to the late listener
+    DownloadInfo info;
+    if (!DownloadServiceManager::Get()->Query(taskId, info)) {
+        return;
+    }
+    MessageParcel data;
+    if (type == "complete" && info.GetStatus() == SESSION_SUCCESS) {
+        data.WriteUint32(0);
+    } else if (type == "fail" && info.GetStatus() == SESSION_FAILED) {
+        data.WriteUint32(info.GetFailedReason());
+    } else {
+        return;
+    }
+    data.WriteUint32(0);
+    DOWNLOAD_HILOGI("DownloadServiceAbility::On task[%{public}d] already finished, replay %{public}s",
+        taskId, type.c_str());
+    listener->OnCallBack(data);
+}
+
 bool DownloadServiceAbility::Off(uint32_t taskId, const std::string &type)
 {
     std::string combineType = type + "-" + std::to_string(taskId);
@@ -225,6 +289,11 @@ bool DownloadServiceAbility::Off(uint32_t taskId, const std::string &type)
     return false;
 }
 
+bool DownloadServiceAbility::IsNativeCaller()
+{
+    return AccessTokenKit::GetTokenTypeFlag(IPCSkeleton::GetCallingTokenID()) == TOKEN_NATIVE;
+}
+
 bool DownloadServiceAbility::CheckPermission()
 {
     AccessTokenID callerToken = IPCSkeleton::GetCallingTokenID();
@@ -240,13 +309,6 @@ bool DownloadServiceAbility::CheckPermission()
     return result == PERMISSION_GRANTED;
 }
 
-bool DownloadServiceAbility::SetStartId(uint32_t startId)
-{
-    DownloadServiceManager::Get()->SetStartId(startId);
-    DOWNLOAD_HILOGI("Set Start Task id is %{public}d", startId);
-    return true;
-}
-
 void DownloadServiceAbility::NotifyHandler(const std::string& type, uint32_t taskId, uint32_t argv1, uint32_t argv2)
 {
     std::string combineType = type + "-" + std::to_string(taskId);
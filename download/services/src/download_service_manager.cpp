@@ -15,6 +15,15 @@
 
 #include "download_service_manager.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include "log.h"
 
 
@@ -23,13 +32,32 @@ static constexpr uint32_t TASK_SLEEP_INTERVAL = 1;
 static constexpr uint32_t MAX_RETRY_TIMES = 3;
 static constexpr uint32_t MAX_NETWORK_TIMES = 100;
 
+static constexpr uint32_t TASK_ID_RESERVE_STEP = 64;
+/* task changes are written at most once per this many network monitor ticks */
+static constexpr uint32_t SNAPSHOT_SAVE_TICKS = 20;
+static constexpr uint32_t SNAPSHOT_VERSION = 3;
+static constexpr uint32_t SNAPSHOT_CALLER_VERSION = 2;
+static constexpr uint32_t SNAPSHOT_EXTENSION_VERSION = 3;
+static constexpr uint32_t SNAPSHOT_MAX_EXTENSIONS = 64;
+static constexpr const char *SNAPSHOT_KEY_MIRROR = "mirror";
+static constexpr const char *SNAPSHOT_KEY_SIZE = "size";
+static constexpr const char *SNAPSHOT_KEY_SHA256 = "sha256";
+static constexpr const char *SNAPSHOT_KEY_BLOCK_INDEX = "block_index";
+static constexpr const char *SNAPSHOT_KEY_BASE = "base";
+static constexpr size_t SNAPSHOT_MAX_STRING = 64 * 1024;
+static constexpr const char *SNAPSHOT_PATH = "/data/service/el1/public/download/task_snapshot";
+static constexpr const char *SNAPSHOT_TMP_PATH = "/data/service/el1/public/download/task_snapshot.tmp";
+/* kept apart from the snapshot, so a lost or corrupt snapshot never resets the task id */
+static constexpr const char *TASK_ID_MARK_PATH = "/data/service/el1/public/download/task_id_mark";
+static constexpr const char *TASK_ID_MARK_TMP_PATH = "/data/service/el1/public/download/task_id_mark.tmp";
+
 namespace OHOS::Request::Download {
 std::recursive_mutex DownloadServiceManager::instanceLock_;
 std::shared_ptr<DownloadServiceManager> DownloadServiceManager::instance_ = nullptr;
 
 DownloadServiceManager::DownloadServiceManager()
     : initialized_(false), interval_(TASK_SLEEP_INTERVAL), threadNum_(THREAD_POOL_NUM), timeoutRetry_(MAX_RETRY_TIMES),
-    networkThread_(nullptr), taskId_(0)
+    networkThread_(nullptr), taskId_(0), reservedId_(0), snapshotDirty_(false)
 {
 }
 
@@ -49,7 +77,7 @@ std::shared_ptr<DownloadServiceManager> DownloadServiceManager::Get()
     return instance_;
 }
 
-bool DownloadServiceManager::Create(uint32_t threadNum)
+bool DownloadServiceManager::Create(uint32_t threadNum, DownloadTaskCallback eventCb)
 {
     std::lock_guard<std::recursive_mutex> lock(mutex_);
     if (initialized_) {
@@ -67,6 +95,7 @@ bool DownloadServiceManager::Create(uint32_t threadNum)
         DOWNLOAD_HILOGD("Failed to initialize 'curl'");
         return false;
     }
+    RestoreSnapshot(eventCb);
     networkThread_ = std::make_shared<std::thread>(MonitorNetwork, this);
     
     initialized_ = true;
@@ -79,6 +108,8 @@ void DownloadServiceManager::Destroy()
     threadList_.clear();
     initialized_ = false;
     networkThread_->join();
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    SaveSnapshot();
 }
 
 uint32_t DownloadServiceManager::AddTask(const DownloadConfig& config)
@@ -96,13 +127,145 @@ uint32_t DownloadServiceManager::AddTask(const DownloadConfig& config)
         DOWNLOAD_HILOGD("No mem to add task");
         return -1;
     }
-    // move new task into pending queue
+    // move new task into pending queue, unless an identical request is already in flight
     task->SetRetryTime(timeoutRetry_);
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
     taskMap_[taskId] = task;
+    JoinInFlight(taskId, task);
     MoveTaskToQueue(taskId, task);
+    MarkSnapshotDirty();
     return taskId;
 }
 
+/**
+ * @brief Admit a list of downloads as one group. Members share DNS and TLS session caches and report
+ * through the group, which emits aggregated events under the returned group id
+ */
+uint32_t DownloadServiceManager::AddGroup(const std::vector<DownloadConfig> &configs, DownloadTaskCallback eventCb,
+    std::vector<uint32_t> &taskIds)
+{
+    if (!initialized_ || configs.empty()) {
+        return -1;
+    }
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    uint32_t groupId = GetCurrentTaskId();
+    auto group = std::make_shared<DownloadGroup>(groupId, eventCb);
+    std::vector<std::shared_ptr<DownloadServiceTask>> tasks;
+    for (const auto &config : configs) {
+        uint32_t taskId = GetCurrentTaskId();
+        auto task = std::make_shared<DownloadServiceTask>(taskId, config);
+        task->SetRetryTime(timeoutRetry_);
+        task->SetShare(group->GetShare());
+        task->InstallCallback(GroupEventHandler);
+        group->AddMember(taskId);
+        taskMap_[taskId] = task;
+        taskIds.push_back(taskId);
+        tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> groupLock(groupMutex_);
+        groups_[groupId] = group;
+        for (auto taskId : taskIds) {
+            taskGroup_[taskId] = groupId;
+        }
+    }
+    for (auto &task : tasks) {
+        MoveTaskToQueue(task->GetId(), task);
+    }
+    MarkSnapshotDirty();
+    DOWNLOAD_HILOGI("Group[%{public}d] admitted with %{public}zu tasks", groupId, taskIds.size());
+    return groupId;
+}
+
+bool DownloadServiceManager::GroupAction(uint32_t groupId, uint32_t action)
+{
+    if (!initialized_) {
+        return false;
+    }
+    std::shared_ptr<DownloadGroup> group = nullptr;
+    {
+        std::lock_guard<std::mutex> groupLock(groupMutex_);
+        auto it = groups_.find(groupId);
+        if (it == groups_.end()) {
+            return false;
+        }
+        group = it->second;
+    }
+    std::vector<uint32_t> members = group->GetMembers();
+    DOWNLOAD_HILOGD("Group[%{public}d] action [%{public}d] on %{public}zu tasks", groupId, action, members.size());
+    switch (action) {
+        case DOWNLOAD_ACTION_PAUSE:
+            std::for_each(members.begin(), members.end(), [this](uint32_t taskId) { Pause(taskId); });
+            return true;
+
+        case DOWNLOAD_ACTION_RESUME:
+            group->OnResume();
+            std::for_each(members.begin(), members.end(), [this](uint32_t taskId) { Resume(taskId); });
+            return true;
+
+        case DOWNLOAD_ACTION_REMOVE: {
+            group->NotifyRemove();
+            std::for_each(members.begin(), members.end(), [this](uint32_t taskId) { Remove(taskId); });
+            std::lock_guard<std::mutex> groupLock(groupMutex_);
+            groups_.erase(groupId);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Apply one action to every task selected by the filter, taskIds returns the tasks it succeeded on
+ */
+bool DownloadServiceManager::BatchAction(const DownloadFilter &filter, uint32_t action, std::vector<uint32_t> &taskIds)
+{
+    if (!initialized_) {
+        return false;
+    }
+    std::vector<std::shared_ptr<DownloadServiceTask>> tasks = SelectTasks(filter);
+    DOWNLOAD_HILOGD("Batch action [%{public}d] on %{public}zu tasks", action, tasks.size());
+    for (const auto &task : tasks) {
+        bool result = false;
+        switch (action) {
+            case DOWNLOAD_ACTION_PAUSE:
+                result = Pause(task->GetId());
+                break;
+            case DOWNLOAD_ACTION_RESUME:
+                result = Resume(task->GetId());
+                break;
+            case DOWNLOAD_ACTION_REMOVE:
+                result = Remove(task->GetId());
+                break;
+            default:
+                return false;
+        }
+        if (result) {
+            taskIds.push_back(task->GetId());
+        }
+    }
+    return true;
+}
+
+bool DownloadServiceManager::BatchQuery(const DownloadFilter &filter, std::vector<DownloadInfo> &infos)
+{
+    if (!initialized_) {
+        return false;
+    }
+    std::vector<std::shared_ptr<DownloadServiceTask>> tasks = SelectTasks(filter);
+    infos.reserve(tasks.size());
+    for (const auto &task : tasks) {
+        DownloadInfo info;
+        if (!task->Query(info)) {
+            // keep one info per selected task, the page length tells the caller whether more tasks follow
+            DOWNLOAD_HILOGE("Query Task[%{public}d] failed in batch", task->GetId());
+            info.SetDownloadId(task->GetId());
+        }
+        infos.push_back(info);
+    }
+    return true;
+}
+
 void DownloadServiceManager::InstallCallback(uint32_t taskId, DownloadTaskCallback eventCb)
 {
     if (!initialized_) {
@@ -138,6 +301,7 @@ bool DownloadServiceManager::ProcessTask()
             return false;
         }
         bool result = task->Run();
+        this->ReleaseFollowers(task);
         this->MoveTaskToQueue(taskId, task);
         return result;
     };
@@ -155,7 +319,9 @@ bool DownloadServiceManager::Pause(uint32_t taskId)
         return false;
     }
 
+    LeaveLeader(taskId);
     if (it->second->Pause()) {
+        ReleaseFollowers(it->second);
         MoveTaskToQueue(taskId, it->second);
         return true;
     }
@@ -191,12 +357,16 @@ bool DownloadServiceManager::Remove(uint32_t taskId)
         return false;
     }
 
+    LeaveLeader(taskId);
     bool result = it->second->Remove();
     if (result) {
+        ReleaseFollowers(it->second);
+        LeaveGroup(taskId);
         std::lock_guard<std::recursive_mutex> autoLock(mutex_);
         taskMap_.erase(it);
         RemoveFromQueue(pendingQueue_, taskId);
         RemoveFromQueue(pausedQueue_, taskId);
+        MarkSnapshotDirty();
     }
     return result;
 }
@@ -225,20 +395,132 @@ bool DownloadServiceManager::QueryMimeType(uint32_t taskId, std::string &mimeTyp
     return it->second->QueryMimeType(mimeType);
 }
 
-void DownloadServiceManager::SetStartId(uint32_t startId)
+/**
+ * @brief Attach task to an in-flight task with the same url and headers, so one transfer serves both
+ *
+ * @return true if task became a follower and must not be queued
+ */
+bool DownloadServiceManager::JoinInFlight(uint32_t taskId, std::shared_ptr<DownloadServiceTask> task)
 {
+    int32_t fd = task->GetConfig().GetFD();
+    if (fd <= 0 || lseek(fd, 0, SEEK_END) != 0) {
+        return false;
+    }
     std::lock_guard<std::recursive_mutex> autoLock(mutex_);
-    taskId_ = startId;
+    for (const auto &it : taskMap_) {
+        if (it.first == taskId || followerMap_.find(it.first) != followerMap_.end()) {
+            continue;
+        }
+        if (it.second->CanLead(task->GetConfig()) && it.second->AttachFollower(task)) {
+            followerMap_[taskId] = it.first;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Settle the followers of a leader that stopped: they complete with it, or are queued to
+ * continue on their own from the part they already received
+ */
+void DownloadServiceManager::ReleaseFollowers(std::shared_ptr<DownloadServiceTask> leader)
+{
+    std::vector<std::shared_ptr<DownloadServiceTask>> followers = leader->DetachFollowers();
+    if (followers.empty()) {
+        return;
+    }
+    DownloadStatus status;
+    ErrorCode code;
+    PausedReason reason;
+    leader->GetRunResult(status, code, reason);
+    std::string mimeType;
+    leader->QueryMimeType(mimeType);
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    for (auto &follower : followers) {
+        followerMap_.erase(follower->GetId());
+        follower->FinishFollowing(status == SESSION_SUCCESS, mimeType);
+        MoveTaskToQueue(follower->GetId(), follower);
+    }
+}
+
+void DownloadServiceManager::LeaveLeader(uint32_t taskId)
+{
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    auto it = followerMap_.find(taskId);
+    if (it == followerMap_.end()) {
+        return;
+    }
+    auto leader = taskMap_.find(it->second);
+    if (leader != taskMap_.end()) {
+        leader->second->DropFollower(taskId);
+    }
+    followerMap_.erase(it);
 }
 
-uint32_t DownloadServiceManager::GetStartId() const
+std::shared_ptr<DownloadGroup> DownloadServiceManager::FindGroupOf(uint32_t taskId)
 {
-    return taskId_;
+    std::lock_guard<std::mutex> groupLock(groupMutex_);
+    auto it = taskGroup_.find(taskId);
+    if (it == taskGroup_.end()) {
+        return nullptr;
+    }
+    auto group = groups_.find(it->second);
+    return group != groups_.end() ? group->second : nullptr;
+}
+
+void DownloadServiceManager::LeaveGroup(uint32_t taskId)
+{
+    auto group = FindGroupOf(taskId);
+    {
+        std::lock_guard<std::mutex> groupLock(groupMutex_);
+        taskGroup_.erase(taskId);
+    }
+    if (group != nullptr) {
+        group->RemoveMember(taskId);
+        if (group->IsFinished()) {
+            ReleaseGroup(group);
+        }
+    }
+}
+
+/**
+ * @brief Forget a group once every member reached a terminal state, its tasks stay until removed one by one
+ */
+void DownloadServiceManager::ReleaseGroup(std::shared_ptr<DownloadGroup> group)
+{
+    std::lock_guard<std::mutex> groupLock(groupMutex_);
+    auto it = groups_.find(group->GetId());
+    if (it == groups_.end() || it->second != group) {
+        return;
+    }
+    for (auto taskId : group->GetMembers()) {
+        taskGroup_.erase(taskId);
+    }
+    groups_.erase(it);
+    DOWNLOAD_HILOGD("Group[%{public}d] released", group->GetId());
+}
+
+void DownloadServiceManager::GroupEventHandler(const std::string& type, uint32_t taskId, uint32_t argv1,
+    uint32_t argv2)
+{
+    // never takes the manager lock: the member task holds its own lock while reporting
+    auto group = Get()->FindGroupOf(taskId);
+    if (group != nullptr) {
+        group->OnMemberEvent(type, taskId, argv1, argv2);
+        if (group->IsFinished()) {
+            Get()->ReleaseGroup(group);
+        }
+    }
 }
 
 uint32_t DownloadServiceManager::GetCurrentTaskId()
 {
     std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    if (taskId_ >= reservedId_) {
+        reservedId_ = taskId_ + TASK_ID_RESERVE_STEP;
+        SaveTaskIdMark();
+        SaveSnapshot();
+    }
     return taskId_++;
 }
 
@@ -268,6 +550,7 @@ void DownloadServiceManager::MoveTaskToQueue(uint32_t taskId, std::shared_ptr<Do
     PausedReason reason;
     task->GetRunResult(status, code, reason);
     DOWNLOAD_HILOGD("Status [%{public}d], Code [%{public}d], Reason [%{public}d]", status, code, reason);
+    MarkSnapshotDirty();
     switch (DecideQueueType(status)) {
         case QueueType::PENDING_QUEUE: {
             std::lock_guard<std::recursive_mutex> autoLock(mutex_);
@@ -287,6 +570,54 @@ void DownloadServiceManager::MoveTaskToQueue(uint32_t taskId, std::shared_ptr<Do
     }
 }
 
+/**
+ * @brief Tasks matching the filter with an id from filter.startId on, in id order, at most filter.limit
+ * of them when it is set
+ */
+std::vector<std::shared_ptr<DownloadServiceTask>> DownloadServiceManager::SelectTasks(const DownloadFilter &filter)
+{
+    std::vector<std::shared_ptr<DownloadServiceTask>> tasks;
+    auto isFull = [&tasks, &filter]() -> bool { return filter.limit > 0 && tasks.size() >= filter.limit; };
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    if (!filter.taskIds.empty()) {
+        std::vector<uint32_t> taskIds = filter.taskIds;
+        std::sort(taskIds.begin(), taskIds.end());
+        taskIds.erase(std::unique(taskIds.begin(), taskIds.end()), taskIds.end());
+        for (auto it = std::lower_bound(taskIds.begin(), taskIds.end(), filter.startId);
+            it != taskIds.end() && !isFull(); ++it) {
+            auto task = taskMap_.find(*it);
+            if (task != taskMap_.end() && MatchFilter(task->second, filter)) {
+                tasks.push_back(task->second);
+            }
+        }
+        return tasks;
+    }
+    for (auto it = taskMap_.lower_bound(filter.startId); it != taskMap_.end() && !isFull(); ++it) {
+        if (MatchFilter(it->second, filter)) {
+            tasks.push_back(it->second);
+        }
+    }
+    return tasks;
+}
+
+bool DownloadServiceManager::MatchFilter(std::shared_ptr<DownloadServiceTask> task, const DownloadFilter &filter)
+{
+    if ((filter.mask & FILTER_BY_CALLER) != 0 && task->GetConfig().GetCallerUid() != filter.callerUid) {
+        return false;
+    }
+    DownloadStatus status;
+    ErrorCode code;
+    PausedReason reason;
+    task->GetRunResult(status, code, reason);
+    if ((filter.mask & FILTER_BY_STATUS) != 0 && status != filter.status) {
+        return false;
+    }
+    if ((filter.mask & FILTER_BY_PAUSED_REASON) != 0 && (status != SESSION_PAUSED || reason != filter.pausedReason)) {
+        return false;
+    }
+    return true;
+}
+
 void DownloadServiceManager::PushQueue(std::queue<uint32_t> &queue, uint32_t taskId)
 {
     std::lock_guard<std::recursive_mutex> autoLock(mutex_);
@@ -325,6 +656,236 @@ void DownloadServiceManager::RemoveFromQueue(std::queue<uint32_t> &queue, uint32
     }
 }
 
+static void WriteSnapshotString(std::ostream &out, const std::string &str)
+{
+    out << str.size() << ' ' << str << '\n';
+}
+
+static bool ReadSnapshotString(std::istream &in, std::string &str)
+{
+    size_t length = 0;
+    if (!(in >> length) || length > SNAPSHOT_MAX_STRING || in.get() != ' ') {
+        return false;
+    }
+    str.resize(length);
+    if (length > 0 && !in.read(&str[0], length)) {
+        return false;
+    }
+    return in.get() == '\n';
+}
+
+// optional per-task settings are stored as key/value pairs so new ones do not need a version bump
+static void WriteSnapshotExtensions(std::ostream &out, const DownloadConfig &config)
+{
+    std::vector<std::pair<std::string, std::string>> extensions;
+    for (const auto &mirror : config.GetMirrors()) {
+        extensions.emplace_back(SNAPSHOT_KEY_MIRROR, mirror);
+    }
+    if (config.GetExpectedSize() > 0) {
+        extensions.emplace_back(SNAPSHOT_KEY_SIZE, std::to_string(config.GetExpectedSize()));
+    }
+    if (!config.GetChecksum().empty()) {
+        extensions.emplace_back(SNAPSHOT_KEY_SHA256, config.GetChecksum());
+    }
+    if (!config.GetBlockIndex().empty()) {
+        extensions.emplace_back(SNAPSHOT_KEY_BLOCK_INDEX, config.GetBlockIndex());
+    }
+    if (!config.GetBasePath().empty()) {
+        extensions.emplace_back(SNAPSHOT_KEY_BASE, config.GetBasePath());
+    }
+    out << extensions.size() << '\n';
+    for (const auto &extension : extensions) {
+        WriteSnapshotString(out, extension.first);
+        WriteSnapshotString(out, extension.second);
+    }
+}
+
+static bool ReadSnapshotExtensions(std::istream &in, DownloadConfig &config)
+{
+    uint32_t count = 0;
+    if (!(in >> count) || count > SNAPSHOT_MAX_EXTENSIONS) {
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        std::string key;
+        std::string value;
+        if (!ReadSnapshotString(in, key) || !ReadSnapshotString(in, value)) {
+            return false;
+        }
+        if (key == SNAPSHOT_KEY_MIRROR && config.GetMirrors().size() < DOWNLOAD_MAX_MIRRORS) {
+            config.AddMirror(value);
+        } else if (key == SNAPSHOT_KEY_SIZE) {
+            config.SetExpectedSize(strtoull(value.c_str(), nullptr, 10));
+        } else if (key == SNAPSHOT_KEY_SHA256) {
+            config.SetChecksum(value);
+        } else if (key == SNAPSHOT_KEY_BLOCK_INDEX) {
+            config.SetBlockIndex(value);
+        } else if (key == SNAPSHOT_KEY_BASE) {
+            config.SetBasePath(value);
+        }
+    }
+    return true;
+}
+
+static bool WriteFileAtomic(const char *path, const char *tmpPath, const std::string &content)
+{
+    int32_t fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        return false;
+    }
+    bool result = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    result = result && fsync(fd) == 0;
+    close(fd);
+    return result && rename(tmpPath, path) == 0;
+}
+
+void DownloadServiceManager::RestoreSnapshot(DownloadTaskCallback eventCb)
+{
+    taskId_ = std::max(taskId_, LoadTaskIdMark());
+    std::ifstream in(SNAPSHOT_PATH, std::ios::binary);
+    uint32_t version = 0;
+    uint32_t taskCount = 0;
+    if (!in.is_open() || !(in >> version >> reservedId_ >> taskCount) || version == 0 || version > SNAPSHOT_VERSION) {
+        DOWNLOAD_HILOGI("no task snapshot, task id starts from %{public}d", taskId_);
+        reservedId_ = taskId_;
+        return;
+    }
+    // every id below the reserved mark may have been handed out before the restart
+    taskId_ = std::max(taskId_, reservedId_);
+    uint32_t restored = 0;
+    for (uint32_t i = 0; i < taskCount; i++) {
+        uint32_t taskId = 0;
+        uint32_t status = 0;
+        uint32_t reason = 0;
+        uint32_t networkType = 0;
+        uint32_t headerCount = 0;
+        bool metered = false;
+        bool roaming = false;
+        int32_t callerUid = -1;
+        if (!(in >> taskId >> status >> reason >> networkType >> metered >> roaming >> headerCount)) {
+            break;
+        }
+        // snapshots written before the caller was recorded restore the task without an owner
+        if (version >= SNAPSHOT_CALLER_VERSION && !(in >> callerUid)) {
+            break;
+        }
+        std::string url;
+        std::string description;
+        std::string filePath;
+        std::string title;
+        if (!ReadSnapshotString(in, url) || !ReadSnapshotString(in, description) ||
+            !ReadSnapshotString(in, filePath) || !ReadSnapshotString(in, title)) {
+            break;
+        }
+        DownloadConfig config;
+        bool headerValid = true;
+        for (uint32_t j = 0; j < headerCount && headerValid; j++) {
+            std::string key;
+            std::string value;
+            headerValid = ReadSnapshotString(in, key) && ReadSnapshotString(in, value);
+            config.SetHeader(key, value);
+        }
+        if (!headerValid) {
+            break;
+        }
+        if (version >= SNAPSHOT_EXTENSION_VERSION && !ReadSnapshotExtensions(in, config)) {
+            break;
+        }
+        int32_t fd = open(filePath.c_str(), O_RDWR);
+        if (fd < 0) {
+            DOWNLOAD_HILOGE("drop task[%{public}d], reopen file failed, errno %{public}d", taskId, errno);
+            continue;
+        }
+        config.SetUrl(url);
+        config.SetDescription(description);
+        config.SetFilePath(filePath);
+        config.SetTitle(title);
+        config.SetNetworkType(networkType);
+        config.SetMetered(metered);
+        config.SetRoaming(roaming);
+        config.SetCallerUid(callerUid);
+        config.SetFD(fd);
+        config.SetFDError(0);
+        if (!config.GetBasePath().empty()) {
+            // without the base file every block is downloaded
+            config.SetBaseFD(open(config.GetBasePath().c_str(), O_RDONLY));
+        }
+        auto task = std::make_shared<DownloadServiceTask>(taskId, config);
+        task->SetRetryTime(timeoutRetry_);
+        task->InstallCallback(eventCb);
+        if (status == SESSION_PAUSED && reason == PAUSED_BY_USER) {
+            task->RestoreStatus(SESSION_PAUSED, PAUSED_BY_USER);
+        }
+        taskMap_[taskId] = task;
+        MoveTaskToQueue(taskId, task);
+        restored++;
+    }
+    DOWNLOAD_HILOGI("restore %{public}d tasks, task id starts from %{public}d", restored, taskId_);
+}
+
+bool DownloadServiceManager::SaveSnapshot()
+{
+    std::ostringstream out;
+    uint32_t taskCount = 0;
+    std::ostringstream taskOut;
+    for (const auto &it : taskMap_) {
+        DownloadStatus status;
+        ErrorCode code;
+        PausedReason reason;
+        it.second->GetRunResult(status, code, reason);
+        if (status == SESSION_SUCCESS || status == SESSION_FAILED) {
+            continue;
+        }
+        const DownloadConfig &config = it.second->GetConfig();
+        taskOut << it.first << ' ' << status << ' ' << reason << ' ' << config.GetNetworkType() << ' ' <<
+            config.GetMetered() << ' ' << config.GetRoaming() << ' ' << config.GetHeader().size() << ' ' <<
+            config.GetCallerUid() << '\n';
+        WriteSnapshotString(taskOut, config.GetUrl());
+        WriteSnapshotString(taskOut, config.GetDescription());
+        WriteSnapshotString(taskOut, config.GetFilePath());
+        WriteSnapshotString(taskOut, config.GetTitle());
+        for (const auto &header : config.GetHeader()) {
+            WriteSnapshotString(taskOut, header.first);
+            WriteSnapshotString(taskOut, header.second);
+        }
+        WriteSnapshotExtensions(taskOut, config);
+        taskCount++;
+    }
+    out << SNAPSHOT_VERSION << ' ' << reservedId_ << ' ' << taskCount << '\n' << taskOut.str();
+    if (!WriteFileAtomic(SNAPSHOT_PATH, SNAPSHOT_TMP_PATH, out.str())) {
+        DOWNLOAD_HILOGE("failed to save task snapshot, errno %{public}d", errno);
+        return false;
+    }
+    snapshotDirty_ = false;
+    return true;
+}
+
+uint32_t DownloadServiceManager::LoadTaskIdMark()
+{
+    std::ifstream in(TASK_ID_MARK_PATH, std::ios::binary);
+    uint32_t mark = 0;
+    if (!in.is_open() || !(in >> mark)) {
+        DOWNLOAD_HILOGI("no task id mark");
+        return 0;
+    }
+    return mark;
+}
+
+bool DownloadServiceManager::SaveTaskIdMark()
+{
+    if (!WriteFileAtomic(TASK_ID_MARK_PATH, TASK_ID_MARK_TMP_PATH, std::to_string(reservedId_) + '\n')) {
+        DOWNLOAD_HILOGE("failed to save task id mark, errno %{public}d", errno);
+        return false;
+    }
+    return true;
+}
+
+void DownloadServiceManager::MarkSnapshotDirty()
+{
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    snapshotDirty_ = true;
+}
+
 void DownloadServiceManager::SetInterval(uint32_t interval)
 {
     interval_ = interval;
@@ -383,6 +944,7 @@ void DownloadServiceManager::MonitorNetwork(DownloadServiceManager *thisVal)
 {
     bool isOnline = true;
     bool currentStatus = true;
+    uint32_t snapshotTicks = 0;
     if (thisVal == nullptr) {
         DOWNLOAD_HILOGD("DownloadServiceManager::MonitorNetwork thisVal is nullptr");
         return;
@@ -394,6 +956,15 @@ void DownloadServiceManager::MonitorNetwork(DownloadServiceManager *thisVal)
             thisVal->ResumeTaskByNetwork();
         }
         isOnline = currentStatus;
+        if (++snapshotTicks >= SNAPSHOT_SAVE_TICKS) {
+            // task changes are coalesced and flushed here in the background instead of on every IPC,
+            // id reservations and service stop still save immediately
+            snapshotTicks = 0;
+            std::lock_guard<std::recursive_mutex> autoLock(thisVal->mutex_);
+            if (thisVal->snapshotDirty_) {
+                thisVal->SaveSnapshot();
+            }
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(MAX_NETWORK_TIMES));
         std::this_thread::yield();
     }
@@ -22,6 +22,8 @@
 
 namespace OHOS::Request::Download {
 using namespace OHOS::HiviewDFX;
+static constexpr uint32_t BATCH_QUERY_PAGE = 256;
+static constexpr size_t BATCH_REPLY_BUDGET = 128 * 1024;
 
 int32_t DownloadServiceStub::OnRemoteRequest(
     uint32_t code, MessageParcel &data, MessageParcel &reply, MessageOption &option)
@@ -55,9 +57,14 @@ int32_t DownloadServiceStub::OnRemoteRequest(
         case CMD_CHECKPERMISSION:
             return OnCheckPermission(data, reply);
             break;
-        case CMD_SETSTARTID:
-            return OnSetStartId(data, reply);
-            break;
+        case CMD_REQUEST_GROUP:
+            return OnRequestGroup(data, reply);
+        case CMD_GROUP_ACTION:
+            return OnGroupAction(data, reply);
+        case CMD_BATCH_ACTION:
+            return OnBatchAction(data, reply);
+        case CMD_BATCH_QUERY:
+            return OnBatchQuery(data, reply);
         default:
             DOWNLOAD_HILOGE("Default value received, check needed.");
             return IPCObjectStub::OnRemoteRequest(code, data, reply, option);
@@ -65,10 +72,8 @@ int32_t DownloadServiceStub::OnRemoteRequest(
     return E_DOWNLOAD_OK;
 }
 
-bool DownloadServiceStub::OnRequest(MessageParcel &data, MessageParcel &reply)
+void DownloadServiceStub::ReadConfig(MessageParcel &data, DownloadConfig &config)
 {
-    DOWNLOAD_HILOGD("Receive request");
-    DownloadConfig config;
     int32_t fd  = data.ReadFileDescriptor();
     DOWNLOAD_HILOGI("Get FD from client, fd [%{public}d]", fd);
     config.SetFD(fd);
@@ -80,12 +85,31 @@ bool DownloadServiceStub::OnRequest(MessageParcel &data, MessageParcel &reply)
     config.SetNetworkType(data.ReadUint32());
     config.SetFilePath(data.ReadString());
     config.SetTitle(data.ReadString());
-    config.SetDescription(data.ReadString());
 
     uint32_t headerSize = data.ReadUint32();
     for (uint32_t i = 0; i < headerSize; i++) {
         config.SetHeader(data.ReadString(), data.ReadString());
     }
+    config.SetCacheable(data.ReadBool());
+    uint32_t mirrorCount = data.ReadUint32();
+    for (uint32_t i = 0; i < mirrorCount && i < DOWNLOAD_MAX_MIRRORS; i++) {
+        config.AddMirror(data.ReadString());
+    }
+    config.SetExpectedSize(data.ReadUint64());
+    config.SetChecksum(data.ReadString());
+    config.SetBlockIndex(data.ReadString());
+    config.SetBasePath(data.ReadString());
+    if (data.ReadBool()) {
+        config.SetBaseFD(data.ReadFileDescriptor());
+    }
+    config.SetCallerUid(IPCSkeleton::GetCallingUid());
+}
+
+bool DownloadServiceStub::OnRequest(MessageParcel &data, MessageParcel &reply)
+{
+    DOWNLOAD_HILOGD("Receive request");
+    DownloadConfig config;
+    ReadConfig(data, config);
     config.Dump();
     uint32_t result = Request(config);
     if (!reply.WriteUint32(result)) {
@@ -95,6 +119,42 @@ bool DownloadServiceStub::OnRequest(MessageParcel &data, MessageParcel &reply)
     return true;
 }
 
+bool DownloadServiceStub::OnRequestGroup(MessageParcel &data, MessageParcel &reply)
+{
+    DOWNLOAD_HILOGD("Receive group request");
+    uint32_t count = data.ReadUint32();
+    if (count == 0 || count > GROUP_MAX_TASKS) {
+        DOWNLOAD_HILOGE("Invalid group size [%{public}u]", count);
+        return false;
+    }
+    std::vector<DownloadConfig> configs(count);
+    for (auto &config : configs) {
+        ReadConfig(data, config);
+    }
+    std::vector<uint32_t> taskIds;
+    uint32_t groupId = RequestGroup(configs, taskIds);
+    if (!reply.WriteUint32(groupId) || !reply.WriteUint32(taskIds.size())) {
+        DOWNLOAD_HILOGE("WriteUint32 failed");
+        return false;
+    }
+    for (auto taskId : taskIds) {
+        reply.WriteUint32(taskId);
+    }
+    return true;
+}
+
+bool DownloadServiceStub::OnGroupAction(MessageParcel &data, MessageParcel &reply)
+{
+    uint32_t groupId = data.ReadUint32();
+    uint32_t action = data.ReadUint32();
+    bool result = GroupAction(groupId, action);
+    if (!reply.WriteBool(result)) {
+        DOWNLOAD_HILOGE("WriteBool failed");
+        return false;
+    }
+    return true;
+}
+
 bool DownloadServiceStub::OnPause(MessageParcel &data, MessageParcel &reply)
 {
     bool result = Pause(data.ReadUint32());
@@ -110,16 +170,7 @@ bool DownloadServiceStub::OnQuery(MessageParcel &data, MessageParcel &reply)
     DownloadInfo info;
     bool result = Query(data.ReadUint32(), info);
     if (result) {
-        reply.WriteString(info.GetDescription());
-        reply.WriteUint32(info.GetDownloadedBytes());
-        reply.WriteUint32(info.GetDownloadId());
-        reply.WriteUint32(info.GetFailedReason());
-        reply.WriteString(info.GetFileName());
-        reply.WriteString(info.GetFilePath());
-        reply.WriteUint32(info.GetPausedReason());
-        reply.WriteUint32(info.GetStatus());
-        reply.WriteString(info.GetTargetURI());
-        reply.WriteString(info.GetDownloadTitle());
+        WriteInfo(reply, info);
         info.Dump();
     }
     if (!reply.WriteBool(result)) {
@@ -129,6 +180,93 @@ bool DownloadServiceStub::OnQuery(MessageParcel &data, MessageParcel &reply)
     return true;
 }
 
+void DownloadServiceStub::WriteInfo(MessageParcel &reply, const DownloadInfo &info)
+{
+    reply.WriteString(info.GetDescription());
+    reply.WriteUint32(info.GetDownloadedBytes());
+    reply.WriteUint32(info.GetDownloadId());
+    reply.WriteUint32(info.GetFailedReason());
+    reply.WriteString(info.GetFileName());
+    reply.WriteString(info.GetFilePath());
+    reply.WriteUint32(info.GetPausedReason());
+    reply.WriteUint32(info.GetStatus());
+    reply.WriteString(info.GetTargetURI());
+    reply.WriteString(info.GetDownloadTitle());
+    reply.WriteUint32(info.GetDownloadTotalBytes());
+}
+
+bool DownloadServiceStub::ReadFilter(MessageParcel &data, DownloadFilter &filter)
+{
+    filter.mask = data.ReadUint32();
+    filter.status = static_cast<DownloadStatus>(data.ReadUint32());
+    filter.pausedReason = static_cast<PausedReason>(data.ReadUint32());
+    filter.startId = data.ReadUint32();
+    uint32_t count = data.ReadUint32();
+    if (count > BATCH_MAX_TASKS) {
+        DOWNLOAD_HILOGE("Invalid batch size [%{public}u]", count);
+        return false;
+    }
+    filter.taskIds.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        filter.taskIds.push_back(data.ReadUint32());
+    }
+    // the caller is taken from the transaction, never from the parcel
+    filter.callerUid = IPCSkeleton::GetCallingUid();
+    return true;
+}
+
+bool DownloadServiceStub::OnBatchAction(MessageParcel &data, MessageParcel &reply)
+{
+    DownloadFilter filter;
+    if (!ReadFilter(data, filter)) {
+        return false;
+    }
+    uint32_t action = data.ReadUint32();
+    std::vector<uint32_t> taskIds;
+    bool result = BatchAction(filter, action, taskIds);
+    if (!reply.WriteBool(result) || !reply.WriteUint32(taskIds.size())) {
+        DOWNLOAD_HILOGE("WriteBool failed");
+        return false;
+    }
+    for (auto taskId : taskIds) {
+        reply.WriteUint32(taskId);
+    }
+    return true;
+}
+
+bool DownloadServiceStub::OnBatchQuery(MessageParcel &data, MessageParcel &reply)
+{
+    DownloadFilter filter;
+    if (!ReadFilter(data, filter)) {
+        return false;
+    }
+    filter.limit = BATCH_QUERY_PAGE;
+    std::vector<DownloadInfo> infos;
+    BatchQuery(filter, infos);
+    // infos carry strings, stop at the reply budget and let the proxy ask for the rest
+    size_t written = 0;
+    MessageParcel page;
+    while (written < infos.size() && page.GetDataSize() < BATCH_REPLY_BUDGET) {
+        WriteInfo(page, infos[written]);
+        written++;
+    }
+    // BatchQuery answers one info per selected task, a full page means the selection may go on
+    bool hasMore = written < infos.size() || infos.size() >= BATCH_QUERY_PAGE;
+    uint32_t nextId = filter.startId;
+    if (written < infos.size()) {
+        nextId = infos[written].GetDownloadId();
+    } else if (!infos.empty()) {
+        nextId = infos.back().GetDownloadId() + 1;
+    }
+    if (!reply.WriteUint32(written) || !reply.Append(page)) {
+        DOWNLOAD_HILOGE("WriteUint32 failed");
+        return false;
+    }
+    reply.WriteBool(hasMore);
+    reply.WriteUint32(nextId);
+    return true;
+}
+
 bool DownloadServiceStub::OnQueryMimeType(MessageParcel &data, MessageParcel &reply)
 {
     std::string mime;
@@ -219,16 +357,4 @@ bool DownloadServiceStub::OnCheckPermission(MessageParcel &data, MessageParcel &
     DOWNLOAD_HILOGD("DownloadServiceStub::OnCheckPermission out");
     return true;
 }
-
-bool DownloadServiceStub::OnSetStartId(MessageParcel &data, MessageParcel &reply)
-{
-    DOWNLOAD_HILOGD("DownloadServiceStub::OnSetStartId in");
-    uint32_t startId = data.ReadUint32();
-    bool result = SetStartId(startId);
-    if (!reply.WriteBool(result)) {
-        return false;
-    }
-    DOWNLOAD_HILOGD("DownloadServiceStub::OnSetStartId out");
-    return true;
-}
 } // namespace OHOS::Request::Download
@@ -17,16 +17,43 @@
 
 #include <algorithm>
 #include <cerrno>
+#include <limits>
+#include <fcntl.h>
 #include <unistd.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include "constant.h"
+#include "download_group.h"
+#include "download_block_index.h"
 #include "log.h"
 
 namespace OHOS::Request::Download {
+static constexpr size_t COALESCE_COPY_BUFFER = 64 * 1024;
+static constexpr const char *CHECKPOINT_DIR = "/data/service/el1/public/download/checkpoint/";
+
+// sizes are tracked in 64 bits, progress events and DownloadInfo still carry 32 bit values
+static uint32_t ToEventSize(int64_t size)
+{
+    constexpr int64_t sizeLimit = std::numeric_limits<uint32_t>::max();
+    return static_cast<uint32_t>(std::min(std::max<int64_t>(size, 0), sizeLimit));
+}
+
+static bool IsSameFile(int32_t fd, int32_t otherFd)
+{
+    struct stat fileStat = {};
+    struct stat otherStat = {};
+    if (fd < 0 || otherFd < 0 || fstat(fd, &fileStat) != 0 || fstat(otherFd, &otherStat) != 0) {
+        return false;
+    }
+    return fileStat.st_dev == otherStat.st_dev && fileStat.st_ino == otherStat.st_ino;
+}
+
 DownloadServiceTask::DownloadServiceTask(uint32_t taskId, const DownloadConfig &config)
     : taskId_(taskId), config_(config), status_(SESSION_UNKNOWN), code_(ERROR_UNKNOWN), reason_(PAUSED_UNKNOWN),
       mimeType_(""), file_(nullptr), totalSize_(0), downloadSize_(0), isPartialMode_(false), forceStop_(false),
-      isRemoved_(false), retryTime_(10), eventCb_(nullptr), hasFileSize_(false), isOnline_(true), prevSize_(0) {
+      isRemoved_(false), retryTime_(10), eventCb_(nullptr), hasFileSize_(false), isOnline_(true), prevSize_(0),
+      hasCacheEntry_(false), isRevalidating_(false), isSingleStream_(false),
+      isFollower_(false), isStreaming_(false), share_(nullptr) {
 }
 
 DownloadServiceTask::~DownloadServiceTask(void)
@@ -40,6 +67,10 @@ DownloadServiceTask::~DownloadServiceTask(void)
         close(config_.GetFD());
         config_.SetFD(-1);
     }
+    if (config_.GetBaseFD() >= 0) {
+        close(config_.GetBaseFD());
+        config_.SetBaseFD(-1);
+    }
 }
 
 uint32_t DownloadServiceTask::GetId() const
@@ -47,6 +78,11 @@ uint32_t DownloadServiceTask::GetId() const
     return taskId_;
 }
 
+const DownloadConfig &DownloadServiceTask::GetConfig() const
+{
+    return config_;
+}
+
 bool DownloadServiceTask::Run()
 {
     DOWNLOAD_HILOGD("Task[%{public}d] start.", taskId_);
@@ -57,14 +93,25 @@ bool DownloadServiceTask::Run()
     uint32_t retryTime = 0;
     bool result = false;
     bool enableTimeout = false;
+    if (status_ == SESSION_PAUSED) {
+        DOWNLOAD_HILOGD("Task[%{public}d] paused before it started", taskId_);
+        return false;
+    }
     SetStatus(SESSION_RUNNING);
+    if (PrepareCache()) {
+        return true;
+    }
     
     do {
         enableTimeout = false;
         if (status_ != SESSION_RUNNING && status_ != SESSION_PENDING) {
             break;
         }
-        if (GetFileSize(totalSize_)) {
+        if (!config_.GetBlockIndex().empty()) {
+            result = ExecBlocks();
+        } else if (!config_.GetMirrors().empty()) {
+            result = ExecSegmented();
+        } else if (GetFileSize(totalSize_)) {
             result = ExecHttp();
         }
         DumpStatus();
@@ -86,7 +133,8 @@ bool DownloadServiceTask::Run()
 bool DownloadServiceTask::Pause()
 {
     DOWNLOAD_HILOGD("Status [%{public}d], Code [%{public}d], Reason [%{public}d]", status_, code_, reason_);
-    if (status_ != SESSION_RUNNING && status_ != SESSION_PENDING) {
+    // a queued task may be paused before it starts, e.g. by a group pause
+    if (status_ != SESSION_RUNNING && status_ != SESSION_PENDING && status_ != SESSION_UNKNOWN) {
         return false;
     }
     ForceStopRunning();
@@ -116,6 +164,9 @@ bool DownloadServiceTask::Remove()
     DOWNLOAD_HILOGD("Status [%{public}d], Code [%{public}d], Reason [%{public}d]", status_, code_, reason_);
     isRemoved_ = true;
     ForceStopRunning();
+    if (!config_.GetBlockIndex().empty() || !config_.GetMirrors().empty()) {
+        unlink(GetCheckpointPath().c_str());
+    }
     if (eventCb_ != nullptr) {
         eventCb_("remove", taskId_, 0, 0);
     }
@@ -126,7 +177,7 @@ bool DownloadServiceTask::Query(DownloadInfo &info)
 {
     DOWNLOAD_HILOGD("Query Task[%{public}d], current status is %{public}d\n", taskId_, status_);
     info.SetDescription(config_.GetDescription());
-    info.SetDownloadedBytes(downloadSize_);
+    info.SetDownloadedBytes(ToEventSize(downloadSize_));
     info.SetDownloadId(taskId_);
     info.SetFailedReason(code_);
     std::string fileName = config_.GetFilePath().substr(config_.GetFilePath().rfind('/') + 1);
@@ -137,7 +188,7 @@ bool DownloadServiceTask::Query(DownloadInfo &info)
     info.SetStatus(status_);
     info.SetTargetURI(config_.GetUrl());
     info.SetDownloadTitle(config_.GetTitle());
-    info.SetDownloadTotalBytes(totalSize_);
+    info.SetDownloadTotalBytes(ToEventSize(totalSize_));
     return true;
 }
 
@@ -160,11 +211,23 @@ void DownloadServiceTask::GetRunResult(DownloadStatus &status, ErrorCode &code,
     reason = reason_;
 }
 
+void DownloadServiceTask::RestoreStatus(DownloadStatus status, PausedReason reason)
+{
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    status_ = status;
+    reason_ = reason;
+}
+
 void DownloadServiceTask::SetRetryTime(uint32_t retryTime)
 {
     retryTime_ = retryTime;
 }
 
+void DownloadServiceTask::SetShare(std::shared_ptr<DownloadShare> share)
+{
+    share_ = share;
+}
+
 void DownloadServiceTask::SetNetworkStatus(bool isOnline)
 {
     std::lock_guard<std::recursive_mutex> autoLock(mutex_);
@@ -400,11 +463,15 @@ size_t DownloadServiceTask::WriteCallback(void *buffer, size_t size, size_t num,
     size_t result = 0;
     DownloadServiceTask *this_ = static_cast<DownloadServiceTask *>(param);
     if (this_ != nullptr && this_->config_.GetFD() > 0) {
+        // followers attach under the same lock, so their copied prefix never misses a chunk
+        std::lock_guard<std::mutex> autoLock(this_->followerMutex_);
         result = static_cast<size_t>(write(this_->config_.GetFD(), buffer, size * num));
         if (result < size * num) {
             DOWNLOAD_HILOGE("origin size = %{public}zu, write size = %{public}zu", size * num, result);
         }
-        this_->downloadSize_ += static_cast<uint32_t>(result);
+        this_->cacheWriter_.Write(buffer, result);
+        this_->downloadSize_ += static_cast<int64_t>(result);
+        this_->FanOut(buffer, result);
     }
     return result;
 }
@@ -412,7 +479,10 @@ size_t DownloadServiceTask::WriteCallback(void *buffer, size_t size, size_t num,
 size_t DownloadServiceTask::HeaderCallback(void *buffer, size_t size, size_t num, void *param)
 {
     DownloadServiceTask *this_ = static_cast<DownloadServiceTask *>(param);
-    std::string recvHeader = static_cast<char *>(buffer);
+    std::string recvHeader(static_cast<char *>(buffer), size * num);
+    if (this_ != nullptr && this_->config_.GetCacheable()) {
+        DownloadCache::ParseHeader(recvHeader, this_->responseCache_);
+    }
     if (this_ != nullptr && recvHeader.find(HTTP_CONTENT_TYPE) != std::string::npos) {
         std::string mimeType = recvHeader.substr(recvHeader.find(HTTP_HEADER_SEPARATOR) + 2);
         mimeType = mimeType.substr(0, mimeType.find(HTTP_LINE_SEPARATOR));
@@ -433,13 +503,17 @@ int DownloadServiceTask::ProgressCallback(void *pParam, double dltotal, double d
             DOWNLOAD_HILOGD("Pause issued by user\n");
             return HTTP_FORCE_STOP;
         }
+        // the HEAD request was skipped for a cached url, take the size of a changed body from the GET
+        if (this_->isRevalidating_ && dltotal > 0) {
+            this_->totalSize_ = static_cast<int64_t>(dltotal);
+        }
         if (this_->eventCb_ == nullptr) {
             return 0;
         }
         if (this_->prevSize_ != this_->downloadSize_) {
             std::lock_guard<std::recursive_mutex> autoLock(this_->mutex_);
             if (this_->status_ != SESSION_PAUSED) {
-                this_->eventCb_("progress",  this_->taskId_, this_->downloadSize_, this_->totalSize_);
+                this_->NotifyProgress();
                 this_->prevSize_ = this_->downloadSize_;
             }
         }
@@ -459,11 +533,13 @@ bool DownloadServiceTask::ExecHttp()
 
     DOWNLOAD_HILOGD("final url: %{public}s\n", config_.GetUrl().c_str());
 
-    std::vector<std::string> vec;
-    std::for_each(
-        config_.GetHeader().begin(), config_.GetHeader().end(), [&vec](const std::pair<std::string, std::string> &p) {
-            vec.emplace_back(p.first + HTTP_HEADER_SEPARATOR + p.second);
-        });
+    std::vector<std::string> vec = MakeHeaderLines();
+    isRevalidating_ = false;
+    if (hasCacheEntry_ && config_.GetFD() > 0 && lseek(config_.GetFD(), 0, SEEK_END) == 0) {
+        std::vector<std::string> validators = DownloadCache::MakeValidators(cacheEntry_);
+        vec.insert(vec.end(), validators.begin(), validators.end());
+        isRevalidating_ = true;
+    }
     std::unique_ptr<struct curl_slist, decltype(&curl_slist_free_all)> header(MakeHeaders(vec), curl_slist_free_all);
 
     if (!SetOption(handle.get(), header.get())) {
@@ -473,12 +549,12 @@ bool DownloadServiceTask::ExecHttp()
 
     if (config_.GetFD() > 0) {
         DOWNLOAD_HILOGD("Succeed to open download file");
-        uint64_t pos = lseek(config_.GetFD(), 0, SEEK_END);
+        int64_t pos = lseek(config_.GetFD(), 0, SEEK_END);
         downloadSize_ = 0;
         if (pos > 0) {
             if (pos < totalSize_) {
                 isPartialMode_ = true;
-                downloadSize_ = static_cast<uint32_t>(pos);
+                downloadSize_ = pos;
                 SetResumeFromLarge(handle.get(), pos);
             } else if (pos >= totalSize_) {
                 downloadSize_ = totalSize_;
@@ -494,8 +570,21 @@ bool DownloadServiceTask::ExecHttp()
     } else {
         DOWNLOAD_HILOGD("Failed to open download file");
     }
+    // only a body received from the first byte can be cached
+    if (config_.GetCacheable() && !isPartialMode_ && downloadSize_ == 0) {
+        cacheWriter_.Open();
+    }
 
+    {
+        // publishes the resume offset set above to AttachFollower together with the flag
+        std::lock_guard<std::mutex> autoLock(followerMutex_);
+        isStreaming_ = true;
+    }
     CURLcode code = curl_easy_perform(handle.get());
+    {
+        std::lock_guard<std::mutex> autoLock(followerMutex_);
+        isStreaming_ = false;
+    }
 
     if (file_ != nullptr) {
         fflush(file_);
@@ -503,11 +592,275 @@ bool DownloadServiceTask::ExecHttp()
     }
     int32_t httpCode;
     curl_easy_getinfo(handle.get(), CURLINFO_RESPONSE_CODE, &httpCode);
+    if (code == CURLE_OK && httpCode == HTTP_NOT_MODIFIED && isRevalidating_) {
+        cacheWriter_.Abort();
+        DownloadCache::GetInstance().Refresh(cacheEntry_, responseCache_);
+        if (!ServeFromCache()) {
+            SetStatus(SESSION_PENDING);
+            return false;
+        }
+        return true;
+    }
     HandleResponseCode(code, httpCode);
+    FinishCache(code, httpCode);
     HandleCleanup(status_);
     return code == CURLE_OK;
 }
 
+/**
+ * @brief Download a mirrored file in ranges spread over the url and its mirrors
+ */
+bool DownloadServiceTask::ExecSegmented()
+{
+    uint64_t total = config_.GetExpectedSize();
+    if (total == 0) {
+        if (!GetFileSize(totalSize_)) {
+            return false;
+        }
+        total = totalSize_;
+    }
+    if (total == 0) {
+        DOWNLOAD_HILOGD("Task[%{public}d] size unknown, download from the url only", taskId_);
+        return ExecHttp();
+    }
+    // finished ranges are checkpointed like verified blocks, a retry or a resume only fetches the rest
+    std::string identity = config_.GetUrl();
+    for (const auto &mirror : config_.GetMirrors()) {
+        identity += "\n" + mirror;
+    }
+    DownloadBlockIndex index;
+    index.InitPlain(total, identity);
+    mkdir(CHECKPOINT_DIR, S_IRWXU);
+    DownloadBlockVerifier verifier(index, config_.GetFD(), GetCheckpointPath());
+    if (verifier.LoadCheckpoint()) {
+        totalSize_ = static_cast<int64_t>(total);
+        hasFileSize_ = true;
+        DOWNLOAD_HILOGI("Task[%{public}d] resumes from checkpoint", taskId_);
+    } else if (!PrepareRangedFile(total)) {
+        return false;
+    }
+    return FetchMissing(index, verifier);
+}
+
+/**
+ * @brief Download a file that has a block index. Blocks also found in the base file are copied from it,
+ * only the rest goes over the network.
+ */
+bool DownloadServiceTask::ExecBlocks()
+{
+    DownloadBlockIndex index;
+    CURLSH *share = share_ != nullptr ? share_->GetHandle() : nullptr;
+    switch (index.Load(config_.GetBlockIndex(), MakeHeaderLines(), share)) {
+        case FetchResult::SUCCESS:
+            break;
+
+        case FetchResult::NETWORK_ERROR:
+            SetStatus(SESSION_PENDING);
+            return false;
+
+        default:
+            DOWNLOAD_HILOGW("Task[%{public}d] block index unusable, download the whole file", taskId_);
+            return ExecSegmented();
+    }
+    uint64_t total = index.GetLength();
+    mkdir(CHECKPOINT_DIR, S_IRWXU);
+    DownloadBlockVerifier verifier(index, config_.GetFD(), GetCheckpointPath());
+    if (verifier.LoadCheckpoint()) {
+        totalSize_ = static_cast<int64_t>(total);
+        hasFileSize_ = true;
+        DOWNLOAD_HILOGI("Task[%{public}d] resumes from checkpoint", taskId_);
+    } else {
+        // sizing the target would wipe a base that is the target itself, so read from a private copy
+        int32_t baseFd = IsSameFile(config_.GetBaseFD(), config_.GetFD()) ? StageBaseFile() : config_.GetBaseFD();
+        if (!PrepareRangedFile(total)) {
+            if (baseFd != config_.GetBaseFD() && baseFd >= 0) {
+                close(baseFd);
+            }
+            return false;
+        }
+        uint64_t copied = index.CopyMatches(baseFd, config_.GetFD(), verifier.GetVerified(),
+            [this]() { return forceStop_ || isRemoved_; });
+        if (baseFd != config_.GetBaseFD() && baseFd >= 0) {
+            close(baseFd);
+        }
+        DOWNLOAD_HILOGI("Task[%{public}d] reuses %{public}llu of %{public}llu bytes", taskId_,
+            static_cast<unsigned long long>(copied), static_cast<unsigned long long>(total));
+        if (copied > 0) {
+            verifier.SaveCheckpoint(true);
+        }
+    }
+    return FetchMissing(index, verifier);
+}
+
+/**
+ * @brief Fetch the blocks not verified yet and keep the checkpoint only while the task can still resume
+ */
+bool DownloadServiceTask::FetchMissing(const DownloadBlockIndex &index, DownloadBlockVerifier &verifier)
+{
+    downloadSize_ = static_cast<int64_t>(verifier.GetVerifiedBytes());
+    prevSize_ = downloadSize_;
+    isSingleStream_ = false;
+    bool result = !forceStop_ && !isRemoved_ && FetchRanges(index.GetMissingRanges(verifier.GetVerified()),
+        index.GetLength(), verifier);
+    // after a single stream fallback the file no longer matches the verified blocks
+    if (isRemoved_ || isSingleStream_ || status_ == SESSION_SUCCESS || status_ == SESSION_FAILED) {
+        verifier.RemoveCheckpoint();
+    } else {
+        verifier.SaveCheckpoint(true);
+    }
+    return result;
+}
+
+/**
+ * @brief Copy the base file into an unlinked file owned by the service
+ *
+ * @return the fd of the copy, or -1 when nothing can be reused
+ */
+int32_t DownloadServiceTask::StageBaseFile()
+{
+    std::string path = GetCheckpointPath() + ".base";
+    int32_t fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        DOWNLOAD_HILOGE("Task[%{public}d] failed to stage base file, errno %{public}d", taskId_, errno);
+        return -1;
+    }
+    unlink(path.c_str());
+    std::vector<char> buffer(COALESCE_COPY_BUFFER);
+    off_t offset = 0;
+    ssize_t readLen = 0;
+    while ((readLen = pread(config_.GetBaseFD(), buffer.data(), buffer.size(), offset)) > 0) {
+        if (pwrite(fd, buffer.data(), readLen, offset) != readLen) {
+            break;
+        }
+        offset += readLen;
+    }
+    if (readLen != 0) {
+        DOWNLOAD_HILOGE("Task[%{public}d] failed to copy base file, errno %{public}d", taskId_, errno);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool DownloadServiceTask::PrepareRangedFile(uint64_t total)
+{
+    totalSize_ = static_cast<int64_t>(total);
+    hasFileSize_ = true;
+    downloadSize_ = 0;
+    prevSize_ = 0;
+    // ranges land anywhere in the file, what a resumed task already has comes from its checkpoint
+    if (ftruncate(config_.GetFD(), 0) != 0 || ftruncate(config_.GetFD(), static_cast<off_t>(total)) != 0) {
+        DOWNLOAD_HILOGE("Task[%{public}d] failed to size file, errno %{public}d", taskId_, errno);
+        SetStatus(SESSION_FAILED, ERROR_FILE_ERROR, PAUSED_UNKNOWN);
+        return false;
+    }
+    return true;
+}
+
+bool DownloadServiceTask::FetchRanges(const std::vector<FetchRange> &ranges, uint64_t total,
+    DownloadBlockVerifier &verifier)
+{
+    std::vector<std::string> sources = { config_.GetUrl() };
+    sources.insert(sources.end(), config_.GetMirrors().begin(), config_.GetMirrors().end());
+    DownloadSegmentFetcher fetcher(config_.GetFD(), sources, MakeHeaderLines());
+    if (share_ != nullptr) {
+        fetcher.SetShare(share_->GetHandle());
+    }
+    fetcher.SetStopHook([this]() { return forceStop_ || isRemoved_; });
+    fetcher.SetProgressHook([this](uint64_t bytes) {
+        downloadSize_ += static_cast<int64_t>(bytes);
+        std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+        if (eventCb_ != nullptr && status_ != SESSION_PAUSED) {
+            NotifyProgress();
+            prevSize_ = downloadSize_;
+        }
+    });
+    fetcher.SetWrittenHook([this, &fetcher, &verifier](const FetchRange &written) {
+        std::vector<FetchRange> refetch;
+        verifier.OnWritten(written, refetch);
+        for (const auto &range : refetch) {
+            downloadSize_ -= static_cast<int64_t>(range.length);
+            fetcher.Requeue(range);
+        }
+    });
+    switch (fetcher.Fetch(ranges)) {
+        case FetchResult::SUCCESS:
+            // every byte has to be accounted for by a verified block, a sized file says nothing about its content
+            if (verifier.IsCorrupted() || verifier.GetVerifiedBytes() != total || !VerifyContent(total)) {
+                ftruncate(config_.GetFD(), 0);
+                downloadSize_ = 0;
+                SetStatus(SESSION_FAILED, ERROR_HTTP_DATA_ERROR, PAUSED_UNKNOWN);
+                return false;
+            }
+            SetStatus(SESSION_SUCCESS);
+            HandleCleanup(status_);
+            return true;
+
+        case FetchResult::STOPPED:
+            DOWNLOAD_HILOGD("Task[%{public}d] stopped", taskId_);
+            return false;
+
+        case FetchResult::NETWORK_ERROR:
+            SetStatus(SESSION_PENDING);
+            return false;
+
+        case FetchResult::RANGE_UNSUPPORTED:
+            return FetchSingleStream();
+
+        default:
+            SetStatus(SESSION_FAILED, ERROR_UNHANDLED_HTTP_CODE, PAUSED_UNKNOWN);
+            return false;
+    }
+}
+
+/**
+ * @brief Start over with one plain GET once no source honours Range requests
+ */
+bool DownloadServiceTask::FetchSingleStream()
+{
+    DOWNLOAD_HILOGW("Task[%{public}d] no source supports ranges, download as a single stream", taskId_);
+    if (ftruncate(config_.GetFD(), 0) != 0) {
+        DOWNLOAD_HILOGE("Task[%{public}d] failed to reset file, errno %{public}d", taskId_, errno);
+        SetStatus(SESSION_FAILED, ERROR_FILE_ERROR, PAUSED_UNKNOWN);
+        return false;
+    }
+    isSingleStream_ = true;
+    downloadSize_ = 0;
+    prevSize_ = 0;
+    return ExecHttp();
+}
+
+/**
+ * @brief Check the assembled file against its SHA-256 when one is given
+ */
+bool DownloadServiceTask::VerifyContent(uint64_t size)
+{
+    if (config_.GetChecksum().empty()) {
+        return true;
+    }
+    std::string digest;
+    if (!DownloadSegmentFetcher::HashRange(config_.GetFD(), 0, size, digest) || digest != config_.GetChecksum()) {
+        DOWNLOAD_HILOGE("Task[%{public}d] checksum mismatch", taskId_);
+        return false;
+    }
+    return true;
+}
+
+std::string DownloadServiceTask::GetCheckpointPath()
+{
+    return CHECKPOINT_DIR + std::to_string(taskId_);
+}
+
+std::vector<std::string> DownloadServiceTask::MakeHeaderLines()
+{
+    std::vector<std::string> vec;
+    std::for_each(
+        config_.GetHeader().begin(), config_.GetHeader().end(), [&vec](const std::pair<std::string, std::string> &p) {
+            vec.emplace_back(p.first + HTTP_HEADER_SEPARATOR + p.second);
+        });
+    return vec;
+}
+
 bool DownloadServiceTask::SetFileSizeOption(CURL *curl, struct curl_slist *requestHeader)
 {
     curl_easy_setopt(curl, CURLOPT_URL, config_.GetUrl().c_str());
@@ -544,6 +897,9 @@ bool DownloadServiceTask::SetFileSizeOption(CURL *curl, struct curl_slist *reque
 #endif
 
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if (share_ != nullptr && share_->GetHandle() != nullptr) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share_->GetHandle());
+    }
 #if HTTP_CURL_PRINT_VERBOSE
     curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L, context);
 #endif
@@ -595,6 +951,9 @@ bool DownloadServiceTask::SetOption(CURL *curl, struct curl_slist *requestHeader
 #endif
 
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    if (share_ != nullptr && share_->GetHandle() != nullptr) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share_->GetHandle());
+    }
 #if HTTP_CURL_PRINT_VERBOSE
     curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L, context);
 #endif
@@ -615,12 +974,17 @@ struct curl_slist *DownloadServiceTask::MakeHeaders(const std::vector<std::strin
     return header;
 }
 
+bool DownloadServiceTask::IsRanged(const DownloadConfig &config)
+{
+    return !config.GetMirrors().empty() || !config.GetBlockIndex().empty();
+}
+
 void DownloadServiceTask::SetResumeFromLarge(CURL *curl, long long pos)
 {
     curl_easy_setopt(curl, CURLOPT_RESUME_FROM_LARGE, pos);
 }
 
-bool DownloadServiceTask::GetFileSize(uint32_t &result)
+bool DownloadServiceTask::GetFileSize(int64_t &result)
 {
     if (hasFileSize_) {
         DOWNLOAD_HILOGD("Already get file size");
@@ -634,12 +998,8 @@ bool DownloadServiceTask::GetFileSize(uint32_t &result)
         return false;
     }
 
-    std::vector<std::string> vec;
-    std::for_each(
-        config_.GetHeader().begin(), config_.GetHeader().end(), [&vec](const std::pair<std::string, std::string> &p) {
-            vec.emplace_back(p.first + HTTP_HEADER_SEPARATOR + p.second);
-        });
-    std::unique_ptr<struct curl_slist, decltype(&curl_slist_free_all)> header(MakeHeaders(vec), curl_slist_free_all);
+    std::unique_ptr<struct curl_slist, decltype(&curl_slist_free_all)> header(MakeHeaders(MakeHeaderLines()),
+        curl_slist_free_all);
 
     if (!SetFileSizeOption(handle.get(), header.get())) {
         DOWNLOAD_HILOGD("set option failed");
@@ -651,10 +1011,8 @@ bool DownloadServiceTask::GetFileSize(uint32_t &result)
     curl_easy_getinfo(handle.get(), CURLINFO_CONTENT_LENGTH_DOWNLOAD, &size);
     
     if (code == CURLE_OK) {
-        result = static_cast<long long>(size);
-        if (result == static_cast<uint32_t>(-1)) {
-            result = 0;
-        }
+        // an unknown length is reported as -1
+        result = size > 0 ? static_cast<int64_t>(size) : 0;
         hasFileSize_ = true;
         DOWNLOAD_HILOGD("Has got file size");
     } else {
@@ -663,7 +1021,7 @@ bool DownloadServiceTask::GetFileSize(uint32_t &result)
         }
     }
 
-    DOWNLOAD_HILOGD("fetch file size %{public}d", result);
+    DOWNLOAD_HILOGD("fetch file size %{public}lld", static_cast<long long>(result));
     return hasFileSize_;
 }
 
@@ -739,13 +1097,19 @@ void DownloadServiceTask::ForceStopRunning()
 void DownloadServiceTask::HandleCleanup(DownloadStatus status)
 {
     switch (status) {
-        case SESSION_SUCCESS:
-            // rename download to target file name
+        case SESSION_SUCCESS: {
+            // a follower may still be copying the body out of this fd
+            std::lock_guard<std::mutex> autoLock(followerMutex_);
             if (config_.GetFD() > 0) {
                 close(config_.GetFD());
                 config_.SetFD(-1);
             }
+            if (config_.GetBaseFD() >= 0) {
+                close(config_.GetBaseFD());
+                config_.SetBaseFD(-1);
+            }
             break;
+        }
 
         case SESSION_FAILED:
             break;
@@ -755,6 +1119,215 @@ void DownloadServiceTask::HandleCleanup(DownloadStatus status)
     }
 }
 
+/**
+ * @brief Look up the url in the local cache before going to the network
+ *
+ * @return true if the task was completed from a fresh cache entry
+ */
+bool DownloadServiceTask::PrepareCache()
+{
+    if (!config_.GetCacheable() || IsRanged(config_) || config_.GetFD() <= 0 ||
+        lseek(config_.GetFD(), 0, SEEK_END) != 0) {
+        return false;
+    }
+    hasCacheEntry_ = DownloadCache::GetInstance().Lookup(config_.GetUrl(), config_.GetHeader(), cacheEntry_);
+    if (!hasCacheEntry_) {
+        return false;
+    }
+    if (DownloadCache::GetInstance().IsFresh(cacheEntry_)) {
+        DOWNLOAD_HILOGD("Task[%{public}d] served by fresh cache entry", taskId_);
+        return ServeFromCache();
+    }
+    // the conditional GET reports the size of a changed body itself, no HEAD request needed
+    totalSize_ = static_cast<int64_t>(cacheEntry_.size);
+    hasFileSize_ = true;
+    return false;
+}
+
+bool DownloadServiceTask::ServeFromCache()
+{
+    if (!DownloadCache::GetInstance().CopyTo(cacheEntry_, config_.GetFD())) {
+        // let the next attempt download the body again
+        hasCacheEntry_ = false;
+        hasFileSize_ = false;
+        ftruncate(config_.GetFD(), 0);
+        return false;
+    }
+    totalSize_ = static_cast<int64_t>(cacheEntry_.size);
+    downloadSize_ = totalSize_;
+    mimeType_ = cacheEntry_.mimeType;
+    {
+        // the body never went through WriteCallback, hand it to the followers from the cache as well
+        std::lock_guard<std::mutex> autoLock(followerMutex_);
+        for (auto it = followers_.begin(); it != followers_.end();) {
+            auto &follower = *it;
+            int32_t fd = follower->config_.GetFD();
+            if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0 ||
+                !DownloadCache::GetInstance().CopyTo(cacheEntry_, fd)) {
+                follower->isFollower_ = false;
+                follower->SetStatus(SESSION_FAILED, ERROR_FILE_ERROR, PAUSED_UNKNOWN);
+                it = followers_.erase(it);
+                continue;
+            }
+            follower->downloadSize_ = downloadSize_;
+            follower->totalSize_ = totalSize_;
+            ++it;
+        }
+    }
+    if (eventCb_ != nullptr) {
+        eventCb_("progress", taskId_, ToEventSize(downloadSize_), ToEventSize(totalSize_));
+    }
+    SetStatus(SESSION_SUCCESS);
+    HandleCleanup(status_);
+    return true;
+}
+
+void DownloadServiceTask::FinishCache(CURLcode code, int32_t httpCode)
+{
+    if (!cacheWriter_.IsOpen()) {
+        return;
+    }
+    if (code == CURLE_OK && httpCode == HTTP_OK && status_ == SESSION_SUCCESS) {
+        cacheWriter_.Commit(config_.GetUrl(), config_.GetHeader(), responseCache_, mimeType_);
+    } else {
+        cacheWriter_.Abort();
+    }
+}
+
+/**
+ * @brief Whether a new request with config can share the transfer of this task
+ */
+bool DownloadServiceTask::CanLead(const DownloadConfig &config)
+{
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    // a ranged transfer writes out of order, there is no prefix to hand over
+    if (isFollower_ || isRemoved_ || forceStop_ || IsRanged(config_) || IsRanged(config)) {
+        return false;
+    }
+    // a task that has not started yet may hold bytes in its file that downloadSize_ does not count
+    if (status_ != SESSION_RUNNING) {
+        return false;
+    }
+    return config_.GetUrl() == config.GetUrl() && config_.GetHeader() == config.GetHeader() &&
+        config_.GetFD() > 0;
+}
+
+/**
+ * @brief Let follower receive the body of this transfer. The part already written is copied first.
+ */
+bool DownloadServiceTask::AttachFollower(std::shared_ptr<DownloadServiceTask> follower)
+{
+    if (follower == nullptr || follower->config_.GetFD() <= 0) {
+        return false;
+    }
+    std::lock_guard<std::mutex> autoLock(followerMutex_);
+    // only while the body streams does the file end exactly at downloadSize_
+    if (!isStreaming_ || config_.GetFD() <= 0 || ftruncate(follower->config_.GetFD(), 0) != 0 ||
+        !CopyPrefixTo(follower->config_.GetFD())) {
+        DOWNLOAD_HILOGE("Task[%{public}d] failed to join task[%{public}d]", follower->taskId_, taskId_);
+        return false;
+    }
+    follower->isFollower_ = true;
+    follower->downloadSize_ = downloadSize_;
+    follower->totalSize_ = totalSize_;
+    follower->hasFileSize_ = hasFileSize_;
+    follower->SetStatus(SESSION_RUNNING);
+    followers_.push_back(follower);
+    DOWNLOAD_HILOGD("Task[%{public}d] follows task[%{public}d]", follower->taskId_, taskId_);
+    return true;
+}
+
+bool DownloadServiceTask::CopyPrefixTo(int32_t fd)
+{
+    // the caller holds followerMutex_, so no chunk is in flight and the file has to end at downloadSize_
+    struct stat fileStat = {};
+    if (fstat(config_.GetFD(), &fileStat) != 0 || static_cast<int64_t>(fileStat.st_size) != downloadSize_) {
+        DOWNLOAD_HILOGE("Task[%{public}d] file does not match its progress, no prefix to hand over", taskId_);
+        return false;
+    }
+    std::vector<char> buffer(COALESCE_COPY_BUFFER);
+    off_t offset = 0;
+    while (offset < static_cast<off_t>(downloadSize_)) {
+        size_t len = std::min(buffer.size(), static_cast<size_t>(downloadSize_ - offset));
+        ssize_t readLen = pread(config_.GetFD(), buffer.data(), len, offset);
+        if (readLen <= 0 || pwrite(fd, buffer.data(), readLen, offset) != readLen) {
+            return false;
+        }
+        offset += readLen;
+    }
+    lseek(fd, 0, SEEK_END);
+    return true;
+}
+
+bool DownloadServiceTask::DropFollower(uint32_t taskId)
+{
+    std::lock_guard<std::mutex> autoLock(followerMutex_);
+    auto it = std::find_if(followers_.begin(), followers_.end(),
+        [taskId](const std::shared_ptr<DownloadServiceTask> &follower) { return follower->taskId_ == taskId; });
+    if (it == followers_.end()) {
+        return false;
+    }
+    (*it)->isFollower_ = false;
+    followers_.erase(it);
+    return true;
+}
+
+std::vector<std::shared_ptr<DownloadServiceTask>> DownloadServiceTask::DetachFollowers()
+{
+    std::lock_guard<std::mutex> autoLock(followerMutex_);
+    std::vector<std::shared_ptr<DownloadServiceTask>> followers;
+    followers.swap(followers_);
+    return followers;
+}
+
+/**
+ * @brief Settle a follower once its leader stopped. A follower whose leader did not succeed is reset
+ * so it can be queued and resume from the part it already holds.
+ */
+void DownloadServiceTask::FinishFollowing(bool leaderSucceeded, const std::string &mimeType)
+{
+    isFollower_ = false;
+    if (leaderSucceeded) {
+        mimeType_ = mimeType;
+        SetStatus(SESSION_SUCCESS);
+        HandleCleanup(status_);
+        return;
+    }
+    std::lock_guard<std::recursive_mutex> autoLock(mutex_);
+    if (status_ == SESSION_RUNNING) {
+        status_ = SESSION_UNKNOWN;
+    }
+}
+
+void DownloadServiceTask::FanOut(const void *buffer, size_t len)
+{
+    for (auto it = followers_.begin(); it != followers_.end();) {
+        auto &follower = *it;
+        if (write(follower->config_.GetFD(), buffer, len) != static_cast<ssize_t>(len)) {
+            DOWNLOAD_HILOGE("Task[%{public}d] write failed, errno %{public}d", follower->taskId_, errno);
+            follower->isFollower_ = false;
+            follower->SetStatus(SESSION_FAILED, ERROR_FILE_ERROR, PAUSED_UNKNOWN);
+            it = followers_.erase(it);
+            continue;
+        }
+        follower->downloadSize_ += static_cast<int64_t>(len);
+        ++it;
+    }
+}
+
+void DownloadServiceTask::NotifyProgress()
+{
+    eventCb_("progress", taskId_, ToEventSize(downloadSize_), ToEventSize(totalSize_));
+    std::lock_guard<std::mutex> autoLock(followerMutex_);
+    for (auto &follower : followers_) {
+        follower->totalSize_ = totalSize_;
+        if (follower->eventCb_ != nullptr) {
+            follower->eventCb_("progress", follower->taskId_, ToEventSize(follower->downloadSize_),
+                ToEventSize(follower->totalSize_));
+        }
+    }
+}
+
 bool DownloadServiceTask::HandleFileError()
 {
     ErrorCode code = ERROR_UNKNOWN;
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <openssl/sha.h>
+
+#include "download_block_index.h"
+#include "download_cache.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Download {
+constexpr const char *INDEX_TEST_FILE = "/data/download_block_index_test.bin";
+constexpr const char *INDEX_TEST_BASE = "/data/download_block_index_test.base";
+constexpr const char *INDEX_TEST_CHECKPOINT = "/data/download_block_index_test.checkpoint";
+constexpr uint64_t INDEX_TEST_BLOCK = 512;
+constexpr size_t INDEX_TEST_SHIFT = 100;
+constexpr uint32_t INDEX_TEST_MAX_RETRIES = 3;
+
+class DownloadBlockIndexTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+
+    static std::string MakeContent(size_t len, unsigned seed);
+    static std::string MakeIndex(const std::string &content, uint64_t blockSize);
+    static int32_t WriteFile(const char *path, const std::string &content);
+    static std::string ReadFile(int32_t fd, uint64_t offset, uint64_t length);
+};
+
+void DownloadBlockIndexTest::SetUpTestCase(void)
+{
+}
+
+void DownloadBlockIndexTest::TearDownTestCase(void)
+{
+}
+
+void DownloadBlockIndexTest::SetUp()
+{
+}
+
+void DownloadBlockIndexTest::TearDown()
+{
+    unlink(INDEX_TEST_FILE);
+    unlink(INDEX_TEST_BASE);
+    unlink(INDEX_TEST_CHECKPOINT);
+}
+
+std::string DownloadBlockIndexTest::MakeContent(size_t len, unsigned seed)
+{
+    std::string content(len, '\0');
+    uint32_t state = seed * 2654435761u + 1;
+    for (auto &c : content) {
+        state = state * 1103515245u + 12345u;
+        c = static_cast<char>(state >> 24);
+    }
+    return content;
+}
+
+std::string DownloadBlockIndexTest::MakeIndex(const std::string &content, uint64_t blockSize)
+{
+    std::ostringstream out;
+    out << "blockindex 1\nlength " << content.size() << "\nblocksize " << blockSize << "\n";
+    for (uint64_t offset = 0; offset < content.size(); offset += blockSize) {
+        size_t len = std::min<uint64_t>(blockSize, content.size() - offset);
+        const unsigned char *data = reinterpret_cast<const unsigned char *>(content.data()) + offset;
+        unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+        SHA256(data, len, digest);
+        char weak[9] = { 0 };
+        snprintf(weak, sizeof(weak), "%08x", DownloadBlockIndex::WeakSum(data, len));
+        out << weak << " " << DownloadCache::ToHex(digest, sizeof(digest)) << "\n";
+    }
+    return out.str();
+}
+
+int32_t DownloadBlockIndexTest::WriteFile(const char *path, const std::string &content)
+{
+    int32_t fd = open(path, O_RDWR | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+    if (fd >= 0 && pwrite(fd, content.data(), content.size(), 0) != static_cast<ssize_t>(content.size())) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+std::string DownloadBlockIndexTest::ReadFile(int32_t fd, uint64_t offset, uint64_t length)
+{
+    std::string content(length, '\0');
+    ssize_t len = pread(fd, &content[0], length, offset);
+    content.resize(len < 0 ? 0 : static_cast<size_t>(len));
+    return content;
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_001
+ * @tc.desc: rolling the weak sum one byte at a time gives the sum computed from scratch at every offset
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_001, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 4, 1);
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(content.data());
+    uint32_t sum = DownloadBlockIndex::WeakSum(data, INDEX_TEST_BLOCK);
+    for (size_t pos = 1; pos + INDEX_TEST_BLOCK <= content.size(); pos++) {
+        sum = DownloadBlockIndex::RollWeakSum(sum, data[pos - 1], data[pos - 1 + INDEX_TEST_BLOCK], INDEX_TEST_BLOCK);
+        ASSERT_EQ(sum, DownloadBlockIndex::WeakSum(data + pos, INDEX_TEST_BLOCK)) << "offset " << pos;
+    }
+    std::string same(INDEX_TEST_BLOCK, '\xff');
+    const unsigned char *ones = reinterpret_cast<const unsigned char *>(same.data());
+    EXPECT_EQ(DownloadBlockIndex::RollWeakSum(DownloadBlockIndex::WeakSum(ones, INDEX_TEST_BLOCK), 0xff, 0xff,
+        INDEX_TEST_BLOCK), DownloadBlockIndex::WeakSum(ones, INDEX_TEST_BLOCK));
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_002
+ * @tc.desc: a well formed index is parsed into its blocks, the last one being short
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_002, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 3 + 7, 2);
+    std::string text = MakeIndex(content, INDEX_TEST_BLOCK);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(text));
+    EXPECT_EQ(index.GetLength(), content.size());
+    EXPECT_EQ(index.GetBlockCount(), 4);
+    EXPECT_EQ(index.GetBlock(3).offset, INDEX_TEST_BLOCK * 3);
+    EXPECT_EQ(index.GetBlock(3).length, 7);
+    unsigned char digest[SHA256_DIGEST_LENGTH] = { 0 };
+    SHA256(reinterpret_cast<const unsigned char *>(content.data()) + INDEX_TEST_BLOCK, INDEX_TEST_BLOCK, digest);
+    EXPECT_EQ(index.GetDigest(1), DownloadCache::ToHex(digest, sizeof(digest)));
+
+    DownloadBlockIndex other;
+    ASSERT_TRUE(other.Parse(MakeIndex(MakeContent(content.size(), 3), INDEX_TEST_BLOCK)));
+    EXPECT_NE(index.GetIndexDigest(), other.GetIndexDigest());
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_003
+ * @tc.desc: bad headers, block sizes out of range, counts the text cannot hold and bad digests are rejected
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_003, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 2, 4);
+    std::string valid = MakeIndex(content, INDEX_TEST_BLOCK);
+    std::string body = valid.substr(valid.find("length"));
+    DownloadBlockIndex index;
+    EXPECT_FALSE(index.Parse(""));
+    EXPECT_FALSE(index.Parse("blockindex\n"));
+    EXPECT_FALSE(index.Parse("blocklist 1\n" + body));
+    EXPECT_FALSE(index.Parse("blockindex 2\n" + body));
+    EXPECT_FALSE(index.Parse("blockindex 1\nsize 1024\nblocksize 512\n"));
+    EXPECT_FALSE(index.Parse("blockindex 1\nlength 1024\nblock 512\n"));
+    EXPECT_FALSE(index.Parse(MakeIndex(MakeContent(1024, 5), 256)));
+    EXPECT_FALSE(index.Parse("blockindex 1\nlength 1024\nblocksize 134217728\n"));
+    // a huge length is rejected before anything is allocated for it
+    EXPECT_FALSE(index.Parse("blockindex 1\nlength 1099511627776\nblocksize 512\n"));
+    EXPECT_EQ(index.GetBlockCount(), 0);
+
+    std::string truncated = valid.substr(0, valid.rfind('\n', valid.size() - 2) + 1);
+    EXPECT_FALSE(index.Parse(truncated));
+    std::string shortDigest = valid;
+    shortDigest.erase(shortDigest.size() - 2, 1);
+    EXPECT_FALSE(index.Parse(shortDigest));
+    std::string badWeak = valid;
+    badWeak.replace(badWeak.find("blocksize 512\n") + 14, 8, "zzzzzzzz");
+    EXPECT_FALSE(index.Parse(badWeak));
+    EXPECT_EQ(index.GetBlockCount(), 0);
+    EXPECT_TRUE(index.Parse(valid));
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_004
+ * @tc.desc: blocks of a base shifted by a few bytes are found at their new offset and copied into place
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_004, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 4, 6);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    int32_t baseFd = WriteFile(INDEX_TEST_BASE, MakeContent(INDEX_TEST_SHIFT, 7) + content);
+    int32_t fd = WriteFile(INDEX_TEST_FILE, std::string(content.size(), '\0'));
+    ASSERT_TRUE(baseFd >= 0 && fd >= 0);
+
+    std::vector<bool> present(index.GetBlockCount(), false);
+    EXPECT_EQ(index.CopyMatches(baseFd, fd, present, nullptr), content.size());
+    EXPECT_EQ(present, std::vector<bool>(index.GetBlockCount(), true));
+    EXPECT_EQ(ReadFile(fd, 0, content.size()), content);
+    EXPECT_TRUE(index.GetMissingRanges(present).empty());
+    close(baseFd);
+    close(fd);
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_005
+ * @tc.desc: only the unchanged blocks of a partly edited base are copied, blocks already present are skipped
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_005, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 4, 8);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    std::string base = content;
+    base[INDEX_TEST_BLOCK + 1] ^= 0x5a;
+    base.insert(INDEX_TEST_BLOCK * 3, "inserted");
+    int32_t baseFd = WriteFile(INDEX_TEST_BASE, base);
+    int32_t fd = WriteFile(INDEX_TEST_FILE, std::string(content.size(), '\0'));
+    ASSERT_TRUE(baseFd >= 0 && fd >= 0);
+
+    std::vector<bool> present = { false, false, true, false };
+    EXPECT_EQ(index.CopyMatches(baseFd, fd, present, nullptr), INDEX_TEST_BLOCK * 2);
+    EXPECT_EQ(present, std::vector<bool>({ true, false, true, true }));
+    EXPECT_EQ(ReadFile(fd, 0, INDEX_TEST_BLOCK), content.substr(0, INDEX_TEST_BLOCK));
+    EXPECT_EQ(ReadFile(fd, INDEX_TEST_BLOCK * 2, INDEX_TEST_BLOCK), std::string(INDEX_TEST_BLOCK, '\0'));
+    EXPECT_EQ(ReadFile(fd, INDEX_TEST_BLOCK * 3, INDEX_TEST_BLOCK), content.substr(INDEX_TEST_BLOCK * 3));
+
+    std::vector<bool> none(index.GetBlockCount(), false);
+    EXPECT_EQ(index.CopyMatches(-1, fd, none, nullptr), 0);
+    EXPECT_EQ(index.CopyMatches(baseFd, fd, none, nullptr), INDEX_TEST_BLOCK * 3);
+    EXPECT_EQ(none, std::vector<bool>({ true, false, true, true }));
+    close(baseFd);
+    close(fd);
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_006
+ * @tc.desc: missing blocks next to each other are coalesced into one range, the short last block included
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_006, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 5 + 3, 9);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    std::vector<FetchRange> ranges = index.GetMissingRanges({ true, false, false, true, false, false });
+    ASSERT_EQ(ranges.size(), 2);
+    EXPECT_EQ(ranges[0].offset, INDEX_TEST_BLOCK);
+    EXPECT_EQ(ranges[0].length, INDEX_TEST_BLOCK * 2);
+    EXPECT_EQ(ranges[1].offset, INDEX_TEST_BLOCK * 4);
+    EXPECT_EQ(ranges[1].length, INDEX_TEST_BLOCK + 3);
+
+    ranges = index.GetMissingRanges(std::vector<bool>(index.GetBlockCount(), false));
+    ASSERT_EQ(ranges.size(), 1);
+    EXPECT_EQ(ranges[0].offset, 0);
+    EXPECT_EQ(ranges[0].length, content.size());
+    EXPECT_TRUE(index.GetMissingRanges(std::vector<bool>(index.GetBlockCount(), true)).empty());
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_007
+ * @tc.desc: a block is verified once writes spread over several ranges have covered all of it
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_007, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 3, 10);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    int32_t fd = WriteFile(INDEX_TEST_FILE, content);
+    ASSERT_TRUE(fd >= 0);
+    DownloadBlockVerifier verifier(index, fd, "");
+    std::vector<FetchRange> refetch;
+
+    verifier.OnWritten({ 0, INDEX_TEST_BLOCK - 1 }, refetch);
+    EXPECT_EQ(verifier.GetVerifiedBytes(), 0);
+    // the range ends in the middle of the second block and completes only the first one
+    verifier.OnWritten({ INDEX_TEST_BLOCK - 1, INDEX_TEST_BLOCK }, refetch);
+    EXPECT_EQ(verifier.GetVerified(), std::vector<bool>({ true, false, false }));
+    verifier.OnWritten({ INDEX_TEST_BLOCK * 2 - 1, INDEX_TEST_BLOCK + 1 }, refetch);
+    EXPECT_EQ(verifier.GetVerified(), std::vector<bool>({ true, true, true }));
+    EXPECT_EQ(verifier.GetVerifiedBytes(), content.size());
+    EXPECT_TRUE(refetch.empty());
+    EXPECT_FALSE(verifier.IsCorrupted());
+    close(fd);
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_008
+ * @tc.desc: a corrupted block is asked for again until it verifies, one that keeps failing marks the file corrupted
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_008, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 2, 11);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    std::string corrupted = content;
+    corrupted[INDEX_TEST_BLOCK + 5] ^= 0x01;
+    int32_t fd = WriteFile(INDEX_TEST_FILE, corrupted);
+    ASSERT_TRUE(fd >= 0);
+    DownloadBlockVerifier verifier(index, fd, "");
+
+    std::vector<FetchRange> refetch;
+    verifier.OnWritten({ 0, content.size() }, refetch);
+    ASSERT_EQ(refetch.size(), 1);
+    EXPECT_EQ(refetch[0].offset, INDEX_TEST_BLOCK);
+    EXPECT_EQ(refetch[0].length, INDEX_TEST_BLOCK);
+    EXPECT_EQ(verifier.GetVerified(), std::vector<bool>({ true, false }));
+
+    ASSERT_EQ(pwrite(fd, content.data() + INDEX_TEST_BLOCK, INDEX_TEST_BLOCK, INDEX_TEST_BLOCK),
+        static_cast<ssize_t>(INDEX_TEST_BLOCK));
+    refetch.clear();
+    verifier.OnWritten({ INDEX_TEST_BLOCK, INDEX_TEST_BLOCK }, refetch);
+    EXPECT_TRUE(refetch.empty());
+    EXPECT_EQ(verifier.GetVerifiedBytes(), content.size());
+    EXPECT_FALSE(verifier.IsCorrupted());
+
+    DownloadBlockVerifier failing(index, fd, "");
+    ASSERT_EQ(pwrite(fd, corrupted.data(), corrupted.size(), 0), static_cast<ssize_t>(corrupted.size()));
+    for (uint32_t i = 0; i <= INDEX_TEST_MAX_RETRIES; i++) {
+        refetch.clear();
+        failing.OnWritten({ INDEX_TEST_BLOCK, INDEX_TEST_BLOCK }, refetch);
+        EXPECT_EQ(refetch.size(), i < INDEX_TEST_MAX_RETRIES ? 1 : 0);
+    }
+    EXPECT_TRUE(failing.IsCorrupted());
+    close(fd);
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_009
+ * @tc.desc: a checkpoint restores the verified blocks, unless the index or the file size changed
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_009, TestSize.Level1)
+{
+    std::string content = MakeContent(INDEX_TEST_BLOCK * 3, 12);
+    DownloadBlockIndex index;
+    ASSERT_TRUE(index.Parse(MakeIndex(content, INDEX_TEST_BLOCK)));
+    int32_t fd = WriteFile(INDEX_TEST_FILE, content);
+    ASSERT_TRUE(fd >= 0);
+    {
+        DownloadBlockVerifier verifier(index, fd, INDEX_TEST_CHECKPOINT);
+        EXPECT_FALSE(verifier.LoadCheckpoint());
+        std::vector<FetchRange> refetch;
+        verifier.OnWritten({ INDEX_TEST_BLOCK * 2, INDEX_TEST_BLOCK }, refetch);
+        verifier.SaveCheckpoint(true);
+    }
+    DownloadBlockVerifier restored(index, fd, INDEX_TEST_CHECKPOINT);
+    ASSERT_TRUE(restored.LoadCheckpoint());
+    EXPECT_EQ(restored.GetVerified(), std::vector<bool>({ false, false, true }));
+    EXPECT_EQ(restored.GetVerifiedBytes(), INDEX_TEST_BLOCK);
+
+    std::string changed = content;
+    changed[0] ^= 0x01;
+    DownloadBlockIndex other;
+    ASSERT_TRUE(other.Parse(MakeIndex(changed, INDEX_TEST_BLOCK)));
+    DownloadBlockVerifier otherIndex(other, fd, INDEX_TEST_CHECKPOINT);
+    EXPECT_FALSE(otherIndex.LoadCheckpoint());
+
+    ASSERT_EQ(ftruncate(fd, INDEX_TEST_BLOCK), 0);
+    DownloadBlockVerifier resized(index, fd, INDEX_TEST_CHECKPOINT);
+    EXPECT_FALSE(resized.LoadCheckpoint());
+
+    ASSERT_EQ(ftruncate(fd, content.size()), 0);
+    resized.RemoveCheckpoint();
+    EXPECT_FALSE(resized.LoadCheckpoint());
+    close(fd);
+}
+
+/**
+ * @tc.name: DownloadBlockIndexTest_010
+ * @tc.desc: blocks of a plain index complete once their bytes are written, its identity keys the checkpoint
+ * @tc.type: FUNC
+ */
+HWTEST_F(DownloadBlockIndexTest, DownloadBlockIndexTest_010, TestSize.Level1)
+{
+    constexpr uint64_t plainBlock = 1024 * 1024;
+    uint64_t length = plainBlock * 2 + 10;
+    int32_t fd = WriteFile(INDEX_TEST_FILE, "");
+    ASSERT_TRUE(fd >= 0 && ftruncate(fd, length) == 0);
+    DownloadBlockIndex index;
+    index.InitPlain(length, "http://127.0.0.1/file");
+    ASSERT_EQ(index.GetBlockCount(), 3);
+    EXPECT_EQ(index.GetBlock(2).length, 10);
+    {
+        DownloadBlockVerifier verifier(index, fd, INDEX_TEST_CHECKPOINT);
+        std::vector<FetchRange> refetch;
+        verifier.OnWritten({ 0, plainBlock + 1 }, refetch);
+        verifier.OnWritten({ plainBlock * 2, 10 }, refetch);
+        EXPECT_TRUE(refetch.empty());
+        EXPECT_EQ(verifier.GetVerified(), std::vector<bool>({ true, false, true }));
+        verifier.SaveCheckpoint(true);
+    }
+    DownloadBlockVerifier restored(index, fd, INDEX_TEST_CHECKPOINT);
+    ASSERT_TRUE(restored.LoadCheckpoint());
+    std::vector<FetchRange> ranges = index.GetMissingRanges(restored.GetVerified());
+    ASSERT_EQ(ranges.size(), 1);
+    EXPECT_EQ(ranges[0].offset, plainBlock);
+    EXPECT_EQ(ranges[0].length, plainBlock);
+
+    DownloadBlockIndex mirrored;
+    mirrored.InitPlain(length, "http://127.0.0.1/file\nhttp://127.0.0.2/file");
+    DownloadBlockVerifier other(mirrored, fd, INDEX_TEST_CHECKPOINT);
+    EXPECT_FALSE(other.LoadCheckpoint());
+    close(fd);
+}
+} // namespace OHOS::Request::Download
@@ -16,6 +16,8 @@
 #ifndef CONSTANT_H
 #define CONSTANT_H
 
+#include <cstdint>
+
 namespace OHOS::Request::Download {
 enum NetworkType {
     NETWORK_MOBILE = 0x00000001,
@@ -52,11 +54,19 @@ enum DownloadStatus {
     SESSION_UNKNOWN,
 };
 
+enum DownloadActionType {
+    DOWNLOAD_ACTION_PAUSE,
+    DOWNLOAD_ACTION_RESUME,
+    DOWNLOAD_ACTION_REMOVE,
+};
+
 enum HttpErrorCode {
     HTTP_OK = 200,
     HTTP_PARIAL_FILE = 206,
+    HTTP_NOT_MODIFIED = 304,
 };
 
+const uint32_t DOWNLOAD_MAX_MIRRORS = 8;
 const uint32_t DEFAULT_READ_TIMEOUT = 60;
 const uint32_t DEFAULT_CONNECT_TIMEOUT = 60;
 const uint32_t HTTP_FORCE_STOP = 1;
@@ -89,6 +99,15 @@ static constexpr int TRANSACTION_COUNT = 100;
 
 constexpr int DOWNLOAD_INFO = 10000;
 
+constexpr int QUERY_DEFAULT_PAGE_SIZE = 100;
+constexpr int QUERY_MAX_ROWS = 1000;
+
+constexpr int64_t RETENTION_MAX_AGE_SECONDS = 30 * 24 * 60 * 60;
+constexpr int64_t RETENTION_MAX_ROWS = 5000;
+constexpr int RETENTION_BATCH_SIZE = 200;
+constexpr int RETENTION_INTERVAL_SECONDS = 6 * 60 * 60;
+constexpr int RETENTION_VACUUM_PAGES = 256;
+
 constexpr int REQUEST_PARAMS_NUM = 2;
 } // namespace OHOS::Request::Download
 
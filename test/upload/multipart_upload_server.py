@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+# Copyright (c) 2022 Huawei Device Co., Ltd.
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""Local stand-in for an S3 style multipart upload endpoint, used to try the partSize upload mode.
+
+    POST <path>?uploads                     starts an upload, answers <UploadId>
+    PUT  <path>?partNumber=N&uploadId=ID    stores one part, answers its ETag
+    POST <path>?uploadId=ID                 joins the parts listed in the body into <dir>/<path>
+    DELETE <path>?uploadId=ID               aborts the upload and drops its parts
+
+--fail-rate makes that share of the part requests answer 500 so the retries can be watched.
+"""
+
+import argparse
+import hashlib
+import os
+import random
+import re
+import threading
+import uuid
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from urllib.parse import parse_qs, urlparse
+
+uploads = {}
+lock = threading.Lock()
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = 'HTTP/1.1'
+    server_version = 'MultipartStandIn'
+    sys_version = ''
+
+    def reply(self, code, body=b'', headers=None):
+        self.send_response(code)
+        for name, value in (headers or {}).items():
+            self.send_header(name, value)
+        self.send_header('Content-Length', str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def read_body(self):
+        return self.rfile.read(int(self.headers.get('Content-Length', 0)))
+
+    def do_PUT(self):
+        query = parse_qs(urlparse(self.path).query)
+        data = self.read_body()
+        upload_id = query.get('uploadId', [''])[0]
+        with lock:
+            parts = uploads.get(upload_id)
+        if parts is None or 'partNumber' not in query:
+            self.reply(404, b'<Error><Code>NoSuchUpload</Code></Error>')
+            return
+        if random.random() < self.server.fail_rate:
+            self.reply(500, b'<Error><Code>InternalError</Code></Error>')
+            return
+        etag = '"%s"' % hashlib.md5(data).hexdigest()
+        with lock:
+            parts[int(query['partNumber'][0])] = (etag, data)
+        self.reply(200, headers={'ETag': etag})
+
+    def do_POST(self):
+        url = urlparse(self.path)
+        query = parse_qs(url.query, keep_blank_values=True)
+        body = self.read_body()
+        if 'uploads' in query:
+            upload_id = uuid.uuid4().hex
+            with lock:
+                uploads[upload_id] = {}
+            self.reply(200, ('<InitiateMultipartUploadResult><UploadId>%s</UploadId>'
+                             '</InitiateMultipartUploadResult>' % upload_id).encode())
+            return
+        upload_id = query.get('uploadId', [''])[0]
+        with lock:
+            parts = uploads.pop(upload_id, None)
+        if parts is None:
+            self.reply(404, b'<Error><Code>NoSuchUpload</Code></Error>')
+            return
+        listed = re.findall(r'<PartNumber>(\d+)</PartNumber><ETag>([^<]*)</ETag>', body.decode())
+        if not listed or any(parts.get(int(number), ('', b''))[0] != etag for number, etag in listed):
+            self.reply(400, b'<Error><Code>InvalidPart</Code></Error>')
+            return
+        target = os.path.join(self.server.dir, os.path.basename(url.path) or 'upload.bin')
+        with open(target, 'wb') as out:
+            for number, _ in listed:
+                out.write(parts[int(number)][1])
+        self.reply(200, b'<CompleteMultipartUploadResult><Key>%s</Key></CompleteMultipartUploadResult>'
+                   % os.path.basename(target).encode())
+
+    def do_DELETE(self):
+        upload_id = parse_qs(urlparse(self.path).query).get('uploadId', [''])[0]
+        with lock:
+            parts = uploads.pop(upload_id, None)
+        if parts is None:
+            self.reply(404, b'<Error><Code>NoSuchUpload</Code></Error>')
+            return
+        print('aborted %s, dropped %d parts' % (upload_id, len(parts)), flush=True)
+        self.reply(204)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--dir', default='.')
+    parser.add_argument('--fail-rate', type=float, default=0.0)
+    args = parser.parse_args()
+    server = ThreadingHTTPServer(('127.0.0.1', args.port), Handler)
+    server.dir = args.dir
+    server.fail_rate = args.fail_rate
+    server.serve_forever()
+
+
+if __name__ == '__main__':
+    main()
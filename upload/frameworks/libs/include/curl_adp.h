@@ -16,6 +16,9 @@
 #ifndef CURLADP_H
 #define CURLADP_H
 
+#include <atomic>
+#include <list>
+#include <memory>
 #include <vector>
 #include <mutex>
 #include "curl/curl.h"
@@ -23,7 +26,11 @@
 #include "upload_common.h"
 #include "upload_config.h"
 #include "i_upload_task.h"
-#include "upload_timer_info.h"
+#include "upload_compressor.h"
+#include "upload_file_reader.h"
+#include "upload_parts.h"
+#include "upload_resumable.h"
+#include "upload_watchdog.h"
 
 namespace OHOS::Request::Upload {
 class CUrlAdp {
@@ -44,35 +51,67 @@ protected:
         curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
     static size_t HeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata);
     static size_t HeaderCallbackL5(char *buffer, size_t size, size_t nitems, void *userdata);
+    static size_t ResumableHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata);
     static size_t ReadCallback(char *buffer, size_t size, size_t nitems, void *arg);
+    static size_t MimeReadCallback(char *buffer, size_t size, size_t nitems, void *arg);
+    static int PartProgressCallback(void *clientp,
+        curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow);
+    static size_t PartHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata);
+    static size_t PartWriteCallback(char *buffer, size_t size, size_t nitems, void *userdata);
+    static size_t PartReadCallback(char *buffer, size_t size, size_t nitems, void *arg);
     static int OnDebug(CURL *curl, curl_infotype itype, char *pData, size_t size, void *lpvoid);
 
 private:
-    bool MultiAddHandle(CURLM *curlMulti, std::vector<CURL*>& curlArray);
-    void UploadFile();
-    void SetCurlOpt(CURL *curl);
-    void CheckUploadStatus(CURLM *curlMulti);
+    bool MultiAddHandle(CURLM *curlMulti, FileData &fileData);
+    bool AddRawHandle(CURLM *curlMulti, FileData &fileData, const struct stat &fileInfo);
+    bool AddBatchHandle(CURLM *curlMulti);
+    bool AddFilePart(curl_mime *mime, FileData &fileData);
+    void AddFormData(curl_mime *mime);
+    bool IsPutMethod();
+    bool AddResumableHandle(CURLM *curlMulti, FileData &fileData, const struct stat &fileInfo);
+    uint32_t RestartResumable(CURLM *curlMulti);
+    int64_t GetResumeWait();
+    void UploadInParts(FileData &fileData, uint32_t concurrency);
+    bool AddPartHandle(FileData &fileData, UploadPart *part);
+    void AbortInParts(FileData &fileData);
+    void CheckPartStatus(CURLM *curlMulti);
+    void FinishPartRequest(PartRequest &request, CURLcode result, long httpCode);
+    void ReleasePartRequest(PartRequest &request);
+    size_t ReadFile(UploadFileReader *reader, UploadCompressor *compressor, char *buffer, size_t size);
+    void UpdateProgress(const FileData &fileData, int64_t upsize);
+    void NotifyProgress(curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal);
+    void FlushProgress();
+    void NotifyResult(FileData &fileData, bool success);
+    void UploadFiles();
+    void SetCurlOpt(CURL *curl, FileData &fileData);
+    uint32_t CheckUploadStatus(CURLM *curlMulti);
+    void ReleaseHandle(FileData &fileData);
+    bool IsLastResponse();
     void CurlGlobalInit();
     void CurlGlobalCleanup();
-    void InitTimerInfo();
-    void StartTimer();
-    void StopTimer();
 
 private:
-    uint64_t timerId_;
-    std::shared_ptr<UploadTimerInfo> timerInfo_;
     IUploadTask *uploadTask_;
     std::vector<FileData> fileArray_;
-    FileData  mfileData_;
     std::shared_ptr<UploadConfig> config_;
     std::mutex mutex_;
     std::mutex curlMutex_;
     std::mutex setAbortMutex_;
-    std::mutex readMutex_;
     bool isCurlGlobalInit_;
-    bool isReadAbort_;
+    std::atomic<bool> isReadAbort_;
     CURLM *curlMulti_;
-    std::vector<CURL*> curlArray_;
+    uint32_t respondedCount_;
+    uint32_t expectedResponses_;
+    int64_t batchFileSize_;
+    std::vector<FileData *> resumeQueue_;
+    std::list<PartRequest> partRequests_;
+    std::unique_ptr<std::atomic<int64_t>[]> fileProgress_;
+    std::atomic<int64_t> totalProgress_;
+    int64_t notifiedProgress_;
+    int64_t notifiedTime_;
+    curl_off_t notifiedTotal_;
+    std::atomic<int64_t> readDeadline_;
+    uint64_t watchId_;
 };
 } // end of OHOS::Request::Upload
 #endif
\ No newline at end of file
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_COMPRESSOR_H
+#define UPLOAD_COMPRESSOR_H
+
+#include <sys/types.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace OHOS::Request::Upload {
+class UploadFileReader;
+
+/**
+ * @brief Gzip-encodes an upload source on its own thread. Compressed blocks wait in a short queue, so the
+ * curl thread only copies them out and never runs deflate itself.
+ */
+class UploadCompressor {
+public:
+    static constexpr size_t QUEUE_DEPTH = 4;
+
+    explicit UploadCompressor(std::shared_ptr<UploadFileReader> source);
+    ~UploadCompressor();
+    UploadCompressor(const UploadCompressor &) = delete;
+    UploadCompressor &operator=(const UploadCompressor &) = delete;
+
+    bool Start(size_t blockSize);
+    ssize_t Read(char *buffer, size_t size);
+    void Stop();
+    int64_t GetSourceSent() const
+    {
+        return sourceSent_;
+    }
+    static bool IsSupported(const std::string &encoding);
+
+private:
+    struct Chunk {
+        std::vector<char> data;
+        int64_t sourceEnd = 0;
+    };
+    void Compress();
+    bool Push(Chunk &chunk);
+    void Finish(bool error);
+
+private:
+    std::shared_ptr<UploadFileReader> source_;
+    size_t blockSize_ = 0;
+    std::deque<Chunk> chunks_;
+    Chunk current_;
+    size_t consumed_ = 0;
+    bool hasCurrent_ = false;
+    bool finished_ = false;
+    bool error_ = false;
+    bool stop_ = false;
+    std::atomic<int64_t> sourceSent_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_COMPRESSOR_H
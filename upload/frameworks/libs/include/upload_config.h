@@ -16,11 +16,17 @@
 #ifndef UPLOAD_CONFIG
 #define UPLOAD_CONFIG
 
+#include <memory>
 #include <string>
 #include <vector>
 #include "curl/curl.h"
 
 namespace OHOS::Request::Upload {
+class UploadFileReader;
+class UploadCompressor;
+class UploadResumable;
+class UploadParts;
+
 struct File {
     std::string filename;
     std::string name;
@@ -49,16 +55,32 @@ struct UploadConfig {
     std::function<void(std::string &data, int32_t &code)> ffail;
     std::function<void()> fcomplete;
     std::string protocolVersion;
+    int32_t priority = 0; // tasks with a higher priority leave the executor queue first
+    uint32_t maxConcurrency = 0; // files uploaded at the same time, 0 picks the default
+    uint32_t bufferSize = 0; // bytes read from a file at a time, 0 picks the default
+    bool useMmap = false;
+    bool resumable = false; // tus resumable upload instead of multipart POST
+    bool rawBody = false; // each file itself as the body of its request, sent with method
+    // "gzip" encodes rawBody uploads on the fly, empty sends the bytes as they are. The encoded body has no
+    // known length and goes out chunked, which presigned S3 URLs reject. Any other mode fails with CONFIG_ERROR.
+    std::string compression;
+    bool singleRequest = false; // every file and the form data in one multipart request
+    uint32_t partSize = 0; // parts of this many bytes sent side by side, 0 sends every file in one request
+    std::string checkpointDir;
 };
 
 struct FileData {
     FILE *fp;
+    std::shared_ptr<UploadFileReader> reader;
+    std::shared_ptr<UploadCompressor> compressor;
+    std::shared_ptr<UploadResumable> resumable;
+    std::shared_ptr<UploadParts> parts;
     std::string name;
     void *adp;
-    int64_t upsize;
     int64_t totalsize;
     uint32_t fileIndex;
     CURL *mcurl;
+    curl_mime *mime;
     struct curl_slist *list;
     std::vector<std::string> responseHead;
     int32_t headSendFlag;
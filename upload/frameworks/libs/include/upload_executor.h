@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_EXECUTOR_H
+#define UPLOAD_EXECUTOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OHOS::Request::Upload {
+using ExecutorJob = std::function<void()>;
+
+/**
+ * @brief Process-wide pool that runs upload tasks. At most maxWorkers threads are started, on demand, and the
+ * tasks beyond them wait in a queue ordered by priority, first come first served within one priority.
+ * A job can come with an abort that makes it return early, the pool calls it for running jobs when it shuts down.
+ */
+class UploadExecutor {
+public:
+    static constexpr uint32_t DEFAULT_MAX_WORKERS = 4;
+
+    static UploadExecutor &GetInstance();
+
+    uint64_t Submit(ExecutorJob job, int32_t priority, ExecutorJob abort = nullptr);
+    bool Cancel(uint64_t id);
+    void SetMaxWorkers(uint32_t count);
+
+private:
+    UploadExecutor() = default;
+    ~UploadExecutor();
+    void Work();
+    void SpawnWorkers();
+
+private:
+    struct Entry {
+        uint64_t id;
+        int32_t priority;
+        ExecutorJob job;
+        ExecutorJob abort;
+    };
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::list<Entry> queue_;
+    std::map<uint64_t, ExecutorJob> running_;
+    std::vector<std::thread> workers_;
+    uint32_t maxWorkers_ = DEFAULT_MAX_WORKERS;
+    uint32_t idle_ = 0;
+    uint64_t nextId_ = 1;
+    bool stop_ = false;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_EXECUTOR_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_FILE_READER_H
+#define UPLOAD_FILE_READER_H
+
+#include <sys/types.h>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace OHOS::Request::Upload {
+/**
+ * @brief Reads an upload source sequentially in large blocks. The file is either mapped or read by a prefetch
+ * thread into two buffers, so the next block comes from disk while the current one goes out on the network.
+ */
+class UploadFileReader {
+public:
+    static constexpr size_t MIN_BUFFER_SIZE = 16 * 1024;
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 256 * 1024;
+    static constexpr size_t MAX_BUFFER_SIZE = 8 * 1024 * 1024;
+
+    UploadFileReader(int fd, int64_t offset, int64_t length);
+    ~UploadFileReader();
+    UploadFileReader(const UploadFileReader &) = delete;
+    UploadFileReader &operator=(const UploadFileReader &) = delete;
+
+    bool Open(size_t bufferSize, bool useMmap);
+    ssize_t Read(char *buffer, size_t size);
+    void Close();
+    bool IsOpened() const
+    {
+        return opened_;
+    }
+    bool IsMapped() const
+    {
+        return mapped_ != nullptr;
+    }
+    int64_t GetPosition() const
+    {
+        return position_;
+    }
+    static size_t ClampBufferSize(size_t bufferSize);
+
+private:
+    struct Block {
+        std::vector<char> data;
+        size_t size = 0;
+        bool ready = false;
+    };
+    bool Map();
+    void Prefetch();
+    ssize_t ReadMapped(char *buffer, size_t size);
+    ssize_t ReadBuffered(char *buffer, size_t size);
+    ssize_t ReadFully(char *buffer, size_t size, int64_t offset);
+
+private:
+    int fd_;
+    int64_t offset_;
+    int64_t length_;
+    int64_t position_ = 0;
+    bool opened_ = false;
+    void *mapped_ = nullptr;
+    size_t mappedLength_ = 0;
+    size_t mappedDelta_ = 0;
+    Block blocks_[2];
+    size_t current_ = 0;
+    size_t consumed_ = 0;
+    bool error_ = false;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::thread thread_;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_FILE_READER_H
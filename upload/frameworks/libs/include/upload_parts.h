@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_PARTS_H
+#define UPLOAD_PARTS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "curl/curl.h"
+
+namespace OHOS::Request::Upload {
+class UploadFileReader;
+struct FileData;
+
+enum class PartStep {
+    INITIATE,
+    PARTS,
+    COMPLETE,
+    DONE,
+    FAILED,
+};
+
+struct UploadPart {
+    uint32_t number = 0;
+    int64_t offset = 0;
+    int64_t length = 0;
+    int64_t sent = 0;
+    std::string etag;
+    uint32_t retries = 0;
+    int64_t retryTime = 0;
+    bool running = false;
+    bool done = false;
+};
+
+/**
+ * @brief One request of a part upload. part is null for the initiate and complete requests.
+ */
+struct PartRequest {
+    FileData *fileData = nullptr;
+    UploadPart *part = nullptr;
+    CURL *curl = nullptr;
+    struct curl_slist *list = nullptr;
+    std::shared_ptr<UploadFileReader> reader;
+    std::string payload;
+    std::string body;
+    std::string head;
+    std::string etag;
+};
+
+/**
+ * @brief State of one file uploaded in parts the way S3 multipart uploads work: an upload id is requested, the
+ * parts are PUT side by side and each retried on its own, and a final request joins them in order.
+ */
+class UploadParts {
+public:
+    static constexpr int64_t MIN_PART_SIZE = 5 * 1024 * 1024;
+    static constexpr uint32_t MAX_PARTS = 10000;
+    static constexpr uint32_t MAX_RETRIES = 3;
+
+    UploadParts(const std::string &url, int64_t size, int64_t partSize);
+    PartStep GetStep() const
+    {
+        return step_;
+    }
+    bool TakeControlRequest(int64_t now);
+    UploadPart *TakePart(int64_t now);
+    struct curl_slist *PrepareInitiate(CURL *curl, struct curl_slist *list);
+    struct curl_slist *PreparePart(CURL *curl, struct curl_slist *list, const UploadPart &part);
+    struct curl_slist *PrepareComplete(CURL *curl, struct curl_slist *list, std::string &payload);
+    struct curl_slist *PrepareAbort(CURL *curl, struct curl_slist *list);
+    void OnInitiateDone(CURLcode result, long httpCode, const std::string &body, int64_t now);
+    void OnPartDone(UploadPart &part, CURLcode result, long httpCode, const std::string &etag, int64_t now);
+    void OnCompleteDone(CURLcode result, long httpCode, const std::string &body, int64_t now);
+    void SetSent(UploadPart &part, int64_t sent);
+    int64_t GetSent() const
+    {
+        return sent_;
+    }
+    int64_t GetNextRetryTime() const;
+    const std::string &GetUploadId() const
+    {
+        return uploadId_;
+    }
+    static std::string ParseTag(const std::string &body, const std::string &tag);
+
+private:
+    bool Retry(uint32_t &retries, int64_t &retryTime, int64_t now);
+    std::string MakeUrl(const std::string &query) const;
+
+private:
+    std::string url_;
+    int64_t size_;
+    std::vector<UploadPart> parts_;
+    int64_t sent_ = 0;
+    std::string uploadId_;
+    uint32_t retries_ = 0;
+    int64_t retryTime_ = 0;
+    bool busy_ = false;
+    PartStep step_ = PartStep::INITIATE;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_PARTS_H
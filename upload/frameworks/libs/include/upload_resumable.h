@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_RESUMABLE_H
+#define UPLOAD_RESUMABLE_H
+
+#include <cstdint>
+#include <string>
+#include "curl/curl.h"
+
+namespace OHOS::Request::Upload {
+enum class ResumeStep {
+    CREATE,
+    QUERY,
+    SEND,
+    DONE,
+    FAILED,
+};
+
+/**
+ * @brief State of one file uploaded with the tus resumable protocol: the upload is created once, then sent as
+ * PATCH chunks. The server acknowledged offset is persisted after every chunk, so after a network drop or an app
+ * restart the offset is queried again and the upload goes on from there.
+ */
+class UploadResumable {
+public:
+    static constexpr int64_t MIN_CHUNK_SIZE = 256 * 1024;
+    static constexpr int64_t INITIAL_CHUNK_SIZE = 1024 * 1024;
+    static constexpr int64_t MAX_CHUNK_SIZE = 64 * 1024 * 1024;
+    static constexpr int64_t TARGET_CHUNK_MS = 2000;
+    static constexpr uint32_t MAX_RETRIES = 5;
+
+    UploadResumable(const std::string &url, int64_t size, const std::string &checkpointPath);
+    void Load(const std::string &fileKey);
+    struct curl_slist *Prepare(CURL *curl, struct curl_slist *list);
+    void OnHeader(const std::string &line);
+    void OnDone(CURLcode result, long httpCode, int64_t elapsedMs);
+    ResumeStep GetStep() const
+    {
+        return step_;
+    }
+    int64_t GetOffset() const
+    {
+        return offset_;
+    }
+    int64_t GetRetryTime() const
+    {
+        return retryTime_;
+    }
+    int64_t GetChunkLength() const;
+    static std::string MakeCheckpointPath(const std::string &dir, const std::string &fileKey);
+
+private:
+    void AdaptChunkSize(int64_t sent, int64_t elapsedMs);
+    bool Retry();
+    void Save();
+    void Remove();
+    std::string ResolveLocation(const std::string &location) const;
+
+private:
+    std::string url_;
+    int64_t size_;
+    std::string checkpointPath_;
+    std::string fileKey_;
+    std::string location_;
+    int64_t offset_ = 0;
+    int64_t chunkSize_ = INITIAL_CHUNK_SIZE;
+    int64_t sending_ = 0;
+    int64_t serverOffset_ = -1;
+    std::string newLocation_;
+    uint32_t retries_ = 0;
+    int64_t retryTime_ = 0;
+    ResumeStep step_ = ResumeStep::CREATE;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_RESUMABLE_H
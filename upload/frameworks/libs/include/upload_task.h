@@ -17,8 +17,6 @@
 #define UPLOAD_TASK_
 
 #include <cstdio>
-#include <thread>
-#include <pthread.h>
 #include "curl/curl.h"
 #include "curl/easy.h"
 #include "upload_common.h"
@@ -27,6 +25,7 @@
 #include "i_fail_callback.h"
 #include "i_upload_task.h"
 #include "upload_config.h"
+#include "upload_executor.h"
 #include "curl_adp.h"
 #include "obtain_file.h"
 #include "upload_hilog_wrapper.h"
@@ -76,7 +75,7 @@ protected:
     void ClearFileArray();
 private:
     std::shared_ptr<UploadConfig> uploadConfig_;
-    std::unique_ptr<std::thread> thread_;
+    uint64_t jobId_;
 
     IProgressCallback* progressCallback_;
     IHeaderReceiveCallback* headerReceiveCallback_;
@@ -91,8 +90,8 @@ private:
     std::string header_;
     std::vector<FileData> fileArray_;
     UploadTaskState state_;
+    bool isRemoved_;
     std::mutex mutex_;
-    std::thread::native_handle_type thread_handle_;
 };
 } // end of OHOS::Request::Upload
 #endif
\ No newline at end of file
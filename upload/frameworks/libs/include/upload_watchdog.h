@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef UPLOAD_WATCHDOG_H
+#define UPLOAD_WATCHDOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+namespace OHOS::Request::Upload {
+using WatchdogFunc = std::function<void()>;
+
+/**
+ * @brief In-process replacement for the system timers around blocking reads. Every watched transfer owns an
+ * atomic monotonic deadline, set before a read and cleared after it, which one shared thread checks.
+ */
+class UploadWatchdog {
+public:
+    static UploadWatchdog &GetInstance();
+    static int64_t Now();
+
+    uint64_t Watch(std::atomic<int64_t> *deadline, WatchdogFunc callback);
+    void Unwatch(uint64_t id);
+    void SetCheckInterval(int64_t intervalMs);
+
+private:
+    UploadWatchdog() = default;
+    ~UploadWatchdog();
+    void Run();
+    void CheckDeadlines();
+
+private:
+    struct WatchEntry {
+        std::atomic<int64_t> *deadline;
+        WatchdogFunc callback;
+    };
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<uint64_t, WatchEntry> watches_;
+    std::thread thread_;
+    uint64_t nextId_ = 1;
+    int64_t checkIntervalMs_ = 1000;
+    bool running_ = false;
+    bool stop_ = false;
+};
+} // namespace OHOS::Request::Upload
+#endif // UPLOAD_WATCHDOG_H
@@ -15,23 +15,34 @@
 
 #include <unistd.h>
 #include <fcntl.h>
+#include <strings.h>
 #include <sys/stat.h>
 #include <cstdio>
 #include <climits>
 #include <cinttypes>
+#include <cstdlib>
+#include <algorithm>
 #include "upload_hilog_wrapper.h"
 #include "upload_task.h"
-#include "upload_timer_info.h"
-#include "time_service_client.h"
 
 namespace OHOS::Request::Upload {
-const int TRANS_TIMEOUT_MS = 300 * 1000;
 const int READFILE_TIMEOUT_MS = 30 * 1000;
-const int TIMEOUTTYPE = 1;
-const int SLEEP = 1000;
+const int WAIT_INTERVAL_MS = 1000;
+const uint32_t DEFAULT_CONCURRENCY = 4;
+const size_t MAX_CURL_UPLOAD_BUFFER = 2 * 1024 * 1024;
+const size_t MAX_PART_RESPONSE_BODY = 64 * 1024;
+const int64_t USEC_PER_MSEC = 1000;
+const int64_t PROGRESS_INTERVAL_MS = 100;
+const int64_t PROGRESS_MIN_DELTA = 64 * 1024;
+const int64_t ABORT_TIMEOUT_MS = 10 * 1000;
 const int collectDoFlag = 1;
 const int collectEndFlag = 2;
 const std::string headEndFlag = "\r\n";
+const std::string statusLinePrefix = "HTTP/";
+const std::string etagHeader = "etag:";
+const std::string contentTypeHeader = "content-type:";
+const std::string rawContentType = "Content-Type: application/octet-stream";
+const std::string contentEncodingHeader = "Content-Encoding: ";
 
 CUrlAdp::CUrlAdp(std::vector<FileData>& fileArray, std::shared_ptr<UploadConfig>& config)
 {
@@ -40,16 +51,27 @@ CUrlAdp::CUrlAdp(std::vector<FileData>& fileArray, std::shared_ptr<UploadConfig>
     isCurlGlobalInit_ = false;
     isReadAbort_ = false;
     curlMulti_ = nullptr;
-    timerId_ = 0;
-    timerInfo_ = nullptr;
+    respondedCount_ = 0;
+    expectedResponses_ = fileArray_.size();
+    batchFileSize_ = 0;
+    fileProgress_ = std::make_unique<std::atomic<int64_t>[]>(fileArray_.size());
+    totalProgress_ = 0;
+    notifiedProgress_ = 0;
+    notifiedTime_ = 0;
+    notifiedTotal_ = 0;
+    readDeadline_ = 0;
+    watchId_ = 0;
+    uint32_t index = 0;
     for (auto &vmem : fileArray_) {
-        vmem.upsize = 0;
         vmem.totalsize = 0;
-        vmem.fileIndex = 0;
+        vmem.fileIndex = ++index;
         vmem.mcurl = nullptr;
+        vmem.mime = nullptr;
         vmem.headSendFlag = 0;
         vmem.httpCode = 0;
         vmem.list = nullptr;
+        vmem.adp = this;
+        vmem.responseHead.clear();
     }
 }
 
@@ -86,47 +108,40 @@ void CUrlAdp::DoUpload(IUploadTask *task)
         return;
     }
 
-    InitTimerInfo();
-    uint32_t index = 0;
-    for (auto &vmem : fileArray_) {
-        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>vmem : fileArray_ isReadAbort is %{public}d", IsReadAbort());
-        if (IsReadAbort()) {
-            return;
-        }
-        index++;
-        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>fileArray index %{public}u", index);
-        mfileData_ = vmem;
-        mfileData_.fileIndex = index;
-        mfileData_.responseHead.clear();
-        if (mfileData_.list) {
-            curl_slist_free_all(mfileData_.list);
-            mfileData_.list = nullptr;
-        }
-        UploadFile();
-        RemoveInner();
-        usleep(SLEEP);
-    }
+    watchId_ = UploadWatchdog::GetInstance().Watch(&readDeadline_, [this]() {
+        this->FailNotify(UPLOAD_ERRORCODE_UPLOAD_OUTTIME);
+        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "OutTime error");
+        this->isReadAbort_ = true;
+    });
+    UploadFiles();
+    UploadWatchdog::GetInstance().Unwatch(watchId_);
+    watchId_ = 0;
+    RemoveInner();
 
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "upload end");
 }
 
-bool CUrlAdp::MultiAddHandle(CURLM *curlMulti, std::vector<CURL*>& curlArray)
+bool CUrlAdp::MultiAddHandle(CURLM *curlMulti, FileData &fileData)
 {
-    curl_mime *mime;
-    curl_mimepart *part;
     struct stat fileInfo;
-    if (mfileData_.fp == nullptr) {
+    if (fileData.fp == nullptr) {
         UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "file ptr is null");
         FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
         return false;
     }
     /* to get the file size */
-    if (fstat(fileno(mfileData_.fp), &fileInfo) != 0) {
+    if (fstat(fileno(fileData.fp), &fileInfo) != 0) {
         UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "get the file info fail");
         FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
         return false;
     }
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "fileInfo.st_size %{public}lld", (long long)fileInfo.st_size);
+    if (config_->resumable) {
+        return AddResumableHandle(curlMulti, fileData, fileInfo);
+    }
+    if (config_->rawBody) {
+        return AddRawHandle(curlMulti, fileData, fileInfo);
+    }
     CURL *curl = curl_easy_init();
     if (curl == nullptr) {
         FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
@@ -135,39 +150,280 @@ bool CUrlAdp::MultiAddHandle(CURLM *curlMulti, std::vector<CURL*>& curlArray)
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>MultiAddHandle headerSize is %{public}zu", config_->header.size());
     if (config_->header.size()) {
         for (auto &headerData : config_->header) {
-            mfileData_.list = curl_slist_append(mfileData_.list, headerData.c_str());
+            fileData.list = curl_slist_append(fileData.list, headerData.c_str());
             UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>MultiAddHandle headerData is %{public}s", headerData.c_str());
         }
     }
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, mfileData_.list);
-    curlArray.push_back(curl);
-    mime = curl_mime_init(curl);
-    if (config_->data.size()) {
-        for (auto &vdata : config_->data) {
-            part = curl_mime_addpart(mime);
-            curl_mime_name(part, vdata.name.c_str());
-            curl_mime_data(part, vdata.value.c_str(), vdata.value.size());
-            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>MultiAddHandle vdata.name is %{public}s", vdata.name.c_str());
-            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>MultiAddHandle vdata.value is %{public}s", vdata.value.c_str());
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, fileData.list);
+    fileData.mcurl = curl;
+    fileData.mime = curl_mime_init(curl);
+    AddFormData(fileData.mime);
+    if (!AddFilePart(fileData.mime, fileData)) {
+        ReleaseHandle(fileData);
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    curl_easy_setopt(curl, CURLOPT_MIMEPOST, fileData.mime);
+    if (IsPutMethod()) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+    }
+    SetCurlOpt(curl, fileData);
+    if (curl_multi_add_handle(curlMulti, curl) != CURLM_OK) {
+        ReleaseHandle(fileData);
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Send the file itself as the request body, streamed from the fd with its size as Content-Length.
+ * This is what object stores and presigned URLs expect.
+ */
+bool CUrlAdp::AddRawHandle(CURLM *curlMulti, FileData &fileData, const struct stat &fileInfo)
+{
+    bool compress = !config_->compression.empty();
+    if (compress && !UploadCompressor::IsSupported(config_->compression)) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "unsupported compression %{public}s", config_->compression.c_str());
+        FailNotify(UPLOAD_ERRORCODE_CONFIG_ERROR);
+        return false;
+    }
+    fileData.reader = std::make_shared<UploadFileReader>(fileno(fileData.fp), 0, fileInfo.st_size);
+    if (!fileData.reader->Open(config_->bufferSize, config_->useMmap)) {
+        fileData.reader = nullptr;
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    if (compress) {
+        fileData.compressor = std::make_shared<UploadCompressor>(fileData.reader);
+        if (!fileData.compressor->Start(UploadFileReader::ClampBufferSize(config_->bufferSize))) {
+            fileData.compressor = nullptr;
+            fileData.reader = nullptr;
+            FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+            return false;
+        }
+    }
+    CURL *curl = curl_easy_init();
+    if (curl == nullptr) {
+        fileData.compressor = nullptr;
+        fileData.reader = nullptr;
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    fileData.mcurl = curl;
+    fileData.totalsize = fileInfo.st_size;
+    // the compressed size is only known at the end, such a body goes out chunked
+    curl_off_t bodySize = compress ? -1 : static_cast<curl_off_t>(fileInfo.st_size);
+    if (compress) {
+        fileData.list = curl_slist_append(fileData.list, (contentEncodingHeader + config_->compression).c_str());
+    }
+    bool hasContentType = false;
+    for (auto &headerData : config_->header) {
+        fileData.list = curl_slist_append(fileData.list, headerData.c_str());
+        if (strncasecmp(headerData.c_str(), contentTypeHeader.c_str(), contentTypeHeader.size()) == 0) {
+            hasContentType = true;
         }
     }
-    part = curl_mime_addpart(mime);
+    SetCurlOpt(curl, fileData);
+    if (IsPutMethod()) {
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, bodySize);
+    } else {
+        curl_easy_setopt(curl, CURLOPT_POST, 1L);
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, bodySize);
+        // a POST body read from a callback would go out as form-urlencoded
+        if (!hasContentType) {
+            fileData.list = curl_slist_append(fileData.list, rawContentType.c_str());
+        }
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, fileData.list);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, ReadCallback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &fileData);
+    if (curl_multi_add_handle(curlMulti, curl) != CURLM_OK) {
+        ReleaseHandle(fileData);
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Send every file in one multipart body with the form data once, the first file carries the request
+ */
+bool CUrlAdp::AddBatchHandle(CURLM *curlMulti)
+{
+    FileData &carrier = fileArray_.front();
+    CURL *curl = curl_easy_init();
+    if (curl == nullptr) {
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    for (auto &headerData : config_->header) {
+        carrier.list = curl_slist_append(carrier.list, headerData.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, carrier.list);
+    carrier.mcurl = curl;
+    carrier.mime = curl_mime_init(curl);
+    AddFormData(carrier.mime);
+    batchFileSize_ = 0;
+    for (auto &fileData : fileArray_) {
+        if (fileData.fp == nullptr || !AddFilePart(carrier.mime, fileData)) {
+            UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "add file %{public}u fail", fileData.fileIndex);
+            for (auto &vmem : fileArray_) {
+                ReleaseHandle(vmem);
+            }
+            FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+            return false;
+        }
+        batchFileSize_ += fileData.totalsize;
+    }
+    curl_easy_setopt(curl, CURLOPT_MIMEPOST, carrier.mime);
+    if (IsPutMethod()) {
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PUT");
+    }
+    SetCurlOpt(curl, carrier);
+    if (curl_multi_add_handle(curlMulti, curl) != CURLM_OK) {
+        for (auto &vmem : fileArray_) {
+            ReleaseHandle(vmem);
+        }
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Add a file part to a multipart body, its content is read from the file while the body goes out.
+ * The reader is opened on the first read of the part and closed at its end, so a body of many files keeps
+ * one prefetch thread and its buffers alive at a time.
+ */
+bool CUrlAdp::AddFilePart(curl_mime *mime, FileData &fileData)
+{
+    struct stat fileInfo;
+    if (fstat(fileno(fileData.fp), &fileInfo) != 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "get the file info fail");
+        return false;
+    }
+    fileData.reader = std::make_shared<UploadFileReader>(fileno(fileData.fp), 0, fileInfo.st_size);
+    curl_mimepart *part = curl_mime_addpart(mime);
     curl_mime_name(part, "upload");
-    curl_mime_filename(part, mfileData_.name.c_str());
-    mfileData_.adp = this;
-    mfileData_.totalsize = fileInfo.st_size;
-    curl_mime_data_cb(part, fileInfo.st_size, ReadCallback, NULL, NULL, &mfileData_);
-    curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
-    SetCurlOpt(curl);
-    curl_multi_add_handle(curlMulti, curl);
+    curl_mime_filename(part, fileData.name.c_str());
+    fileData.totalsize = fileInfo.st_size;
+    curl_mime_data_cb(part, fileInfo.st_size, MimeReadCallback, NULL, NULL, &fileData);
     return true;
 }
 
-void CUrlAdp::UploadFile()
+bool CUrlAdp::IsPutMethod()
 {
-    int isRuning = 0;
-    bool ret = false;
+    return strcasecmp(config_->method.c_str(), "PUT") == 0;
+}
 
+void CUrlAdp::AddFormData(curl_mime *mime)
+{
+    for (auto &vdata : config_->data) {
+        curl_mimepart *part = curl_mime_addpart(mime);
+        curl_mime_name(part, vdata.name.c_str());
+        curl_mime_data(part, vdata.value.c_str(), vdata.value.size());
+        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>AddFormData vdata.name is %{public}s", vdata.name.c_str());
+        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>AddFormData vdata.value is %{public}s", vdata.value.c_str());
+    }
+}
+
+/**
+ * @brief Start the next request of a resumable upload, a tus create, offset query or PATCH of one chunk
+ */
+bool CUrlAdp::AddResumableHandle(CURLM *curlMulti, FileData &fileData, const struct stat &fileInfo)
+{
+    if (fileData.resumable == nullptr) {
+        std::string fileKey = config_->url + "|" + fileData.name + "|" + std::to_string(fileInfo.st_dev) + ":" +
+            std::to_string(fileInfo.st_ino) + "|" + std::to_string(fileInfo.st_size) + "|" +
+            std::to_string(fileInfo.st_mtime);
+        std::string checkpointPath = UploadResumable::MakeCheckpointPath(config_->checkpointDir, fileKey);
+        fileData.resumable = std::make_shared<UploadResumable>(config_->url, fileInfo.st_size, checkpointPath);
+        fileData.resumable->Load(fileKey);
+        fileData.totalsize = fileInfo.st_size;
+    }
+    std::shared_ptr<UploadResumable> resumable = fileData.resumable;
+    if (resumable->GetStep() == ResumeStep::SEND) {
+        fileData.reader = std::make_shared<UploadFileReader>(fileno(fileData.fp), resumable->GetOffset(),
+            resumable->GetChunkLength());
+        if (!fileData.reader->Open(config_->bufferSize, config_->useMmap)) {
+            fileData.reader = nullptr;
+            FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+            return false;
+        }
+    }
+    CURL *curl = curl_easy_init();
+    if (curl == nullptr) {
+        fileData.reader = nullptr;
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    fileData.mcurl = curl;
+    for (auto &headerData : config_->header) {
+        fileData.list = curl_slist_append(fileData.list, headerData.c_str());
+    }
+    SetCurlOpt(curl, fileData);
+    fileData.list = resumable->Prepare(curl, fileData.list);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, fileData.list);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, ResumableHeaderCallback);
+    if (resumable->GetStep() == ResumeStep::SEND) {
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, ReadCallback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, &fileData);
+    }
+    if (curl_multi_add_handle(curlMulti, curl) != CURLM_OK) {
+        ReleaseHandle(fileData);
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Start the follow-up requests of resumable uploads whose retry time has come
+ *
+ * @return the number of uploads that could not go on
+ */
+uint32_t CUrlAdp::RestartResumable(CURLM *curlMulti)
+{
+    uint32_t failed = 0;
+    int64_t now = UploadWatchdog::Now();
+    for (auto it = resumeQueue_.begin(); it != resumeQueue_.end();) {
+        if ((*it)->resumable->GetRetryTime() > now) {
+            ++it;
+            continue;
+        }
+        FileData *fileData = *it;
+        it = resumeQueue_.erase(it);
+        if (!MultiAddHandle(curlMulti, *fileData)) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+int64_t CUrlAdp::GetResumeWait()
+{
+    int64_t wait = WAIT_INTERVAL_MS;
+    int64_t now = UploadWatchdog::Now();
+    for (auto fileData : resumeQueue_) {
+        wait = std::min(wait, std::max(fileData->resumable->GetRetryTime() - now, static_cast<int64_t>(0)));
+    }
+    return wait;
+}
+
+/**
+ * @brief Upload the files side by side on one multi handle, its connection cache lets later files reuse
+ * the connections of earlier ones.
+ */
+void CUrlAdp::UploadFiles()
+{
+    // the encoder only feeds a plain request body, tus chunks and parts are sent as they are on disk
+    if (!config_->compression.empty() && (!config_->rawBody || config_->resumable || config_->partSize > 0)) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "compression needs rawBody without resumable or partSize");
+        FailNotify(UPLOAD_ERRORCODE_CONFIG_ERROR);
+        return;
+    }
     CurlGlobalInit();
     curlMulti_ = curl_multi_init();
     if (curlMulti_ == nullptr) {
@@ -175,24 +431,257 @@ void CUrlAdp::UploadFile()
         CurlGlobalCleanup();
         return;
     }
+    uint32_t concurrency = config_->maxConcurrency > 0 ? config_->maxConcurrency : DEFAULT_CONCURRENCY;
+    curl_multi_setopt(curlMulti_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(concurrency));
+    curl_multi_setopt(curlMulti_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
 
-    ret = MultiAddHandle(curlMulti_, curlArray_);
-    if (ret == false) {
-        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+    if (config_->partSize > 0 && !config_->resumable) {
+        // the parts of one file already fill the connections, the files go one after another
+        for (auto &fileData : fileArray_) {
+            if (IsReadAbort()) {
+                break;
+            }
+            UploadInParts(fileData, concurrency);
+        }
         return;
     }
-    curl_multi_perform(curlMulti_, &isRuning);
-    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "isRuning = %{public}d", isRuning);
-    do {
+    size_t next = 0;
+    uint32_t active = 0;
+    if (config_->singleRequest && !config_->resumable && !config_->rawBody) {
+        expectedResponses_ = 1;
+        next = fileArray_.size();
+        if (AddBatchHandle(curlMulti_)) {
+            active++;
+        }
+    }
+    while (!IsReadAbort()) {
+        while (next < fileArray_.size() && active < concurrency) {
+            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>fileArray index %{public}u", fileArray_[next].fileIndex);
+            if (MultiAddHandle(curlMulti_, fileArray_[next])) {
+                active++;
+            }
+            next++;
+        }
+        active -= RestartResumable(curlMulti_);
+        if (active == 0) {
+            break;
+        }
+        int isRuning = 0;
+        curl_multi_perform(curlMulti_, &isRuning);
+        active -= CheckUploadStatus(curlMulti_);
+        if (active == 0 && next >= fileArray_.size()) {
+            break;
+        }
         int numfds = 0;
-        int res = curl_multi_wait(curlMulti_, NULL, 0, TRANS_TIMEOUT_MS, &numfds);
-        if (res != CURLM_OK) {
+        // poll rather than wait, a wait returns at once while resumable uploads sit out their retry delay
+        if (curl_multi_poll(curlMulti_, NULL, 0, static_cast<int>(GetResumeWait()), &numfds) != CURLM_OK) {
             FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
             return;
         }
+    }
+}
+
+/**
+ * @brief Upload one file as parts sent side by side, a failed part is sent again on its own
+ */
+void CUrlAdp::UploadInParts(FileData &fileData, uint32_t concurrency)
+{
+    struct stat fileInfo;
+    if (fileData.fp == nullptr || fstat(fileno(fileData.fp), &fileInfo) != 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "get the file info fail");
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+        return;
+    }
+    fileData.totalsize = fileInfo.st_size;
+    fileData.parts = std::make_shared<UploadParts>(config_->url, fileInfo.st_size, config_->partSize);
+    std::shared_ptr<UploadParts> parts = fileData.parts;
+    while (!IsReadAbort()) {
+        int64_t now = UploadWatchdog::Now();
+        if (parts->TakeControlRequest(now)) {
+            AddPartHandle(fileData, nullptr);
+        }
+        UploadPart *part = nullptr;
+        while (partRequests_.size() < concurrency && (part = parts->TakePart(now)) != nullptr) {
+            AddPartHandle(fileData, part);
+        }
+        PartStep step = parts->GetStep();
+        if (step == PartStep::FAILED || (step == PartStep::DONE && partRequests_.empty())) {
+            break;
+        }
+        int isRuning = 0;
         curl_multi_perform(curlMulti_, &isRuning);
-    } while (isRuning);
-    CheckUploadStatus(curlMulti_);
+        CheckPartStatus(curlMulti_);
+        if (parts->GetStep() == PartStep::FAILED || parts->GetStep() == PartStep::DONE) {
+            continue;
+        }
+        int64_t wait = WAIT_INTERVAL_MS;
+        if (partRequests_.size() < concurrency) {
+            wait = std::min(wait, std::max(parts->GetNextRetryTime() - UploadWatchdog::Now(),
+                static_cast<int64_t>(0)));
+        }
+        int numfds = 0;
+        if (curl_multi_poll(curlMulti_, NULL, 0, static_cast<int>(wait), &numfds) != CURLM_OK) {
+            FailNotify(UPLOAD_ERRORCODE_UPLOAD_LIB_ERROR);
+            break;
+        }
+    }
+    for (auto &request : partRequests_) {
+        ReleasePartRequest(request);
+    }
+    partRequests_.clear();
+    if (parts->GetStep() != PartStep::DONE && !parts->GetUploadId().empty()) {
+        AbortInParts(fileData);
+    }
+    if (!IsReadAbort()) {
+        NotifyResult(fileData, parts->GetStep() == PartStep::DONE);
+    }
+}
+
+/**
+ * @brief Tell the server to drop the parts of an upload that failed or was removed, it keeps them otherwise
+ */
+void CUrlAdp::AbortInParts(FileData &fileData)
+{
+    PartRequest request;
+    request.fileData = &fileData;
+    request.curl = curl_easy_init();
+    if (request.curl == nullptr) {
+        return;
+    }
+    for (auto &headerData : config_->header) {
+        request.list = curl_slist_append(request.list, headerData.c_str());
+    }
+    request.list = fileData.parts->PrepareAbort(request.curl, request.list);
+    curl_easy_setopt(request.curl, CURLOPT_HTTPHEADER, request.list);
+    curl_easy_setopt(request.curl, CURLOPT_WRITEFUNCTION, PartWriteCallback);
+    curl_easy_setopt(request.curl, CURLOPT_WRITEDATA, &request);
+    curl_easy_setopt(request.curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_easy_setopt(request.curl, CURLOPT_TIMEOUT_MS, static_cast<long>(ABORT_TIMEOUT_MS));
+    curl_easy_setopt(request.curl, CURLOPT_NOSIGNAL, 1L);
+    curl_easy_setopt(request.curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(request.curl, CURLOPT_SSL_VERIFYHOST, 0L);
+    CURLcode result = curl_easy_perform(request.curl);
+    long httpCode = 0;
+    curl_easy_getinfo(request.curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "abort part upload, curl %{public}d http %{public}ld", result, httpCode);
+    curl_easy_cleanup(request.curl);
+    curl_slist_free_all(request.list);
+}
+
+/**
+ * @brief Start one request of a part upload, the initiate or complete request when part is null
+ */
+bool CUrlAdp::AddPartHandle(FileData &fileData, UploadPart *part)
+{
+    partRequests_.emplace_back();
+    PartRequest &request = partRequests_.back();
+    request.fileData = &fileData;
+    request.part = part;
+    bool ok = true;
+    if (part != nullptr) {
+        request.reader = std::make_shared<UploadFileReader>(fileno(fileData.fp), part->offset, part->length);
+        ok = request.reader->Open(config_->bufferSize, config_->useMmap);
+    }
+    request.curl = ok ? curl_easy_init() : nullptr;
+    if (request.curl != nullptr) {
+        CURL *curl = request.curl;
+        for (auto &headerData : config_->header) {
+            request.list = curl_slist_append(request.list, headerData.c_str());
+        }
+        SetCurlOpt(curl, fileData);
+        if (part != nullptr) {
+            request.list = fileData.parts->PreparePart(curl, request.list, *part);
+            curl_easy_setopt(curl, CURLOPT_READFUNCTION, PartReadCallback);
+            curl_easy_setopt(curl, CURLOPT_READDATA, &request);
+        } else if (fileData.parts->GetStep() == PartStep::INITIATE) {
+            request.list = fileData.parts->PrepareInitiate(curl, request.list);
+        } else {
+            request.list = fileData.parts->PrepareComplete(curl, request.list, request.payload);
+        }
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, request.list);
+        curl_easy_setopt(curl, CURLOPT_PRIVATE, &request);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, PartHeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &request);
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, PartWriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &request);
+        if (config_->protocolVersion != "L5") {
+            curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, PartProgressCallback);
+            curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &request);
+        }
+        ok = curl_multi_add_handle(curlMulti_, curl) == CURLM_OK;
+    }
+    if (!ok || request.curl == nullptr) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "start part request fail");
+        FinishPartRequest(request, CURLE_FAILED_INIT, 0);
+        ReleasePartRequest(request);
+        partRequests_.pop_back();
+        return false;
+    }
+    return true;
+}
+
+void CUrlAdp::CheckPartStatus(CURLM *curlMulti)
+{
+    uint32_t finished = 0;
+    int msgsLeft = 0;
+    CURLMsg *msg = NULL;
+    while ((msg = curl_multi_info_read(curlMulti, &msgsLeft))) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        CURLcode result = msg->data.result;
+        PartRequest *request = NULL;
+        long httpCode = 0;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &request);
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE, &httpCode);
+        auto it = std::find_if(partRequests_.begin(), partRequests_.end(),
+            [request](const PartRequest &item) { return &item == request; });
+        if (it == partRequests_.end()) {
+            continue;
+        }
+        if (request->part == nullptr) {
+            // the head of the last initiate or complete response is what gets reported
+            request->fileData->responseHead.assign(1, request->head);
+            request->fileData->httpCode = httpCode;
+        }
+        FinishPartRequest(*request, result, httpCode);
+        ReleasePartRequest(*request);
+        partRequests_.erase(it);
+        finished++;
+    }
+    if (finished > 0) {
+        FlushProgress();
+    }
+}
+
+void CUrlAdp::FinishPartRequest(PartRequest &request, CURLcode result, long httpCode)
+{
+    std::shared_ptr<UploadParts> parts = request.fileData->parts;
+    int64_t now = UploadWatchdog::Now();
+    if (request.part != nullptr) {
+        parts->OnPartDone(*request.part, result, httpCode, request.etag, now);
+    } else if (parts->GetStep() == PartStep::INITIATE) {
+        parts->OnInitiateDone(result, httpCode, request.body, now);
+    } else {
+        parts->OnCompleteDone(result, httpCode, request.body, now);
+    }
+}
+
+void CUrlAdp::ReleasePartRequest(PartRequest &request)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (request.curl != nullptr) {
+        if (curlMulti_) {
+            curl_multi_remove_handle(curlMulti_, request.curl);
+        }
+        curl_easy_cleanup(request.curl);
+        request.curl = nullptr;
+    }
+    if (request.list != nullptr) {
+        curl_slist_free_all(request.list);
+        request.list = nullptr;
+    }
+    request.reader = nullptr;
 }
 
 void CUrlAdp::CurlGlobalInit()
@@ -211,28 +700,36 @@ void CUrlAdp::CurlGlobalCleanup()
     }
 }
 
-void CUrlAdp::SetCurlOpt(CURL *curl)
+void CUrlAdp::SetCurlOpt(CURL *curl, FileData &fileData)
 {
     curl_easy_setopt(curl, CURLOPT_URL, config_->url.c_str());
     curl_easy_setopt(curl, CURLOPT_VERBOSE, 1L);
-    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &mfileData_);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, &fileData);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &fileData);
     if (config_->protocolVersion == "L5") {
         curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallbackL5);
     } else {
         curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
         curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, ProgressCallback);
-        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &mfileData_);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, &fileData);
     }
     curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
     curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, 8192L);
+    size_t bufferSize = std::min(UploadFileReader::ClampBufferSize(config_->bufferSize), MAX_CURL_UPLOAD_BUFFER);
+    curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, static_cast<long>(bufferSize));
     curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
     curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
 }
 
-void CUrlAdp::CheckUploadStatus(CURLM *curlMulti)
+/**
+ * @brief Collect the finished transfers and free their handles so the next files can start
+ *
+ * @return the number of transfers that finished
+ */
+uint32_t CUrlAdp::CheckUploadStatus(CURLM *curlMulti)
 {
+    uint32_t finished = 0;
     int msgsLeft = 0;
     CURLMsg* msg = NULL;
     while ((msg = curl_multi_info_read(curlMulti, &msgsLeft))) {
@@ -242,19 +739,66 @@ void CUrlAdp::CheckUploadStatus(CURLM *curlMulti)
         }
         eh = msg->easy_handle;
         int returnCode = msg->data.result;
+        FileData *fData = NULL;
+        curl_easy_getinfo(eh, CURLINFO_PRIVATE, &fData);
+        if (fData != NULL && fData->resumable != nullptr) {
+            long httpCode = 0;
+            curl_off_t elapsedUs = 0;
+            curl_easy_getinfo(eh, CURLINFO_RESPONSE_CODE, &httpCode);
+            curl_easy_getinfo(eh, CURLINFO_TOTAL_TIME_T, &elapsedUs);
+            ReleaseHandle(*fData);
+            fData->resumable->OnDone(static_cast<CURLcode>(returnCode), httpCode, elapsedUs / USEC_PER_MSEC);
+            ResumeStep step = fData->resumable->GetStep();
+            if (step == ResumeStep::DONE || step == ResumeStep::FAILED) {
+                finished++;
+                NotifyResult(*fData, step == ResumeStep::DONE);
+            } else {
+                resumeQueue_.push_back(fData);
+            }
+            continue;
+        }
+        finished++;
         if (returnCode != CURLE_OK) {
             if (config_->protocolVersion != "L5") {
                 FailNotify(UPLOAD_ERRORCODE_UPLOAD_FAIL);
                 UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "Curl error code = %{public}d", msg->data.result);
             }
-            continue;
+        } else {
+            long statusCode = 0;
+            curl_easy_getinfo(eh, CURLINFO_RESPONSE_CODE, &statusCode);
+            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "statusCode is %{public}ld, file index is %{public}u", statusCode,
+                fData != NULL ? fData->fileIndex : 0);
+        }
+        if (fData != NULL) {
+            ReleaseHandle(*fData);
+        }
+    }
+    if (finished > 0) {
+        FlushProgress();
+    }
+    return finished;
+}
+
+void CUrlAdp::ReleaseHandle(FileData &fileData)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (fileData.mcurl != nullptr) {
+        if (curlMulti_) {
+            curl_multi_remove_handle(curlMulti_, fileData.mcurl);
         }
-        int statusCode = 0;
-        char *szUrl = NULL;
-        curl_easy_getinfo(eh, CURLINFO_RESPONSE_CODE, &statusCode);
-        curl_easy_getinfo(eh, CURLINFO_PRIVATE, &szUrl);
-        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "statusCode is %{public}d, Url is %{public}s", statusCode, szUrl);
+        curl_easy_cleanup(fileData.mcurl);
+        fileData.mcurl = nullptr;
     }
+    if (fileData.mime != nullptr) {
+        curl_mime_free(fileData.mime);
+        fileData.mime = nullptr;
+    }
+    if (fileData.list != nullptr) {
+        curl_slist_free_all(fileData.list);
+        fileData.list = nullptr;
+    }
+    fileData.compressor = nullptr;
+    fileData.reader = nullptr;
 }
 
 bool CUrlAdp::Remove()
@@ -266,12 +810,10 @@ bool CUrlAdp::Remove()
 
 bool CUrlAdp::RemoveInner()
 {
-    std::lock_guard<std::mutex> guard(mutex_);
-    for (auto url : curlArray_) {
-        curl_multi_remove_handle(curlMulti_, url);
-        curl_easy_cleanup(url);
+    for (auto &vmem : fileArray_) {
+        ReleaseHandle(vmem);
     }
-    curlArray_.clear();
+    std::lock_guard<std::mutex> guard(mutex_);
     if (curlMulti_) {
         curl_multi_cleanup(curlMulti_);
         curlMulti_ = nullptr;
@@ -297,49 +839,106 @@ int CUrlAdp::OnDebug(CURL *curl, curl_infotype itype, char *pData, size_t size,
 }
 int CUrlAdp::ProgressCallback(void *clientp, curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
 {
-    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback thread id is %{public}lu", pthread_self());
     FileData *fData = (FileData *) clientp;
     CUrlAdp *url = (CUrlAdp *) fData->adp;
-    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback ultotal is %{public}" PRIu64, ultotal);
-    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback ulnow is %{public}" PRIu64, ulnow);
-    UPLOAD_HILOGD(
-        UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback fData->totalsize is %{public}" PRIu64, fData->totalsize);
-    if (ulnow > 0) {
-        fData->upsize = fData->totalsize - (ultotal - ulnow);
-    } else {
-        fData->upsize = ulnow;
+    if (url == nullptr) {
+        return 0;
+    }
+    int64_t upsize = ulnow;
+    if (fData->resumable != nullptr) {
+        // chunks go out one after another from the acknowledged offset
+        bool sending = fData->resumable->GetStep() == ResumeStep::SEND;
+        upsize = fData->resumable->GetOffset() + (sending ? ulnow : 0);
+    } else if (fData->compressor != nullptr) {
+        // ulnow counts compressed bytes, the file size is what the progress is measured against
+        upsize = fData->compressor->GetSourceSent();
+        ultotal = fData->totalsize;
+    } else if (url->expectedResponses_ < url->fileArray_.size()) {
+        // the one body carries every file, less the form fields and MIME framing that are not file content
+        int64_t framing = ultotal > 0 ? ultotal - url->batchFileSize_ : static_cast<int64_t>(ulnow);
+        upsize = std::min(std::max(static_cast<int64_t>(ulnow) - framing, static_cast<int64_t>(0)),
+            url->batchFileSize_);
+    } else if (ulnow > 0) {
+        upsize = fData->totalsize - (ultotal - ulnow);
     }
+    url->UpdateProgress(*fData, upsize);
+    url->NotifyProgress(dltotal, dlnow, ultotal);
+    return 0;
+}
 
-    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback fData->totalsize - (ultotal - ulnow) is %{public}lld",
-        (long long)fData->upsize);
-    int64_t totalulnow = 0;
-    if (url && url->uploadTask_) {
-        for (auto &vmem : url->fileArray_) {
-            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback vmem.name is %{public}s", vmem.name.c_str());
-            if (fData->name == vmem.name) {
-                vmem.upsize = fData->upsize;
-            }
-            totalulnow += vmem.upsize;
-            UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback vmem.upsize is %{public}lld", (
-			              long long)vmem.upsize);
-        }
-        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>ProgressCallback totalulnow is %{public}lld", (
-		              long long)totalulnow);
-        url->uploadTask_->OnProgress(dltotal, dlnow, ultotal, totalulnow);
+int CUrlAdp::PartProgressCallback(void *clientp,
+    curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal, curl_off_t ulnow)
+{
+    PartRequest *request = (PartRequest *) clientp;
+    FileData *fData = request->fileData;
+    CUrlAdp *url = (CUrlAdp *) fData->adp;
+    if (url == nullptr) {
+        return 0;
     }
+    if (request->part != nullptr) {
+        fData->parts->SetSent(*request->part, std::min(static_cast<int64_t>(ulnow), request->part->length));
+        url->UpdateProgress(*fData, fData->parts->GetSent());
+    }
+    url->NotifyProgress(dltotal, dlnow, fData->totalsize);
     return 0;
 }
 
+/**
+ * @brief Record the bytes sent of one file, the total moves by the difference so no file list is walked
+ */
+void CUrlAdp::UpdateProgress(const FileData &fileData, int64_t upsize)
+{
+    if (fileData.fileIndex == 0 || fileData.fileIndex > fileArray_.size()) {
+        return;
+    }
+    int64_t previous = fileProgress_[fileData.fileIndex - 1].exchange(upsize);
+    totalProgress_ += upsize - previous;
+}
+
+/**
+ * @brief Hand the total to the task at most every PROGRESS_INTERVAL_MS and only once it moved by
+ * PROGRESS_MIN_DELTA, every report takes the task lock and queues a JS callback
+ */
+void CUrlAdp::NotifyProgress(curl_off_t dltotal, curl_off_t dlnow, curl_off_t ultotal)
+{
+    notifiedTotal_ = ultotal;
+    int64_t total = totalProgress_;
+    int64_t now = UploadWatchdog::Now();
+    if (uploadTask_ == nullptr || now - notifiedTime_ < PROGRESS_INTERVAL_MS ||
+        std::abs(total - notifiedProgress_) < PROGRESS_MIN_DELTA) {
+        return;
+    }
+    notifiedProgress_ = total;
+    notifiedTime_ = now;
+    uploadTask_->OnProgress(dltotal, dlnow, ultotal, total);
+}
+
+/**
+ * @brief Report what the rate limit held back, called when a transfer ends so the final count arrives
+ */
+void CUrlAdp::FlushProgress()
+{
+    int64_t total = totalProgress_;
+    if (uploadTask_ == nullptr || total == notifiedProgress_) {
+        return;
+    }
+    notifiedProgress_ = total;
+    notifiedTime_ = UploadWatchdog::Now();
+    uploadTask_->OnProgress(0, 0, notifiedTotal_, total);
+}
+
 size_t CUrlAdp::HeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata)
 {
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "HeaderCallback size is %{public}zu, nitems is %{public}zu", size, nitems);
     FileData *fData = (FileData *) userdata;
     CUrlAdp *url = (CUrlAdp *) fData->adp;
-    std::string stmp(buffer, size * nitems);
+    size_t realSize = size * nitems;
+    std::string stmp(buffer, realSize);
     uint32_t isize = 1;
     const int32_t codeOk = 200;
+    const int32_t codeContinue = 100;
 
-    if (std::string::npos != stmp.find("HTTP")) {
+    if (stmp.compare(0, statusLinePrefix.size(), statusLinePrefix) == 0) {
         fData->headSendFlag = collectDoFlag;
         UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>HeaderCallback collect begin  is %{public}s", stmp.c_str());
         const int codeLen = 3;
@@ -353,6 +952,12 @@ size_t CUrlAdp::HeaderCallback(char *buffer, size_t size, size_t nitems, void *u
     if (collectDoFlag == fData->headSendFlag || collectEndFlag == fData->headSendFlag) {
         fData->responseHead.push_back(stmp);
     }
+    if (collectEndFlag == fData->headSendFlag && fData->httpCode >= codeContinue && fData->httpCode < codeOk) {
+        // an interim 100 Continue, the final response follows on the same transfer
+        fData->responseHead.clear();
+        fData->httpCode = 0;
+        return realSize;
+    }
     if (url && url->uploadTask_ && collectEndFlag == fData->headSendFlag) {
         std::string stoatalHead = "";
         for (auto &smem : fData->responseHead) {
@@ -375,8 +980,9 @@ size_t CUrlAdp::HeaderCallback(char *buffer, size_t size, size_t nitems, void *u
             stoatalHead.length());
         nitems = stoatalHead.length();
         size = isize;
+        bool isLast = fData->httpCode >= codeOk && url->IsLastResponse();
         if (codeOk == fData->httpCode) {
-            if (url->fileArray_.size() == fData->fileIndex) {
+            if (isLast) {
                 url->uploadTask_->OnHeaderReceive(sbuff, size, nitems);
             }
         } else {
@@ -385,19 +991,21 @@ size_t CUrlAdp::HeaderCallback(char *buffer, size_t size, size_t nitems, void *u
         fData->responseHead.clear();
         fData->httpCode = 0;
     }
-    return size * nitems;
+    return realSize;
 }
 
 size_t CUrlAdp::HeaderCallbackL5(char *buffer, size_t size, size_t nitems, void *userdata)
 {
     FileData *fData = (FileData *) userdata;
     CUrlAdp *url = (CUrlAdp *) fData->adp;
-    std::string stmp(buffer, size * nitems);
+    size_t realSize = size * nitems;
+    std::string stmp(buffer, realSize);
     uint32_t isize = 1;
     const int32_t codeOk = 200;
+    const int32_t codeContinue = 100;
     UploadResponse resData;
 
-    if (std::string::npos != stmp.find("HTTP")) {
+    if (stmp.compare(0, statusLinePrefix.size(), statusLinePrefix) == 0) {
         fData->headSendFlag = collectDoFlag;
         const int codeLen = 3;
         std::string::size_type position = stmp.find_first_of(" ");
@@ -409,6 +1017,12 @@ size_t CUrlAdp::HeaderCallbackL5(char *buffer, size_t size, size_t nitems, void
     if (collectDoFlag == fData->headSendFlag || collectEndFlag == fData->headSendFlag) {
         fData->responseHead.push_back(stmp);
     }
+    if (collectEndFlag == fData->headSendFlag && fData->httpCode >= codeContinue && fData->httpCode < codeOk) {
+        // an interim 100 Continue, the final response follows on the same transfer
+        fData->responseHead.clear();
+        fData->httpCode = 0;
+        return realSize;
+    }
     if (url && url->uploadTask_ && collectEndFlag == fData->headSendFlag) {
         std::string stoatalHead = "";
         for (auto &smem : fData->responseHead) {
@@ -416,8 +1030,9 @@ size_t CUrlAdp::HeaderCallbackL5(char *buffer, size_t size, size_t nitems, void
         }
         size = isize;
         nitems = stoatalHead.length();
+        bool isLast = fData->httpCode >= codeOk && url->IsLastResponse();
         if (codeOk == fData->httpCode) {
-            if (url->fileArray_.size() == fData->fileIndex && url->config_->fsuccess != nullptr) {
+            if (isLast && url->config_->fsuccess != nullptr) {
                 resData.headers = stoatalHead;
                 resData.code = fData->httpCode;
                 UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "===>HeaderCallbackL5 success response head is %{public}s",
@@ -433,7 +1048,55 @@ size_t CUrlAdp::HeaderCallbackL5(char *buffer, size_t size, size_t nitems, void
         fData->responseHead.clear();
         fData->httpCode = 0;
     }
-    return size * nitems;
+    return realSize;
+}
+
+size_t CUrlAdp::ResumableHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    FileData *fData = (FileData *) userdata;
+    size_t realSize = size * nitems;
+    std::string stmp(buffer, realSize);
+    fData->resumable->OnHeader(stmp);
+    if (stmp.compare(0, statusLinePrefix.size(), statusLinePrefix) == 0) {
+        const int codeLen = 3;
+        std::string::size_type position = stmp.find_first_of(" ");
+        fData->httpCode = std::stol(std::string(stmp, position + 1, codeLen));
+        fData->responseHead.clear();
+    }
+    // kept until the upload ends, the head of the last response is what gets reported
+    fData->responseHead.push_back(stmp);
+    return realSize;
+}
+
+size_t CUrlAdp::PartHeaderCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    PartRequest *request = (PartRequest *) userdata;
+    size_t realSize = size * nitems;
+    std::string stmp(buffer, realSize);
+    if (stmp.compare(0, statusLinePrefix.size(), statusLinePrefix) == 0) {
+        // a new response, the one before was a 100 Continue or a redirect
+        request->head.clear();
+        request->etag.clear();
+    }
+    request->head += stmp;
+    if (stmp.size() > etagHeader.size() && strncasecmp(stmp.c_str(), etagHeader.c_str(), etagHeader.size()) == 0) {
+        size_t begin = stmp.find_first_not_of(" \t", etagHeader.size());
+        size_t end = stmp.find_last_not_of(" \t\r\n");
+        if (begin != std::string::npos && end != std::string::npos && end >= begin) {
+            request->etag = stmp.substr(begin, end - begin + 1);
+        }
+    }
+    return realSize;
+}
+
+size_t CUrlAdp::PartWriteCallback(char *buffer, size_t size, size_t nitems, void *userdata)
+{
+    PartRequest *request = (PartRequest *) userdata;
+    size_t realSize = size * nitems;
+    if (request->body.size() < MAX_PART_RESPONSE_BODY) {
+        request->body.append(buffer, std::min(realSize, MAX_PART_RESPONSE_BODY - request->body.size()));
+    }
+    return realSize;
 }
 
 size_t CUrlAdp::ReadCallback(char *buffer, size_t size, size_t nitems, void *arg)
@@ -445,65 +1108,100 @@ size_t CUrlAdp::ReadCallback(char *buffer, size_t size, size_t nitems, void *arg
         UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "adp is null");
         return CURL_READFUNC_ABORT;
     }
-    std::lock_guard<std::mutex> guard(adp->readMutex_);
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "isReadAbort is %{public}d", adp->IsReadAbort());
-    if (ferror(read->fp) || adp->IsReadAbort()) {
-        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "read abort or ferror");
+    return adp->ReadFile(read->reader.get(), read->compressor.get(), buffer, size * nitems);
+}
+
+size_t CUrlAdp::MimeReadCallback(char *buffer, size_t size, size_t nitems, void *arg)
+{
+    FileData *read = (FileData *) arg;
+    CUrlAdp *adp = (CUrlAdp *) read->adp;
+    if (adp == nullptr || read->reader == nullptr) {
         return CURL_READFUNC_ABORT;
     }
-    adp->StartTimer();
-    size_t readSize = fread(buffer, size, nitems, read->fp);
-    adp->StopTimer();
-
+    UploadFileReader *reader = read->reader.get();
+    if (!reader->IsOpened() && !reader->Open(adp->config_->bufferSize, adp->config_->useMmap)) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "open file %{public}u fail", read->fileIndex);
+        return CURL_READFUNC_ABORT;
+    }
+    size_t readSize = adp->ReadFile(reader, nullptr, buffer, size * nitems);
+    if (readSize == 0) {
+        reader->Close();
+    }
     return readSize;
 }
 
-void CUrlAdp::FailNotify(unsigned int error)
+size_t CUrlAdp::PartReadCallback(char *buffer, size_t size, size_t nitems, void *arg)
 {
-    if (uploadTask_) {
-        if (config_->protocolVersion != "L5") {
-            uploadTask_->OnFail(error);
-        }
+    PartRequest *request = (PartRequest *) arg;
+    CUrlAdp *adp = (CUrlAdp *) request->fileData->adp;
+    if (adp == nullptr) {
+        return CURL_READFUNC_ABORT;
     }
+    return adp->ReadFile(request->reader.get(), nullptr, buffer, size * nitems);
 }
 
-void CUrlAdp::InitTimerInfo()
+size_t CUrlAdp::ReadFile(UploadFileReader *reader, UploadCompressor *compressor, char *buffer, size_t size)
 {
-    timerInfo_ = std::make_shared<UploadTimerInfo>();
-    timerInfo_->SetType(TIMEOUTTYPE);
-    timerInfo_->SetRepeat(false);
-    timerInfo_->SetInterval(READFILE_TIMEOUT_MS);
-    timerInfo_->SetWantAgent(nullptr);
+    if (reader == nullptr || IsReadAbort()) {
+        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "read abort or no reader");
+        return CURL_READFUNC_ABORT;
+    }
+    readDeadline_ = UploadWatchdog::Now() + READFILE_TIMEOUT_MS;
+    ssize_t readSize = compressor != nullptr ? compressor->Read(buffer, size) : reader->Read(buffer, size);
+    readDeadline_ = 0;
+    if (readSize < 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "read file error");
+        return CURL_READFUNC_ABORT;
+    }
+    return static_cast<size_t>(readSize);
+}
 
-    timerInfo_->SetCallbackInfo([this]() {
-        this->FailNotify(UPLOAD_ERRORCODE_UPLOAD_OUTTIME);
-        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "OutTime error");
-        this->isReadAbort_ = true;
-        });
+/**
+ * @brief Count a final response. Files finish in any order, a success is reported with the response
+ * that completes the batch.
+ */
+bool CUrlAdp::IsLastResponse()
+{
+    return ++respondedCount_ == expectedResponses_;
 }
 
-void CUrlAdp::StartTimer()
+/**
+ * @brief Report the end of a file sent in several requests, with the head of its last response
+ */
+void CUrlAdp::NotifyResult(FileData &fileData, bool success)
 {
-    timerId_ = MiscServices::TimeServiceClient::GetInstance()->CreateTimer(timerInfo_);
-    if (timerId_ == 0) {
-        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "Create Timer error");
+    std::string head;
+    for (auto &smem : fileData.responseHead) {
+        head += smem;
+    }
+    fileData.responseHead.clear();
+    bool isLast = IsLastResponse();
+    if (config_->protocolVersion == "L5") {
+        if (success && isLast && config_->fsuccess != nullptr) {
+            UploadResponse resData;
+            resData.headers = head;
+            resData.code = fileData.httpCode;
+            config_->fsuccess(resData);
+        } else if (!success && config_->ffail != nullptr) {
+            config_->ffail(head, fileData.httpCode);
+        }
         return;
     }
-
-    bool ret = MiscServices::TimeServiceClient::GetInstance()->StartTimer(timerId_, READFILE_TIMEOUT_MS);
-    if (ret != true) {
-        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "Start Timer error");
-        MiscServices::TimeServiceClient::GetInstance()->DestroyTimer(timerId_);
-        timerId_ = 0;
+    if (!success) {
+        FailNotify(UPLOAD_ERRORCODE_UPLOAD_FAIL);
+    }
+    if (uploadTask_ != nullptr && !head.empty() && (!success || isLast)) {
+        uploadTask_->OnHeaderReceive(head.data(), 1, head.size());
     }
-
-    return;
 }
 
-void CUrlAdp::StopTimer()
+void CUrlAdp::FailNotify(unsigned int error)
 {
-    bool ret = MiscServices::TimeServiceClient::GetInstance()->StopTimer(timerId_);
-    ret = MiscServices::TimeServiceClient::GetInstance()->DestroyTimer(timerId_);
-    return;
+    if (uploadTask_) {
+        if (config_->protocolVersion != "L5") {
+            uploadTask_->OnFail(error);
+        }
+    }
 }
 } // namespace OHOS::Request::Upload
\ No newline at end of file
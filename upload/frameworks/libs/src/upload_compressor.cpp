@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_compressor.h"
+#include <algorithm>
+#include "securec.h"
+#include "upload_file_reader.h"
+#include "upload_hilog_wrapper.h"
+#include "zlib.h"
+
+namespace OHOS::Request::Upload {
+namespace {
+const std::string GZIP_ENCODING = "gzip";
+constexpr int GZIP_WRAPPER_BITS = 16;
+constexpr int MEM_LEVEL = 8;
+} // namespace
+
+UploadCompressor::UploadCompressor(std::shared_ptr<UploadFileReader> source) : source_(source), sourceSent_(0)
+{
+}
+
+UploadCompressor::~UploadCompressor()
+{
+    Stop();
+}
+
+bool UploadCompressor::IsSupported(const std::string &encoding)
+{
+    return encoding == GZIP_ENCODING;
+}
+
+bool UploadCompressor::Start(size_t blockSize)
+{
+    if (source_ == nullptr || blockSize == 0) {
+        return false;
+    }
+    blockSize_ = blockSize;
+    thread_ = std::thread(&UploadCompressor::Compress, this);
+    return true;
+}
+
+void UploadCompressor::Stop()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+/**
+ * @brief Copy the next compressed bytes
+ *
+ * @return the number of bytes copied, 0 at the end of the stream and -1 when reading or compressing failed
+ */
+ssize_t UploadCompressor::Read(char *buffer, size_t size)
+{
+    if (buffer == nullptr || size == 0) {
+        return 0;
+    }
+    if (!hasCurrent_) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() { return !chunks_.empty() || finished_ || error_ || stop_; });
+        if (error_ || stop_) {
+            return -1;
+        }
+        if (chunks_.empty()) {
+            return 0;
+        }
+        current_ = std::move(chunks_.front());
+        chunks_.pop_front();
+        consumed_ = 0;
+        hasCurrent_ = true;
+        lock.unlock();
+        cond_.notify_all();
+    }
+    size_t copied = std::min(size, current_.data.size() - consumed_);
+    if (memcpy_s(buffer, size, current_.data.data() + consumed_, copied) != 0) {
+        return -1;
+    }
+    consumed_ += copied;
+    if (consumed_ == current_.data.size()) {
+        // progress counts source bytes, a block counts once all of its output is handed over
+        sourceSent_ = current_.sourceEnd;
+        hasCurrent_ = false;
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+void UploadCompressor::Compress()
+{
+    z_stream stream = {};
+    if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + GZIP_WRAPPER_BITS, MEM_LEVEL,
+        Z_DEFAULT_STRATEGY) != Z_OK) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "deflate init failed");
+        Finish(true);
+        return;
+    }
+    std::vector<char> input(blockSize_);
+    int64_t sourceRead = 0;
+    int flush = Z_NO_FLUSH;
+    bool ok = true;
+    while (ok && flush != Z_FINISH) {
+        ssize_t got = source_->Read(input.data(), input.size());
+        if (got < 0) {
+            ok = false;
+            break;
+        }
+        sourceRead += got;
+        flush = got == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef *>(input.data());
+        stream.avail_in = static_cast<uInt>(got);
+        do {
+            Chunk chunk;
+            chunk.data.resize(blockSize_);
+            stream.next_out = reinterpret_cast<Bytef *>(chunk.data.data());
+            stream.avail_out = static_cast<uInt>(blockSize_);
+            if (deflate(&stream, flush) == Z_STREAM_ERROR) {
+                ok = false;
+                break;
+            }
+            chunk.data.resize(blockSize_ - stream.avail_out);
+            chunk.sourceEnd = sourceRead - stream.avail_in;
+            if (!chunk.data.empty() && !Push(chunk)) {
+                ok = false;
+                break;
+            }
+        } while (stream.avail_out == 0);
+    }
+    deflateEnd(&stream);
+    Finish(!ok);
+}
+
+bool UploadCompressor::Push(Chunk &chunk)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return chunks_.size() < QUEUE_DEPTH || stop_; });
+    if (stop_) {
+        return false;
+    }
+    chunks_.push_back(std::move(chunk));
+    lock.unlock();
+    cond_.notify_all();
+    return true;
+}
+
+void UploadCompressor::Finish(bool error)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (error && !stop_) {
+            UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "compress upload source failed");
+        }
+        error_ = error;
+        finished_ = true;
+    }
+    cond_.notify_all();
+}
+} // namespace OHOS::Request::Upload
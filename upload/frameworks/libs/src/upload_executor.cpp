@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_executor.h"
+#include <algorithm>
+#include "upload_hilog_wrapper.h"
+
+namespace OHOS::Request::Upload {
+UploadExecutor &UploadExecutor::GetInstance()
+{
+    static UploadExecutor instance;
+    return instance;
+}
+
+UploadExecutor::~UploadExecutor()
+{
+    std::vector<ExecutorJob> aborts;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+        queue_.clear();
+        for (auto &item : running_) {
+            aborts.push_back(item.second);
+        }
+    }
+    cond_.notify_all();
+    // the workers are joined below, an upload still going would hold the process exit until it ends
+    for (auto &abort : aborts) {
+        abort();
+    }
+    for (auto &worker : workers_) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+}
+
+/**
+ * @brief Queue a job, a higher priority runs earlier
+ *
+ * @param abort makes the job return early once it runs, may be null
+ * @return the id to cancel the job with while it waits, 0 when nothing was queued
+ */
+uint64_t UploadExecutor::Submit(ExecutorJob job, int32_t priority, ExecutorJob abort)
+{
+    if (job == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (stop_) {
+        return 0;
+    }
+    uint64_t id = nextId_++;
+    auto position = std::find_if(queue_.begin(), queue_.end(),
+        [priority](const Entry &entry) { return entry.priority < priority; });
+    queue_.insert(position, { id, priority, std::move(job), std::move(abort) });
+    SpawnWorkers();
+    cond_.notify_one();
+    UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "job %{public}llu queued, %{public}zu waiting",
+        (unsigned long long)id, queue_.size());
+    return id;
+}
+
+/**
+ * @brief Drop a job that has not started yet
+ *
+ * @return true when the job was still waiting and will not run
+ */
+bool UploadExecutor::Cancel(uint64_t id)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    auto position = std::find_if(queue_.begin(), queue_.end(), [id](const Entry &entry) { return entry.id == id; });
+    if (position == queue_.end()) {
+        return false;
+    }
+    queue_.erase(position);
+    return true;
+}
+
+void UploadExecutor::SetMaxWorkers(uint32_t count)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (count > 0) {
+        maxWorkers_ = count;
+        SpawnWorkers();
+    }
+}
+
+void UploadExecutor::SpawnWorkers()
+{
+    // idle workers pick the queued jobs up first, a new thread only covers what they cannot
+    while (queue_.size() > idle_ && workers_.size() < maxWorkers_) {
+        workers_.emplace_back(&UploadExecutor::Work, this);
+        idle_++;
+    }
+}
+
+void UploadExecutor::Work()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+        if (stop_) {
+            return;
+        }
+        Entry entry = std::move(queue_.front());
+        queue_.pop_front();
+        idle_--;
+        if (entry.abort != nullptr) {
+            running_[entry.id] = entry.abort;
+        }
+        lock.unlock();
+        entry.job();
+        lock.lock();
+        running_.erase(entry.id);
+        idle_++;
+    }
+}
+} // namespace OHOS::Request::Upload
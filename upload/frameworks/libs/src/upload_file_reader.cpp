@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_file_reader.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include "securec.h"
+#include "upload_hilog_wrapper.h"
+
+namespace OHOS::Request::Upload {
+UploadFileReader::UploadFileReader(int fd, int64_t offset, int64_t length)
+    : fd_(fd), offset_(offset), length_(length)
+{
+}
+
+UploadFileReader::~UploadFileReader()
+{
+    Close();
+}
+
+size_t UploadFileReader::ClampBufferSize(size_t bufferSize)
+{
+    if (bufferSize == 0) {
+        return DEFAULT_BUFFER_SIZE;
+    }
+    return std::min(std::max(bufferSize, MIN_BUFFER_SIZE), MAX_BUFFER_SIZE);
+}
+
+bool UploadFileReader::Open(size_t bufferSize, bool useMmap)
+{
+    if (fd_ < 0 || offset_ < 0 || length_ < 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "invalid reader range");
+        return false;
+    }
+    opened_ = true;
+    bufferSize = ClampBufferSize(bufferSize);
+    (void)posix_fadvise(fd_, offset_, length_, POSIX_FADV_SEQUENTIAL);
+    (void)readahead(fd_, offset_, std::min(static_cast<size_t>(length_), bufferSize * 2));
+    if (useMmap && Map()) {
+        return true;
+    }
+    for (auto &block : blocks_) {
+        block.data.resize(bufferSize);
+    }
+    thread_ = std::thread(&UploadFileReader::Prefetch, this);
+    return true;
+}
+
+bool UploadFileReader::Map()
+{
+    if (length_ == 0) {
+        return false;
+    }
+    long pageSize = sysconf(_SC_PAGESIZE);
+    if (pageSize <= 0) {
+        return false;
+    }
+    mappedDelta_ = static_cast<size_t>(offset_ % pageSize);
+    mappedLength_ = static_cast<size_t>(length_) + mappedDelta_;
+    void *addr = mmap(nullptr, mappedLength_, PROT_READ, MAP_PRIVATE, fd_, offset_ - mappedDelta_);
+    if (addr == MAP_FAILED) {
+        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "mmap failed, errno %{public}d, fall back to reads", errno);
+        mappedLength_ = 0;
+        return false;
+    }
+    (void)madvise(addr, mappedLength_, MADV_SEQUENTIAL);
+    mapped_ = addr;
+    return true;
+}
+
+void UploadFileReader::Close()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (mapped_ != nullptr) {
+        munmap(mapped_, mappedLength_);
+        mapped_ = nullptr;
+    }
+}
+
+/**
+ * @brief Copy the next bytes of the range
+ *
+ * @return the number of bytes copied, 0 at the end of the range and -1 on a read error
+ */
+ssize_t UploadFileReader::Read(char *buffer, size_t size)
+{
+    if (buffer == nullptr || size == 0 || position_ >= length_) {
+        return 0;
+    }
+    size = static_cast<size_t>(std::min(static_cast<int64_t>(size), length_ - position_));
+    ssize_t copied = mapped_ != nullptr ? ReadMapped(buffer, size) : ReadBuffered(buffer, size);
+    if (copied > 0) {
+        position_ += copied;
+    }
+    return copied;
+}
+
+ssize_t UploadFileReader::ReadMapped(char *buffer, size_t size)
+{
+    const char *source = static_cast<const char *>(mapped_) + mappedDelta_ + position_;
+    if (memcpy_s(buffer, size, source, size) != 0) {
+        return -1;
+    }
+    return static_cast<ssize_t>(size);
+}
+
+ssize_t UploadFileReader::ReadBuffered(char *buffer, size_t size)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    Block &block = blocks_[current_];
+    cond_.wait(lock, [this, &block]() { return block.ready || error_ || stop_; });
+    if (!block.ready) {
+        return -1;
+    }
+    size_t copied = std::min(size, block.size - consumed_);
+    if (memcpy_s(buffer, size, block.data.data() + consumed_, copied) != 0) {
+        return -1;
+    }
+    consumed_ += copied;
+    if (consumed_ == block.size) {
+        // hand the block back to the prefetch thread and go on with the other one
+        block.ready = false;
+        consumed_ = 0;
+        current_ ^= 1;
+        lock.unlock();
+        cond_.notify_all();
+    }
+    return static_cast<ssize_t>(copied);
+}
+
+void UploadFileReader::Prefetch()
+{
+    int64_t fileOffset = offset_;
+    int64_t end = offset_ + length_;
+    size_t index = 0;
+    while (fileOffset < end) {
+        Block &block = blocks_[index];
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cond_.wait(lock, [this, &block]() { return !block.ready || stop_; });
+            if (stop_) {
+                return;
+            }
+        }
+        size_t want = static_cast<size_t>(std::min(static_cast<int64_t>(block.data.size()), end - fileOffset));
+        ssize_t got = ReadFully(block.data.data(), want, fileOffset);
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (got <= 0) {
+            // a file that shrank under us is as much an error as a failed read
+            UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "prefetch failed at %{public}lld", (long long)fileOffset);
+            error_ = true;
+            cond_.notify_all();
+            return;
+        }
+        block.size = static_cast<size_t>(got);
+        block.ready = true;
+        fileOffset += got;
+        index ^= 1;
+        cond_.notify_all();
+    }
+}
+
+ssize_t UploadFileReader::ReadFully(char *buffer, size_t size, int64_t offset)
+{
+    size_t done = 0;
+    while (done < size) {
+        ssize_t ret = pread(fd_, buffer + done, size - done, offset + done);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret < 0) {
+            return -1;
+        }
+        if (ret == 0) {
+            break;
+        }
+        done += static_cast<size_t>(ret);
+    }
+    return static_cast<ssize_t>(done);
+}
+} // namespace OHOS::Request::Upload
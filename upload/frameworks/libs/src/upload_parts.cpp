@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_parts.h"
+#include <algorithm>
+#include <climits>
+#include "upload_hilog_wrapper.h"
+
+namespace OHOS::Request::Upload {
+namespace {
+constexpr long HTTP_OK = 200;
+constexpr long HTTP_MULTIPLE_CHOICES = 300;
+constexpr long HTTP_SERVER_ERROR = 500;
+constexpr int64_t RETRY_BASE_MS = 1000;
+constexpr int64_t RETRY_MAX_MS = 30 * 1000;
+const std::string UPLOAD_ID_TAG = "UploadId";
+const std::string ERROR_TAG = "Error";
+
+bool IsSuccess(long httpCode)
+{
+    return httpCode >= HTTP_OK && httpCode < HTTP_MULTIPLE_CHOICES;
+}
+
+bool IsTransient(CURLcode result, long httpCode)
+{
+    return result != CURLE_OK || httpCode >= HTTP_SERVER_ERROR;
+}
+} // namespace
+
+UploadParts::UploadParts(const std::string &url, int64_t size, int64_t partSize) : url_(url), size_(size)
+{
+    // the part number is capped, so very large files get larger parts
+    int64_t minimum = (size + MAX_PARTS - 1) / MAX_PARTS;
+    partSize = std::max(std::max(partSize, MIN_PART_SIZE), minimum);
+    uint32_t number = 1;
+    for (int64_t offset = 0; offset < size || number == 1; offset += partSize) {
+        UploadPart part;
+        part.number = number++;
+        part.offset = offset;
+        part.length = std::min(partSize, size - offset);
+        parts_.push_back(part);
+    }
+}
+
+std::string UploadParts::ParseTag(const std::string &body, const std::string &tag)
+{
+    std::string open = "<" + tag + ">";
+    std::string close = "</" + tag + ">";
+    size_t begin = body.find(open);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    begin += open.size();
+    size_t end = body.find(close, begin);
+    return end == std::string::npos ? "" : body.substr(begin, end - begin);
+}
+
+std::string UploadParts::MakeUrl(const std::string &query) const
+{
+    return url_ + (url_.find('?') == std::string::npos ? "?" : "&") + query;
+}
+
+/**
+ * @brief Claim the initiate or complete request when it is due, only one of them runs at a time
+ */
+bool UploadParts::TakeControlRequest(int64_t now)
+{
+    if ((step_ != PartStep::INITIATE && step_ != PartStep::COMPLETE) || busy_ || retryTime_ > now) {
+        return false;
+    }
+    busy_ = true;
+    return true;
+}
+
+UploadPart *UploadParts::TakePart(int64_t now)
+{
+    if (step_ != PartStep::PARTS) {
+        return nullptr;
+    }
+    for (auto &part : parts_) {
+        if (!part.done && !part.running && part.retryTime <= now) {
+            part.running = true;
+            SetSent(part, 0);
+            return &part;
+        }
+    }
+    return nullptr;
+}
+
+struct curl_slist *UploadParts::PrepareInitiate(CURL *curl, struct curl_slist *list)
+{
+    std::string url = MakeUrl("uploads");
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+    return list;
+}
+
+struct curl_slist *UploadParts::PreparePart(CURL *curl, struct curl_slist *list, const UploadPart &part)
+{
+    char *uploadId = curl_easy_escape(curl, uploadId_.c_str(), uploadId_.size());
+    std::string url = MakeUrl("partNumber=" + std::to_string(part.number) + "&uploadId=" +
+        (uploadId != nullptr ? uploadId : ""));
+    curl_free(uploadId);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(part.length));
+    return curl_slist_append(list, "Expect:");
+}
+
+struct curl_slist *UploadParts::PrepareComplete(CURL *curl, struct curl_slist *list, std::string &payload)
+{
+    char *uploadId = curl_easy_escape(curl, uploadId_.c_str(), uploadId_.size());
+    std::string url = MakeUrl(std::string("uploadId=") + (uploadId != nullptr ? uploadId : ""));
+    curl_free(uploadId);
+    payload = "<CompleteMultipartUpload>";
+    for (auto &part : parts_) {
+        payload += "<Part><PartNumber>" + std::to_string(part.number) + "</PartNumber><ETag>" + part.etag +
+            "</ETag></Part>";
+    }
+    payload += "</CompleteMultipartUpload>";
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, payload.c_str());
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(payload.size()));
+    return curl_slist_append(list, "Content-Type: application/xml");
+}
+
+/**
+ * @brief Drop the parts stored so far, the server keeps them for an upload that is never completed
+ */
+struct curl_slist *UploadParts::PrepareAbort(CURL *curl, struct curl_slist *list)
+{
+    char *uploadId = curl_easy_escape(curl, uploadId_.c_str(), uploadId_.size());
+    std::string url = MakeUrl(std::string("uploadId=") + (uploadId != nullptr ? uploadId : ""));
+    curl_free(uploadId);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
+    return list;
+}
+
+void UploadParts::OnInitiateDone(CURLcode result, long httpCode, const std::string &body, int64_t now)
+{
+    busy_ = false;
+    if (IsTransient(result, httpCode)) {
+        Retry(retries_, retryTime_, now);
+        return;
+    }
+    uploadId_ = ParseTag(body, UPLOAD_ID_TAG);
+    if (!IsSuccess(httpCode) || uploadId_.empty()) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "initiate part upload failed, http %{public}ld", httpCode);
+        step_ = PartStep::FAILED;
+        return;
+    }
+    retries_ = 0;
+    step_ = PartStep::PARTS;
+}
+
+void UploadParts::OnPartDone(UploadPart &part, CURLcode result, long httpCode, const std::string &etag, int64_t now)
+{
+    part.running = false;
+    if (step_ != PartStep::PARTS) {
+        return;
+    }
+    if (result == CURLE_OK && IsSuccess(httpCode) && !etag.empty()) {
+        part.done = true;
+        SetSent(part, part.length);
+        part.etag = etag;
+        bool allDone = std::all_of(parts_.begin(), parts_.end(), [](const UploadPart &item) { return item.done; });
+        if (allDone) {
+            step_ = PartStep::COMPLETE;
+        }
+        return;
+    }
+    SetSent(part, 0);
+    UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "part %{public}u failed, curl %{public}d http %{public}ld", part.number,
+        result, httpCode);
+    if (!IsTransient(result, httpCode) && !IsSuccess(httpCode)) {
+        step_ = PartStep::FAILED;
+        return;
+    }
+    Retry(part.retries, part.retryTime, now);
+}
+
+void UploadParts::OnCompleteDone(CURLcode result, long httpCode, const std::string &body, int64_t now)
+{
+    busy_ = false;
+    // the join can fail after a 200 has gone out, the error is then in the body
+    bool bodyError = body.find("<" + ERROR_TAG + ">") != std::string::npos;
+    if (IsTransient(result, httpCode) || (IsSuccess(httpCode) && bodyError)) {
+        Retry(retries_, retryTime_, now);
+        return;
+    }
+    step_ = IsSuccess(httpCode) ? PartStep::DONE : PartStep::FAILED;
+}
+
+bool UploadParts::Retry(uint32_t &retries, int64_t &retryTime, int64_t now)
+{
+    if (++retries > MAX_RETRIES) {
+        step_ = PartStep::FAILED;
+        return false;
+    }
+    retryTime = now + std::min(RETRY_BASE_MS << (retries - 1), RETRY_MAX_MS);
+    return true;
+}
+
+/**
+ * @brief Record the bytes sent of one part, the total moves by the difference so no part list is walked
+ */
+void UploadParts::SetSent(UploadPart &part, int64_t sent)
+{
+    sent_ += sent - part.sent;
+    part.sent = sent;
+}
+
+/**
+ * @brief When the next request that is not running yet may start, INT64_MAX when there is none
+ */
+int64_t UploadParts::GetNextRetryTime() const
+{
+    int64_t next = INT64_MAX;
+    if ((step_ == PartStep::INITIATE || step_ == PartStep::COMPLETE) && !busy_) {
+        next = retryTime_;
+    } else if (step_ == PartStep::PARTS) {
+        for (auto &part : parts_) {
+            if (!part.done && !part.running) {
+                next = std::min(next, part.retryTime);
+            }
+        }
+    }
+    return next;
+}
+} // namespace OHOS::Request::Upload
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_resumable.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <fstream>
+#include <sstream>
+#include "upload_hilog_wrapper.h"
+#include "upload_watchdog.h"
+
+namespace OHOS::Request::Upload {
+namespace {
+const std::string TUS_VERSION_HEADER = "Tus-Resumable: 1.0.0";
+const std::string CHECKPOINT_MAGIC = "tus 1";
+const std::string CHECKPOINT_SUFFIX = ".tus";
+const std::string LOCATION_HEADER = "location:";
+const std::string OFFSET_HEADER = "upload-offset:";
+const std::string STATUS_PREFIX = "HTTP/";
+const std::string SCHEME_SEPARATOR = "://";
+constexpr long HTTP_OK = 200;
+constexpr long HTTP_CREATED = 201;
+constexpr long HTTP_NO_CONTENT = 204;
+constexpr long HTTP_FORBIDDEN = 403;
+constexpr long HTTP_NOT_FOUND = 404;
+constexpr long HTTP_CONFLICT = 409;
+constexpr long HTTP_GONE = 410;
+constexpr long HTTP_SERVER_ERROR = 500;
+constexpr int64_t MS_PER_SECOND = 1000;
+constexpr int64_t RETRY_BASE_MS = 1000;
+constexpr int64_t RETRY_MAX_MS = 30 * 1000;
+constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+bool StartsWithNoCase(const std::string &line, const std::string &prefix)
+{
+    if (line.size() < prefix.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < prefix.size(); i++) {
+        if (tolower(static_cast<unsigned char>(line[i])) != prefix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string TrimValue(const std::string &line, size_t start)
+{
+    size_t begin = line.find_first_not_of(" \t", start);
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = line.find_last_not_of(" \t\r\n");
+    return line.substr(begin, end - begin + 1);
+}
+} // namespace
+
+UploadResumable::UploadResumable(const std::string &url, int64_t size, const std::string &checkpointPath)
+    : url_(url), size_(size), checkpointPath_(checkpointPath)
+{
+}
+
+std::string UploadResumable::MakeCheckpointPath(const std::string &dir, const std::string &fileKey)
+{
+    if (dir.empty()) {
+        return "";
+    }
+    uint64_t hash = FNV_OFFSET;
+    for (unsigned char c : fileKey) {
+        hash = (hash ^ c) * FNV_PRIME;
+    }
+    char name[sizeof(uint64_t) * 2 + 1] = {0};
+    if (snprintf(name, sizeof(name), "%016" PRIx64, hash) < 0) {
+        return "";
+    }
+    return dir + "/" + name + CHECKPOINT_SUFFIX;
+}
+
+/**
+ * @brief Pick up an upload an earlier run left behind. The saved offset is only a hint, the server is queried
+ * for the real one before anything is sent.
+ */
+void UploadResumable::Load(const std::string &fileKey)
+{
+    fileKey_ = fileKey;
+    if (checkpointPath_.empty()) {
+        return;
+    }
+    std::ifstream in(checkpointPath_);
+    std::string magic;
+    std::string key;
+    std::string location;
+    std::string offset;
+    if (!std::getline(in, magic) || magic != CHECKPOINT_MAGIC || !std::getline(in, key) || key != fileKey_ ||
+        !std::getline(in, location) || location.empty() || !std::getline(in, offset)) {
+        return;
+    }
+    location_ = location;
+    offset_ = std::min(std::max(strtoll(offset.c_str(), nullptr, 10), 0LL), static_cast<long long>(size_));
+    step_ = ResumeStep::QUERY;
+    UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "resume upload at %{public}" PRId64, offset_);
+}
+
+void UploadResumable::Save()
+{
+    if (checkpointPath_.empty()) {
+        return;
+    }
+    std::string dir = checkpointPath_.substr(0, checkpointPath_.rfind('/'));
+    if (mkdir(dir.c_str(), S_IRWXU) != 0 && errno != EEXIST) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "create checkpoint dir failed, errno %{public}d", errno);
+        return;
+    }
+    std::ostringstream out;
+    out << CHECKPOINT_MAGIC << "\n" << fileKey_ << "\n" << location_ << "\n" << offset_ << "\n";
+    std::string content = out.str();
+    std::string tmpPath = checkpointPath_ + ".tmp";
+    int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "open checkpoint failed, errno %{public}d", errno);
+        return;
+    }
+    bool written = write(fd, content.data(), content.size()) == static_cast<ssize_t>(content.size());
+    written = fdatasync(fd) == 0 && written;
+    close(fd);
+    if (!written || rename(tmpPath.c_str(), checkpointPath_.c_str()) != 0) {
+        UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "save checkpoint failed");
+        unlink(tmpPath.c_str());
+    }
+}
+
+void UploadResumable::Remove()
+{
+    if (!checkpointPath_.empty()) {
+        unlink(checkpointPath_.c_str());
+    }
+}
+
+int64_t UploadResumable::GetChunkLength() const
+{
+    return std::min(chunkSize_, size_ - offset_);
+}
+
+struct curl_slist *UploadResumable::Prepare(CURL *curl, struct curl_slist *list)
+{
+    newLocation_.clear();
+    serverOffset_ = -1;
+    sending_ = 0;
+    list = curl_slist_append(list, TUS_VERSION_HEADER.c_str());
+    if (step_ == ResumeStep::CREATE) {
+        std::string length = "Upload-Length: " + std::to_string(size_);
+        list = curl_slist_append(list, length.c_str());
+        curl_easy_setopt(curl, CURLOPT_URL, url_.c_str());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, "");
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, 0L);
+    } else if (step_ == ResumeStep::QUERY) {
+        curl_easy_setopt(curl, CURLOPT_URL, location_.c_str());
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (step_ == ResumeStep::SEND) {
+        sending_ = GetChunkLength();
+        std::string offset = "Upload-Offset: " + std::to_string(offset_);
+        list = curl_slist_append(list, offset.c_str());
+        list = curl_slist_append(list, "Content-Type: application/offset+octet-stream");
+        list = curl_slist_append(list, "Expect:");
+        curl_easy_setopt(curl, CURLOPT_URL, location_.c_str());
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
+        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(sending_));
+    }
+    return list;
+}
+
+void UploadResumable::OnHeader(const std::string &line)
+{
+    if (line.compare(0, STATUS_PREFIX.size(), STATUS_PREFIX) == 0) {
+        // an interim response, only the headers of the final one count
+        newLocation_.clear();
+        serverOffset_ = -1;
+    } else if (StartsWithNoCase(line, LOCATION_HEADER)) {
+        newLocation_ = TrimValue(line, LOCATION_HEADER.size());
+    } else if (StartsWithNoCase(line, OFFSET_HEADER)) {
+        std::string value = TrimValue(line, OFFSET_HEADER.size());
+        char *end = nullptr;
+        long long offset = strtoll(value.c_str(), &end, 10);
+        serverOffset_ = (end != value.c_str() && offset >= 0) ? offset : -1;
+    }
+}
+
+void UploadResumable::OnDone(CURLcode result, long httpCode, int64_t elapsedMs)
+{
+    retryTime_ = 0;
+    if (result != CURLE_OK || httpCode >= HTTP_SERVER_ERROR) {
+        UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "resumable step failed, curl %{public}d http %{public}ld", result,
+            httpCode);
+        Retry();
+        return;
+    }
+    if (step_ == ResumeStep::CREATE) {
+        if (httpCode != HTTP_CREATED || newLocation_.empty()) {
+            UPLOAD_HILOGE(UPLOAD_MODULE_FRAMEWORK, "server refused to create upload, http %{public}ld", httpCode);
+            step_ = ResumeStep::FAILED;
+            return;
+        }
+        location_ = ResolveLocation(newLocation_);
+        offset_ = 0;
+        retries_ = 0;
+    } else if (step_ == ResumeStep::QUERY) {
+        if (httpCode == HTTP_NOT_FOUND || httpCode == HTTP_GONE || httpCode == HTTP_FORBIDDEN) {
+            // the server dropped the upload, start a new one
+            location_.clear();
+            offset_ = 0;
+            Remove();
+            step_ = ResumeStep::CREATE;
+            return;
+        }
+        if ((httpCode != HTTP_OK && httpCode != HTTP_NO_CONTENT) || serverOffset_ < 0 || serverOffset_ > size_) {
+            step_ = ResumeStep::FAILED;
+            return;
+        }
+        offset_ = serverOffset_;
+    } else if (step_ == ResumeStep::SEND) {
+        if (httpCode == HTTP_CONFLICT || (httpCode == HTTP_NO_CONTENT && serverOffset_ != offset_ + sending_)) {
+            // out of step with the server, ask it where it is
+            Retry();
+            return;
+        }
+        if (httpCode != HTTP_NO_CONTENT) {
+            step_ = ResumeStep::FAILED;
+            return;
+        }
+        AdaptChunkSize(sending_, elapsedMs);
+        offset_ = serverOffset_;
+        retries_ = 0;
+    } else {
+        return;
+    }
+    if (offset_ == size_) {
+        Remove();
+        step_ = ResumeStep::DONE;
+        return;
+    }
+    Save();
+    step_ = ResumeStep::SEND;
+}
+
+bool UploadResumable::Retry()
+{
+    if (++retries_ > MAX_RETRIES) {
+        step_ = ResumeStep::FAILED;
+        return false;
+    }
+    int64_t delay = std::min(RETRY_BASE_MS << (retries_ - 1), RETRY_MAX_MS);
+    retryTime_ = UploadWatchdog::Now() + delay;
+    step_ = location_.empty() ? ResumeStep::CREATE : ResumeStep::QUERY;
+    return true;
+}
+
+/**
+ * @brief Size the next chunk to take about TARGET_CHUNK_MS at the rate the last one went out with, moving
+ * halfway there each time so one slow chunk does not swing it too far.
+ */
+void UploadResumable::AdaptChunkSize(int64_t sent, int64_t elapsedMs)
+{
+    if (sent <= 0 || elapsedMs <= 0) {
+        return;
+    }
+    int64_t target = sent * TARGET_CHUNK_MS / elapsedMs;
+    int64_t next = (chunkSize_ + std::min(target, MAX_CHUNK_SIZE)) / 2;
+    chunkSize_ = std::min(std::max(next, MIN_CHUNK_SIZE), MAX_CHUNK_SIZE);
+}
+
+std::string UploadResumable::ResolveLocation(const std::string &location) const
+{
+    if (location.find(SCHEME_SEPARATOR) != std::string::npos) {
+        return location;
+    }
+    size_t schemeEnd = url_.find(SCHEME_SEPARATOR);
+    size_t hostEnd = schemeEnd == std::string::npos ? std::string::npos :
+        url_.find('/', schemeEnd + SCHEME_SEPARATOR.size());
+    std::string origin = hostEnd == std::string::npos ? url_ : url_.substr(0, hostEnd);
+    if (!location.empty() && location[0] == '/') {
+        return origin + location;
+    }
+    size_t lastSlash = url_.rfind('/');
+    bool noPath = hostEnd == std::string::npos || lastSlash < hostEnd;
+    std::string base = noPath ? origin + "/" : url_.substr(0, lastSlash + 1);
+    return base + location;
+}
+} // namespace OHOS::Request::Upload
@@ -13,20 +13,21 @@
  * limitations under the License.
  */
 
-#include <thread>
 #include "curl/curl.h"
 #include "curl/easy.h"
 
 #include "upload_task.h"
 
 namespace OHOS::Request::Upload {
-const int USLEEPRUN = 50 * 1000;
+const std::string CHECKPOINT_DIR_NAME = "/upload_checkpoint";
 UploadTask::UploadTask(std::shared_ptr<UploadConfig>& uploadConfig)
 {
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "UploadTask. In.");
     uploadConfig_ = uploadConfig;
+    jobId_ = 0;
     curlAdp_ = nullptr;
     state_ = STATE_INIT;
+    isRemoved_ = false;
     error_ = 0;
     uploadedSize_ = 0;
     totalSize_ = 0;
@@ -48,10 +49,19 @@ UploadTask::~UploadTask()
 bool UploadTask::Remove()
 {
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "Remove. In.");
-    if (curlAdp_ != nullptr) {
-        return curlAdp_->Remove();
+    std::shared_ptr<CUrlAdp> curlAdp;
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        isRemoved_ = true;
+        curlAdp = curlAdp_;
+    }
+    if (curlAdp != nullptr) {
+        return curlAdp->Remove();
+    }
+    // a task still waiting for a worker must not run once removed, one already picked up stops in OnRun
+    if (jobId_ == 0 || UploadExecutor::GetInstance().Cancel(jobId_)) {
+        ClearFileArray();
     }
-    ClearFileArray();
     return true;
 }
 
@@ -120,7 +130,6 @@ void UploadTask::SetContext(std::shared_ptr<OHOS::AbilityRuntime::Context> conte
 void UploadTask::Run(void *arg)
 {
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "Run. In.");
-    usleep(USLEEPRUN);
     ((UploadTask*)arg)->OnRun();
     if (((UploadTask*)arg)->uploadConfig_->protocolVersion == "L5") {
         if (((UploadTask*)arg)->uploadConfig_->fcomplete) {
@@ -139,8 +148,20 @@ void UploadTask::OnRun()
     if (fileArray_.empty()) {
         return;
     }
-    curlAdp_ = std::make_shared<CUrlAdp>(fileArray_, uploadConfig_);
-
+    if (uploadConfig_->resumable && uploadConfig_->checkpointDir.empty() && context_ != nullptr) {
+        uploadConfig_->checkpointDir = context_->GetCacheDir() + CHECKPOINT_DIR_NAME;
+    }
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        if (!isRemoved_) {
+            curlAdp_ = std::make_shared<CUrlAdp>(fileArray_, uploadConfig_);
+        }
+    }
+    if (curlAdp_ == nullptr) {
+        UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "OnRun. Removed before start.");
+        ClearFileArray();
+        return;
+    }
     curlAdp_->DoUpload((IUploadTask*)this);
 }
 
@@ -184,9 +205,8 @@ void UploadTask::OnFail(unsigned int error)
 void UploadTask::ExecuteTask()
 {
     UPLOAD_HILOGD(UPLOAD_MODULE_FRAMEWORK, "ExecuteTask. In.");
-    thread_ = std::make_unique<std::thread>(UploadTask::Run, this);
-    thread_handle_ = thread_->native_handle();
-    thread_->detach();
+    jobId_ = UploadExecutor::GetInstance().Submit([this]() { UploadTask::Run(this); }, uploadConfig_->priority,
+        [this]() { Remove(); });
 }
 
 std::vector<FileData>& UploadTask::GetFileArray()
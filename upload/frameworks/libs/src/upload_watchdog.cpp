@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "upload_watchdog.h"
+#include <chrono>
+#include <cinttypes>
+#include "upload_hilog_wrapper.h"
+
+namespace OHOS::Request::Upload {
+UploadWatchdog &UploadWatchdog::GetInstance()
+{
+    static UploadWatchdog instance;
+    return instance;
+}
+
+UploadWatchdog::~UploadWatchdog()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+int64_t UploadWatchdog::Now()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t UploadWatchdog::Watch(std::atomic<int64_t> *deadline, WatchdogFunc callback)
+{
+    if (deadline == nullptr || callback == nullptr) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> guard(mutex_);
+    uint64_t id = nextId_++;
+    watches_[id] = { deadline, std::move(callback) };
+    if (!running_) {
+        // the previous thread has already left its loop, it only has to be reaped
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        running_ = true;
+        thread_ = std::thread(&UploadWatchdog::Run, this);
+    }
+    return id;
+}
+
+/**
+ * @brief Stop watching. Returns after a callback for this watch that is running has finished, so the owner of
+ * the deadline can go away right after.
+ */
+void UploadWatchdog::Unwatch(uint64_t id)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    watches_.erase(id);
+    cond_.notify_all();
+}
+
+void UploadWatchdog::SetCheckInterval(int64_t intervalMs)
+{
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (intervalMs > 0) {
+        checkIntervalMs_ = intervalMs;
+    }
+    cond_.notify_all();
+}
+
+void UploadWatchdog::Run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_ && !watches_.empty()) {
+        cond_.wait_for(lock, std::chrono::milliseconds(checkIntervalMs_));
+        CheckDeadlines();
+    }
+    running_ = false;
+}
+
+void UploadWatchdog::CheckDeadlines()
+{
+    int64_t now = Now();
+    for (auto &watch : watches_) {
+        int64_t deadline = watch.second.deadline->load();
+        if (deadline == 0 || deadline > now) {
+            continue;
+        }
+        // fire once per expired read, the reader arms a new deadline for its next read
+        if (watch.second.deadline->compare_exchange_strong(deadline, 0)) {
+            UPLOAD_HILOGI(UPLOAD_MODULE_FRAMEWORK, "watch %{public}" PRIu64 " expired", watch.first);
+            watch.second.callback();
+        }
+    }
+}
+} // namespace OHOS::Request::Upload
@@ -204,6 +204,30 @@ declare namespace request {
    */
   const SESSION_SUCCESSFUL: number;
 
+  /**
+   * Batch action that pauses the selected download sessions.
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @permission {@code ohos.permission.INTERNET}
+   */
+  const ACTION_PAUSE: number;
+
+  /**
+   * Batch action that resumes the selected download sessions.
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @permission {@code ohos.permission.INTERNET}
+   */
+  const ACTION_RESUME: number;
+
+  /**
+   * Batch action that deletes the selected download sessions.
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @permission {@code ohos.permission.INTERNET}
+   */
+  const ACTION_REMOVE: number;
+
   /**
    * Starts a download session.
    *
@@ -227,6 +251,78 @@ declare namespace request {
    */
   function download(config: DownloadConfig): Promise<DownloadTask>;
 
+  /**
+   * Starts a group of download sessions with one request.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param configs download configs of the group members, at most 500.
+   * @param callback Indicate the callback function to receive DownloadGroup.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return -
+   */
+  function downloadGroup(configs: Array<DownloadConfig>, callback: AsyncCallback<DownloadGroup>): void;
+
+  /**
+   * Starts a group of download sessions with one request.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param configs download configs of the group members, at most 500.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return -
+   */
+  function downloadGroup(configs: Array<DownloadConfig>): Promise<DownloadGroup>;
+
+  /**
+   * Applies one action to every download session selected by the filter with one request.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param filter selects the download sessions.
+   * @param action one of the ACTION_* constants.
+   * @param callback Indicate the callback function to receive the ids of the sessions the action succeeded on.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return -
+   */
+  function batchAction(filter: DownloadFilter, action: number, callback: AsyncCallback<Array<number>>): void;
+
+  /**
+   * Applies one action to every download session selected by the filter with one request.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param filter selects the download sessions.
+   * @param action one of the ACTION_* constants.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return -
+   */
+  function batchAction(filter: DownloadFilter, action: number): Promise<Array<number>>;
+
+  /**
+   * Queries download information of every session selected by the filter.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param filter selects the download sessions.
+   * @param callback Indicate the callback function to receive download infos ordered by downloadId,
+   * at most 10000 of them; the sessions with the lowest downloadId are returned when more match.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return -
+   */
+  function batchQuery(filter: DownloadFilter, callback: AsyncCallback<Array<DownloadInfo>>): void;
+
+  /**
+   * Queries download information of every session selected by the filter.
+   *
+   * @since 8
+   * @devices phone, tablet, tv, wearable, car
+   * @param filter selects the download sessions.
+   * @permission {@code ohos.permission.INTERNET}
+   * @return download infos ordered by downloadId, at most 10000 of them.
+   */
+  function batchQuery(filter: DownloadFilter): Promise<Array<DownloadInfo>>;
+
   /**
    * Starts a upload session.
    *
@@ -259,6 +355,12 @@ declare namespace request {
     networkType?: number; // Sets the network type allowed for download.
     filePath?: string; // Sets the path for downloads.
     title?: string; // Sets a download session title.
+    enableCache?: boolean; // Answers repeat downloads from the local HTTP cache after revalidating them.
+    mirrors?: Array<string>; // Additional sources serving the same file; ranges are fetched from all of them.
+    size?: number; // Expected file size in bytes; skips the size probe for mirrored downloads.
+    sha256?: string; // Expected SHA-256 of the file as hex; the download fails if it does not match.
+    blockIndex?: string; // Address of the block checksum index of the file.
+    baseFile?: string; // Older local version of the file; blocks found in it are copied instead of downloaded.
   }
 
   interface DownloadInfo {
@@ -275,6 +377,13 @@ declare namespace request {
     downloadTotalBytes: number; // the total size of files to be downloaded (in bytes).
   }
 
+  interface DownloadFilter {
+    taskIds?: Array<number>; // Only these sessions, at most 10000.
+    status?: number; // Only sessions in this status, which can be any SESSION_* constant.
+    pausedReason?: number; // Only paused sessions with this reason, which can be any PAUSED_* constant.
+    ownOnly?: boolean; // Only sessions started by the caller. Applications always only reach their own sessions.
+  }
+
   interface DownloadTask {
     /**
      * Called when the current download session is in process.
@@ -466,6 +575,149 @@ declare namespace request {
     queryMimeType(): Promise<string>;
   }
 
+  interface DownloadGroup {
+    /**
+     * Called when the group is in process, with the summed sizes of all members.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type progress Indicates the download group progress.
+     * @param callback The callback function for the download group progress change event
+     *        receivedSize the length of data downloaded by all members, in bytes
+     *        totalSize the length of data expected to be downloaded by all members, in bytes.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    on(type: 'progress', callback: (receivedSize: number, totalSize: number) => void): void;
+
+    /**
+     * Called when the group is in process, with the summed sizes of all members.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type progress Indicates the download group progress.
+     * @param callback The callback function for the download group progress change event
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    off(type: 'progress', callback?: (receivedSize: number, totalSize: number) => void): void;
+
+    /**
+     * Called when the group completes, pauses or is removed.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type Indicates the download group event type
+     *        complete: every member completed,
+     *        pause: every unfinished member stopped,
+     *        remove: download group deleted.
+     * @param callback The callback function for the download group complete、pause or remove change event.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    on(type: 'complete' | 'pause' | 'remove', callback: () => void): void;
+
+    /**
+     * Called when the group completes, pauses or is removed.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type Indicates the download group event type
+     * @param callback The callback function for the download group complete、pause or remove change event.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    off(type: 'complete' | 'pause' | 'remove', callback?: () => void): void;
+
+    /**
+     * Called once every member has finished and at least one of them failed.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type Indicates the download group type, fail: some members have failed.
+     * @param callback The callback function for the download group fail change event
+     *        err The number of failed members.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    on(type: 'fail', callback: (err: number) => void): void;
+
+    /**
+     * Called once every member has finished and at least one of them failed.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param type Indicates the download group type, fail: some members have failed.
+     * @param callback Indicate the callback function to receive err.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    off(type: 'fail', callback?: (err: number) => void): void;
+
+    /**
+     * Deletes all members of the group and their downloaded files.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param callback Indicates asynchronous invoking Result.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    remove(callback: AsyncCallback<boolean>): void;
+
+    /**
+     * Deletes all members of the group and their downloaded files.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    remove(): Promise<boolean>;
+
+    /**
+     * Pauses every running or queued member of the group.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param callback Indicates asynchronous invoking Result.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    pause(callback: AsyncCallback<boolean>): void;
+
+    /**
+     * Pauses every running or queued member of the group.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    pause(): Promise<boolean>;
+
+    /**
+     * Resumes the paused members of the group.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @param callback Indicates asynchronous invoking Result.
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    resume(callback: AsyncCallback<boolean>): void;
+
+    /**
+     * Resumes the paused members of the group.
+     *
+     * @since 8
+     * @devices phone, tablet, tv, wearable, car
+     * @permission {@code ohos.permission.INTERNET}
+     * @return -
+     */
+    resume(): Promise<boolean>;
+  }
+
   interface File {
     filename: string; // When multipart is submitted, the file name in the request header.
     name: string; // When multipart is submitted, the name of the form item. The default is file.
@@ -484,6 +736,17 @@ declare namespace request {
     method: string; // Request method: POST, PUT. The default POST.
     files: Array<File>; // A list of files to be uploaded. Please use multipart/form-data to submit.
     data: Array<RequestData>; // The requested form data.
+    priority?: number; // Tasks with a higher priority start first when all upload workers are busy, the default is 0.
+    maxConcurrency?: number; // The number of files uploaded at the same time, the default is 4.
+    bufferSize?: number; // The bytes read from a file at a time, 16 KB to 8 MB, the default is 256 KB.
+    useMmap?: boolean; // Whether files are mapped into memory instead of read, the default is false.
+    resumable?: boolean; // Whether files are sent with the tus resumable upload protocol, the default is false.
+    rawBody?: boolean; // Whether each file is sent as the request body itself with method, the default is false.
+    // A compressed body is sent with chunked transfer encoding, which presigned S3 URLs do not accept.
+    // Setting compression without rawBody, or with resumable or partSize, fails the upload with a config error.
+    compression?: string; // 'gzip' compresses rawBody uploads on the fly and sets Content-Encoding, the default sends them as they are.
+    singleRequest?: boolean; // Whether all files and the form data go in one multipart request, the default is false.
+    partSize?: number; // Bytes per part when each file is sent as S3 style parts side by side, at least 5 MB, the default 0 sends each file whole.
   }
 
   interface UploadTask {
@@ -155,6 +155,51 @@ std::shared_ptr<Upload::UploadConfig> JSUtil::Convert2UploadConfig(napi_env env,
     if (value != nullptr) {
         config.data = Convert2RequestDataVector(env, value);
     }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "priority", &value);
+    if (value != nullptr) {
+        napi_get_value_int32(env, value, &config.priority);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "maxConcurrency", &value);
+    if (value != nullptr) {
+        napi_get_value_uint32(env, value, &config.maxConcurrency);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "bufferSize", &value);
+    if (value != nullptr) {
+        napi_get_value_uint32(env, value, &config.bufferSize);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "useMmap", &value);
+    if (value != nullptr) {
+        napi_get_value_bool(env, value, &config.useMmap);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "resumable", &value);
+    if (value != nullptr) {
+        napi_get_value_bool(env, value, &config.resumable);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "rawBody", &value);
+    if (value != nullptr) {
+        napi_get_value_bool(env, value, &config.rawBody);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "compression", &value);
+    if (value != nullptr) {
+        config.compression = Convert2String(env, value);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "singleRequest", &value);
+    if (value != nullptr) {
+        napi_get_value_bool(env, value, &config.singleRequest);
+    }
+    value = nullptr;
+    napi_get_named_property(env, jsConfig, "partSize", &value);
+    if (value != nullptr) {
+        napi_get_value_uint32(env, value, &config.partSize);
+    }
 
     std::shared_ptr<Upload::UploadConfig> tmpConfig = std::make_shared<Upload::UploadConfig>(config);
     return tmpConfig;
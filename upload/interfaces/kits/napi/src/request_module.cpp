@@ -18,6 +18,7 @@
 #include "legacy/download_manager.h"
 #include "upload_task_napi.h"
 #include "js_util.h"
+#include "download_batch.h"
 #include "download_task_napi.h"
 #include "constant.h"
 
@@ -47,6 +48,9 @@ static napi_value session_running = nullptr;
 static napi_value session_pending = nullptr;
 static napi_value session_paused = nullptr;
 static napi_value session_failed = nullptr;
+static napi_value action_pause = nullptr;
+static napi_value action_resume = nullptr;
+static napi_value action_remove = nullptr;
 
 static napi_value Init(napi_env env, napi_value exports)
 {
@@ -79,6 +83,11 @@ static napi_value Init(napi_env env, napi_value exports)
     napi_create_int32(env, static_cast<int32_t>(SESSION_PAUSED), &session_paused);
     napi_create_int32(env, static_cast<int32_t>(SESSION_FAILED), &session_failed);
 
+    /* Create batch action Const */
+    napi_create_int32(env, static_cast<int32_t>(DOWNLOAD_ACTION_PAUSE), &action_pause);
+    napi_create_int32(env, static_cast<int32_t>(DOWNLOAD_ACTION_RESUME), &action_resume);
+    napi_create_int32(env, static_cast<int32_t>(DOWNLOAD_ACTION_REMOVE), &action_remove);
+
     napi_property_descriptor desc[] = {
         DECLARE_NAPI_STATIC_PROPERTY("NETWORK_MOBILE", network_mobile),
         DECLARE_NAPI_STATIC_PROPERTY("NETWORK_WIFI", network_wifi),
@@ -105,7 +114,14 @@ static napi_value Init(napi_env env, napi_value exports)
         DECLARE_NAPI_STATIC_PROPERTY("SESSION_PAUSED", session_paused),
         DECLARE_NAPI_STATIC_PROPERTY("SESSION_FAILED", session_failed),
 
+        DECLARE_NAPI_STATIC_PROPERTY("ACTION_PAUSE", action_pause),
+        DECLARE_NAPI_STATIC_PROPERTY("ACTION_RESUME", action_resume),
+        DECLARE_NAPI_STATIC_PROPERTY("ACTION_REMOVE", action_remove),
+
         DECLARE_NAPI_METHOD("download", DownloadTaskNapi::JsMain),
+        DECLARE_NAPI_METHOD("downloadGroup", DownloadTaskNapi::JsGroup),
+        DECLARE_NAPI_METHOD("batchAction", DownloadBatch::Action),
+        DECLARE_NAPI_METHOD("batchQuery", DownloadBatch::Query),
         DECLARE_NAPI_METHOD("upload", UploadTaskNapi::JsUpload),
         DECLARE_NAPI_METHOD("onDownloadComplete", Legacy::DownloadManager::OnDownloadComplete),
     };
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "upload_compressor.h"
+#include "upload_file_reader.h"
+#include "zlib.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr const char *COMPRESSOR_TEST_FILE = "/data/upload_compressor_test.log";
+constexpr size_t COMPRESSOR_TEST_LINES = 20000;
+constexpr size_t COMPRESSOR_TEST_CHUNK = 5000;
+constexpr int GZIP_WINDOW_BITS = MAX_WBITS + 16;
+
+class UploadCompressorTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+
+    static std::string Inflate(const std::string &compressed);
+    static std::string content_;
+};
+
+std::string UploadCompressorTest::content_;
+
+void UploadCompressorTest::SetUpTestCase(void)
+{
+    for (size_t i = 0; i < COMPRESSOR_TEST_LINES; i++) {
+        content_ += "line " + std::to_string(i) + " upload compressor test\n";
+    }
+    FILE *file = fopen(COMPRESSOR_TEST_FILE, "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(content_.data(), 1, content_.size(), file), content_.size());
+    fclose(file);
+}
+
+void UploadCompressorTest::TearDownTestCase(void)
+{
+    unlink(COMPRESSOR_TEST_FILE);
+}
+
+void UploadCompressorTest::SetUp()
+{
+}
+
+void UploadCompressorTest::TearDown()
+{
+}
+
+std::string UploadCompressorTest::Inflate(const std::string &compressed)
+{
+    std::string result;
+    z_stream stream = {};
+    if (inflateInit2(&stream, GZIP_WINDOW_BITS) != Z_OK) {
+        return result;
+    }
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    std::vector<char> out(COMPRESSOR_TEST_CHUNK);
+    int ret = Z_OK;
+    while (ret == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef *>(out.data());
+        stream.avail_out = static_cast<uInt>(out.size());
+        ret = inflate(&stream, Z_NO_FLUSH);
+        result.append(out.data(), out.size() - stream.avail_out);
+    }
+    inflateEnd(&stream);
+    return ret == Z_STREAM_END ? result : "";
+}
+
+/**
+ * @tc.name: UploadCompressorTest_001
+ * @tc.desc: the gzip stream read out decodes to the file and progress ends at the file size
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadCompressorTest, UploadCompressorTest_001, TestSize.Level1)
+{
+    EXPECT_TRUE(UploadCompressor::IsSupported("gzip"));
+    EXPECT_FALSE(UploadCompressor::IsSupported("br"));
+
+    int fd = open(COMPRESSOR_TEST_FILE, O_RDONLY);
+    ASSERT_GE(fd, 0);
+    auto reader = std::make_shared<UploadFileReader>(fd, 0, content_.size());
+    ASSERT_TRUE(reader->Open(UploadFileReader::MIN_BUFFER_SIZE, false));
+    UploadCompressor compressor(reader);
+    ASSERT_TRUE(compressor.Start(UploadFileReader::MIN_BUFFER_SIZE));
+    std::string compressed;
+    std::vector<char> chunk(COMPRESSOR_TEST_CHUNK);
+    ssize_t got = 0;
+    while ((got = compressor.Read(chunk.data(), chunk.size())) > 0) {
+        compressed.append(chunk.data(), got);
+    }
+    EXPECT_EQ(got, 0);
+    EXPECT_LT(compressed.size(), content_.size());
+    EXPECT_EQ(compressor.GetSourceSent(), static_cast<int64_t>(content_.size()));
+    EXPECT_EQ(Inflate(compressed), content_);
+    compressor.Stop();
+    close(fd);
+}
+} // end of OHOS::Request::Upload
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include "upload_executor.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr int32_t LOW_PRIORITY = 0;
+constexpr int32_t HIGH_PRIORITY = 10;
+constexpr int64_t EXECUTOR_TEST_WAIT_MS = 5000;
+
+class UploadExecutorTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+};
+
+void UploadExecutorTest::SetUpTestCase(void)
+{
+    UploadExecutor::GetInstance().SetMaxWorkers(1);
+}
+
+void UploadExecutorTest::TearDownTestCase(void)
+{
+    UploadExecutor::GetInstance().SetMaxWorkers(UploadExecutor::DEFAULT_MAX_WORKERS);
+}
+
+void UploadExecutorTest::SetUp()
+{
+}
+
+void UploadExecutorTest::TearDown()
+{
+}
+
+/**
+ * @tc.name: UploadExecutorTest_001
+ * @tc.desc: jobs queued behind a busy worker run by priority, a cancelled job never runs
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadExecutorTest, UploadExecutorTest_001, TestSize.Level1)
+{
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool release = false;
+    std::vector<int> order;
+    UploadExecutor &executor = UploadExecutor::GetInstance();
+    auto record = [&mutex, &cond, &order](int value) {
+        std::lock_guard<std::mutex> guard(mutex);
+        order.push_back(value);
+        cond.notify_all();
+    };
+    executor.Submit([&mutex, &cond, &release]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        cond.wait(lock, [&release]() { return release; });
+    }, LOW_PRIORITY);
+    executor.Submit([&record]() { record(1); }, LOW_PRIORITY);
+    uint64_t cancelled = executor.Submit([&record]() { record(2); }, LOW_PRIORITY);
+    executor.Submit([&record]() { record(3); }, HIGH_PRIORITY);
+    executor.Submit([&record]() { record(4); }, LOW_PRIORITY);
+    EXPECT_TRUE(executor.Cancel(cancelled));
+    EXPECT_FALSE(executor.Cancel(cancelled));
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        release = true;
+        cond.notify_all();
+        cond.wait_for(lock, std::chrono::milliseconds(EXECUTOR_TEST_WAIT_MS), [&order]() { return order.size() == 3; });
+    }
+    EXPECT_EQ(order, std::vector<int>({ 3, 1, 4 }));
+}
+} // end of OHOS::Request::Upload
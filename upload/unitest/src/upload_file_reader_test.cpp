@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "upload_file_reader.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr const char *READER_TEST_FILE = "/data/upload_file_reader_test.bin";
+constexpr size_t READER_TEST_SIZE = 300 * 1024 + 123;
+constexpr int64_t READER_TEST_OFFSET = 5000;
+constexpr size_t READER_TEST_CHUNK = 7000;
+
+class UploadFileReaderTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+
+    static std::string ReadAll(UploadFileReader &reader);
+    static std::string content_;
+};
+
+std::string UploadFileReaderTest::content_;
+
+void UploadFileReaderTest::SetUpTestCase(void)
+{
+    content_.resize(READER_TEST_SIZE);
+    for (size_t i = 0; i < READER_TEST_SIZE; i++) {
+        content_[i] = static_cast<char>((i * 131) % 251);
+    }
+    FILE *file = fopen(READER_TEST_FILE, "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(content_.data(), 1, content_.size(), file), content_.size());
+    fclose(file);
+}
+
+void UploadFileReaderTest::TearDownTestCase(void)
+{
+    unlink(READER_TEST_FILE);
+}
+
+void UploadFileReaderTest::SetUp()
+{
+}
+
+void UploadFileReaderTest::TearDown()
+{
+}
+
+std::string UploadFileReaderTest::ReadAll(UploadFileReader &reader)
+{
+    std::string result;
+    std::vector<char> chunk(READER_TEST_CHUNK);
+    ssize_t got = 0;
+    while ((got = reader.Read(chunk.data(), chunk.size())) > 0) {
+        result.append(chunk.data(), got);
+    }
+    return got < 0 ? "" : result;
+}
+
+/**
+ * @tc.name: UploadFileReaderTest_001
+ * @tc.desc: buffered and mapped reads return the requested range of the file
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadFileReaderTest, UploadFileReaderTest_001, TestSize.Level1)
+{
+    int fd = open(READER_TEST_FILE, O_RDONLY);
+    ASSERT_GE(fd, 0);
+    int64_t length = static_cast<int64_t>(READER_TEST_SIZE) - READER_TEST_OFFSET;
+    std::string expected = content_.substr(READER_TEST_OFFSET);
+
+    UploadFileReader buffered(fd, READER_TEST_OFFSET, length);
+    EXPECT_TRUE(buffered.Open(UploadFileReader::MIN_BUFFER_SIZE, false));
+    EXPECT_FALSE(buffered.IsMapped());
+    EXPECT_EQ(ReadAll(buffered), expected);
+    EXPECT_EQ(buffered.GetPosition(), length);
+
+    UploadFileReader mapped(fd, READER_TEST_OFFSET, length);
+    EXPECT_TRUE(mapped.Open(0, true));
+    EXPECT_TRUE(mapped.IsMapped());
+    EXPECT_EQ(ReadAll(mapped), expected);
+    close(fd);
+}
+
+/**
+ * @tc.name: UploadFileReaderTest_002
+ * @tc.desc: a range past the end of the file is a read error, bad arguments fail to open
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadFileReaderTest, UploadFileReaderTest_002, TestSize.Level1)
+{
+    int fd = open(READER_TEST_FILE, O_RDONLY);
+    ASSERT_GE(fd, 0);
+    UploadFileReader reader(fd, 0, READER_TEST_SIZE * 2);
+    EXPECT_TRUE(reader.Open(0, false));
+    std::vector<char> chunk(READER_TEST_SIZE * 2);
+    ssize_t got = 0;
+    ssize_t last = 0;
+    while ((got = reader.Read(chunk.data(), chunk.size())) > 0) {
+        last = got;
+    }
+    EXPECT_EQ(got, -1);
+    EXPECT_GT(last, 0);
+
+    UploadFileReader invalid(-1, 0, READER_TEST_SIZE);
+    EXPECT_FALSE(invalid.Open(0, false));
+    EXPECT_EQ(UploadFileReader::ClampBufferSize(1), UploadFileReader::MIN_BUFFER_SIZE);
+    EXPECT_EQ(UploadFileReader::ClampBufferSize(UINT32_MAX), UploadFileReader::MAX_BUFFER_SIZE);
+    close(fd);
+}
+} // end of OHOS::Request::Upload
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "upload_parts.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr const char *PARTS_TEST_URL = "http://127.0.0.1/bucket/big.bin";
+constexpr const char *PARTS_TEST_INITIATE = "<InitiateMultipartUploadResult><UploadId>abc</UploadId>"
+    "</InitiateMultipartUploadResult>";
+constexpr int64_t PARTS_TEST_SIZE = 2 * UploadParts::MIN_PART_SIZE + 1;
+constexpr long HTTP_OK = 200;
+constexpr long HTTP_FORBIDDEN = 403;
+constexpr long HTTP_SERVICE_UNAVAILABLE = 503;
+constexpr int64_t NOW = 1;
+
+class UploadPartsTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+};
+
+void UploadPartsTest::SetUpTestCase(void)
+{
+}
+
+void UploadPartsTest::TearDownTestCase(void)
+{
+}
+
+void UploadPartsTest::SetUp()
+{
+}
+
+void UploadPartsTest::TearDown()
+{
+}
+
+/**
+ * @tc.name: UploadPartsTest_001
+ * @tc.desc: the file is split into parts that go out side by side, a failed part is retried on its own
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadPartsTest, UploadPartsTest_001, TestSize.Level1)
+{
+    UploadParts parts(PARTS_TEST_URL, PARTS_TEST_SIZE, 1);
+    EXPECT_EQ(parts.GetStep(), PartStep::INITIATE);
+    EXPECT_TRUE(parts.TakeControlRequest(NOW));
+    EXPECT_FALSE(parts.TakeControlRequest(NOW));
+    parts.OnInitiateDone(CURLE_OK, HTTP_OK, PARTS_TEST_INITIATE, NOW);
+    EXPECT_EQ(parts.GetStep(), PartStep::PARTS);
+    EXPECT_EQ(parts.GetUploadId(), "abc");
+
+    UploadPart *first = parts.TakePart(NOW);
+    UploadPart *second = parts.TakePart(NOW);
+    UploadPart *last = parts.TakePart(NOW);
+    ASSERT_TRUE(first != nullptr && second != nullptr && last != nullptr);
+    EXPECT_EQ(parts.TakePart(NOW), nullptr);
+    EXPECT_EQ(first->length, UploadParts::MIN_PART_SIZE);
+    EXPECT_EQ(second->offset, UploadParts::MIN_PART_SIZE);
+    EXPECT_EQ(last->length, 1);
+
+    parts.OnPartDone(*first, CURLE_OK, HTTP_OK, "\"e1\"", NOW);
+    parts.OnPartDone(*second, CURLE_SEND_ERROR, 0, "", NOW);
+    parts.OnPartDone(*last, CURLE_OK, HTTP_OK, "\"e3\"", NOW);
+    EXPECT_EQ(parts.GetSent(), UploadParts::MIN_PART_SIZE + 1);
+    EXPECT_GT(parts.GetNextRetryTime(), NOW);
+    EXPECT_EQ(parts.TakePart(NOW), nullptr);
+    UploadPart *retried = parts.TakePart(parts.GetNextRetryTime());
+    EXPECT_EQ(retried, second);
+    parts.OnPartDone(*second, CURLE_OK, HTTP_OK, "\"e2\"", NOW);
+    EXPECT_EQ(parts.GetStep(), PartStep::COMPLETE);
+
+    EXPECT_TRUE(parts.TakeControlRequest(NOW));
+    parts.OnCompleteDone(CURLE_OK, HTTP_OK, "<Error><Code>InternalError</Code></Error>", NOW);
+    EXPECT_EQ(parts.GetStep(), PartStep::COMPLETE);
+    EXPECT_TRUE(parts.TakeControlRequest(parts.GetNextRetryTime()));
+    parts.OnCompleteDone(CURLE_OK, HTTP_OK, "<CompleteMultipartUploadResult/>", NOW);
+    EXPECT_EQ(parts.GetStep(), PartStep::DONE);
+}
+
+/**
+ * @tc.name: UploadPartsTest_002
+ * @tc.desc: a rejected part fails the upload, server errors fail it once the retries run out
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadPartsTest, UploadPartsTest_002, TestSize.Level1)
+{
+    UploadParts rejected(PARTS_TEST_URL, PARTS_TEST_SIZE, 0);
+    rejected.TakeControlRequest(NOW);
+    rejected.OnInitiateDone(CURLE_OK, HTTP_OK, PARTS_TEST_INITIATE, NOW);
+    UploadPart *part = rejected.TakePart(NOW);
+    ASSERT_NE(part, nullptr);
+    rejected.OnPartDone(*part, CURLE_OK, HTTP_FORBIDDEN, "", NOW);
+    EXPECT_EQ(rejected.GetStep(), PartStep::FAILED);
+
+    UploadParts busy(PARTS_TEST_URL, PARTS_TEST_SIZE, 0);
+    for (uint32_t i = 0; i < UploadParts::MAX_RETRIES; i++) {
+        EXPECT_TRUE(busy.TakeControlRequest(busy.GetNextRetryTime()));
+        busy.OnInitiateDone(CURLE_OK, HTTP_SERVICE_UNAVAILABLE, "", NOW);
+        EXPECT_EQ(busy.GetStep(), PartStep::INITIATE);
+    }
+    busy.TakeControlRequest(busy.GetNextRetryTime());
+    busy.OnInitiateDone(CURLE_OK, HTTP_SERVICE_UNAVAILABLE, "", NOW);
+    EXPECT_EQ(busy.GetStep(), PartStep::FAILED);
+
+    EXPECT_EQ(UploadParts::ParseTag("<a><UploadId>x y</UploadId></a>", "UploadId"), "x y");
+    EXPECT_EQ(UploadParts::ParseTag("<UploadId>x", "UploadId"), "");
+}
+} // end of OHOS::Request::Upload
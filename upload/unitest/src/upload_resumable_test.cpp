@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+#include <string>
+#include "upload_resumable.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr const char *RESUMABLE_TEST_DIR = "/data/upload_resumable_test";
+constexpr const char *RESUMABLE_TEST_URL = "http://127.0.0.1/files/";
+constexpr const char *RESUMABLE_TEST_KEY = "upload_resumable_test_key";
+constexpr int64_t RESUMABLE_TEST_SIZE = 3 * UploadResumable::INITIAL_CHUNK_SIZE;
+constexpr long HTTP_CREATED = 201;
+constexpr long HTTP_NO_CONTENT = 204;
+constexpr long HTTP_NOT_FOUND = 404;
+constexpr int64_t FAST_CHUNK_MS = 10;
+
+class UploadResumableTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+
+    static void Step(UploadResumable &resumable, long httpCode, const std::string &header, int64_t elapsedMs);
+    static std::string checkpointPath_;
+};
+
+std::string UploadResumableTest::checkpointPath_;
+
+void UploadResumableTest::SetUpTestCase(void)
+{
+    checkpointPath_ = UploadResumable::MakeCheckpointPath(RESUMABLE_TEST_DIR, RESUMABLE_TEST_KEY);
+}
+
+void UploadResumableTest::TearDownTestCase(void)
+{
+    rmdir(RESUMABLE_TEST_DIR);
+}
+
+void UploadResumableTest::SetUp()
+{
+    unlink(checkpointPath_.c_str());
+}
+
+void UploadResumableTest::TearDown()
+{
+    unlink(checkpointPath_.c_str());
+}
+
+void UploadResumableTest::Step(UploadResumable &resumable, long httpCode, const std::string &header,
+    int64_t elapsedMs)
+{
+    CURL *curl = curl_easy_init();
+    struct curl_slist *list = resumable.Prepare(curl, nullptr);
+    resumable.OnHeader("HTTP/1.1 " + std::to_string(httpCode) + " X\r\n");
+    if (!header.empty()) {
+        resumable.OnHeader(header);
+    }
+    resumable.OnDone(CURLE_OK, httpCode, elapsedMs);
+    curl_slist_free_all(list);
+    curl_easy_cleanup(curl);
+}
+
+/**
+ * @tc.name: UploadResumableTest_001
+ * @tc.desc: the acknowledged offset is checkpointed, picked up again and the checkpoint dropped at the end
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadResumableTest, UploadResumableTest_001, TestSize.Level1)
+{
+    UploadResumable first(RESUMABLE_TEST_URL, RESUMABLE_TEST_SIZE, checkpointPath_);
+    first.Load(RESUMABLE_TEST_KEY);
+    EXPECT_EQ(first.GetStep(), ResumeStep::CREATE);
+    Step(first, HTTP_CREATED, "Location: /files/abc\r\n", FAST_CHUNK_MS);
+    EXPECT_EQ(first.GetStep(), ResumeStep::SEND);
+    EXPECT_EQ(first.GetChunkLength(), UploadResumable::INITIAL_CHUNK_SIZE);
+    Step(first, HTTP_NO_CONTENT, "Upload-Offset: " + std::to_string(UploadResumable::INITIAL_CHUNK_SIZE) + "\r\n",
+        FAST_CHUNK_MS);
+    EXPECT_EQ(first.GetOffset(), UploadResumable::INITIAL_CHUNK_SIZE);
+    EXPECT_GT(first.GetChunkLength(), UploadResumable::INITIAL_CHUNK_SIZE);
+    EXPECT_EQ(access(checkpointPath_.c_str(), F_OK), 0);
+
+    UploadResumable second(RESUMABLE_TEST_URL, RESUMABLE_TEST_SIZE, checkpointPath_);
+    second.Load(RESUMABLE_TEST_KEY);
+    EXPECT_EQ(second.GetStep(), ResumeStep::QUERY);
+    EXPECT_EQ(second.GetOffset(), UploadResumable::INITIAL_CHUNK_SIZE);
+    Step(second, HTTP_NO_CONTENT, "Upload-Offset: " + std::to_string(RESUMABLE_TEST_SIZE) + "\r\n", FAST_CHUNK_MS);
+    EXPECT_EQ(second.GetStep(), ResumeStep::DONE);
+    EXPECT_NE(access(checkpointPath_.c_str(), F_OK), 0);
+
+    UploadResumable other(RESUMABLE_TEST_URL, RESUMABLE_TEST_SIZE, checkpointPath_);
+    other.Load("another file");
+    EXPECT_EQ(other.GetStep(), ResumeStep::CREATE);
+}
+
+/**
+ * @tc.name: UploadResumableTest_002
+ * @tc.desc: network errors go back to the offset query until the retries run out, a lost upload starts over
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadResumableTest, UploadResumableTest_002, TestSize.Level1)
+{
+    UploadResumable resumable(RESUMABLE_TEST_URL, RESUMABLE_TEST_SIZE, "");
+    resumable.Load(RESUMABLE_TEST_KEY);
+    Step(resumable, HTTP_CREATED, "Location: http://127.0.0.1/files/abc\r\n", FAST_CHUNK_MS);
+    EXPECT_EQ(resumable.GetStep(), ResumeStep::SEND);
+
+    Step(resumable, HTTP_NOT_FOUND, "", FAST_CHUNK_MS);
+    EXPECT_EQ(resumable.GetStep(), ResumeStep::FAILED);
+
+    UploadResumable retried(RESUMABLE_TEST_URL, RESUMABLE_TEST_SIZE, "");
+    retried.Load(RESUMABLE_TEST_KEY);
+    Step(retried, HTTP_CREATED, "Location: abc\r\n", FAST_CHUNK_MS);
+    for (uint32_t i = 0; i < UploadResumable::MAX_RETRIES; i++) {
+        retried.OnDone(CURLE_SEND_ERROR, 0, 0);
+        EXPECT_EQ(retried.GetStep(), ResumeStep::QUERY);
+        EXPECT_GT(retried.GetRetryTime(), 0);
+    }
+    Step(retried, HTTP_NOT_FOUND, "", FAST_CHUNK_MS);
+    EXPECT_EQ(retried.GetStep(), ResumeStep::CREATE);
+    retried.OnDone(CURLE_COULDNT_CONNECT, 0, 0);
+    EXPECT_EQ(retried.GetStep(), ResumeStep::FAILED);
+}
+} // end of OHOS::Request::Upload
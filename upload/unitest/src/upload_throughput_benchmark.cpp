@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "curl/curl.h"
+#include "upload_file_reader.h"
+
+namespace OHOS::Request::Upload {
+namespace {
+constexpr int64_t MEGABYTE = 1024 * 1024;
+constexpr int64_t FILE_SIZES_MB[] = { 10, 100, 1024 };
+constexpr size_t STDIO_READ_SIZE = 8 * 1024;
+constexpr size_t MAX_CURL_UPLOAD_BUFFER = 2 * 1024 * 1024;
+constexpr size_t SINK_BUFFER_SIZE = 1024 * 1024;
+constexpr size_t FILL_BLOCK_SIZE = 1024 * 1024;
+constexpr const char *FILE_PREFIX = "/data/upload_throughput_benchmark_";
+
+/**
+ * @brief A local HTTP endpoint that accepts request bodies of a known length and throws them away, so the
+ * benchmark measures the client side only.
+ */
+class HttpSink {
+public:
+    HttpSink()
+    {
+        listenFd_ = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t len = sizeof(addr);
+        if (listenFd_ < 0 || bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) != 0 ||
+            listen(listenFd_, 1) != 0 || getsockname(listenFd_, reinterpret_cast<sockaddr *>(&addr), &len) != 0) {
+            return;
+        }
+        url_ = "http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/upload";
+        thread_ = std::thread(&HttpSink::Serve, this);
+    }
+
+    ~HttpSink()
+    {
+        stop_ = true;
+        shutdown(listenFd_, SHUT_RDWR);
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        close(listenFd_);
+    }
+
+    const std::string &GetUrl() const
+    {
+        return url_;
+    }
+
+private:
+    void Serve()
+    {
+        std::vector<char> buffer(SINK_BUFFER_SIZE);
+        while (!stop_) {
+            int fd = accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            while (HandleRequest(fd, buffer)) {
+            }
+            close(fd);
+        }
+    }
+
+    // reads one request, answering an Expect: 100-continue before the body, and drains its body
+    static bool HandleRequest(int fd, std::vector<char> &buffer)
+    {
+        std::string head;
+        size_t end = std::string::npos;
+        while ((end = head.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t len = recv(fd, buffer.data(), buffer.size(), 0);
+            if (len <= 0) {
+                return false;
+            }
+            head.append(buffer.data(), len);
+        }
+        int64_t remaining = GetContentLength(head.substr(0, end)) - static_cast<int64_t>(head.size() - end - 4);
+        if (HasHeader(head.substr(0, end), "expect: 100-continue")) {
+            const std::string continueLine = "HTTP/1.1 100 Continue\r\n\r\n";
+            send(fd, continueLine.data(), continueLine.size(), MSG_NOSIGNAL);
+        }
+        while (remaining > 0) {
+            ssize_t len = recv(fd, buffer.data(), std::min<int64_t>(remaining, buffer.size()), 0);
+            if (len <= 0) {
+                return false;
+            }
+            remaining -= len;
+        }
+        const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+        return send(fd, response.data(), response.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(response.size());
+    }
+
+    static bool HasHeader(const std::string &head, const std::string &line)
+    {
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        return lower.find("\r\n" + line) != std::string::npos;
+    }
+
+    static int64_t GetContentLength(const std::string &head)
+    {
+        const std::string name = "\r\ncontent-length:";
+        std::string lower = head;
+        std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+        size_t pos = lower.find(name);
+        return pos == std::string::npos ? 0 : std::strtoll(head.c_str() + pos + name.size(), nullptr, 10);
+    }
+
+private:
+    int listenFd_ = -1;
+    std::string url_;
+    std::atomic<bool> stop_ { false };
+    std::thread thread_;
+};
+
+HttpSink &GetSink()
+{
+    static HttpSink sink;
+    return sink;
+}
+
+// the source file of the given size, written once and then served from the page cache
+std::string GetSourceFile(int64_t sizeMb)
+{
+    std::string path = FILE_PREFIX + std::to_string(sizeMb) + "m.bin";
+    FILE *file = fopen(path.c_str(), "r");
+    if (file != nullptr) {
+        fseek(file, 0, SEEK_END);
+        bool complete = ftell(file) == sizeMb * MEGABYTE;
+        fclose(file);
+        if (complete) {
+            return path;
+        }
+    }
+    file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return "";
+    }
+    std::vector<char> block(FILL_BLOCK_SIZE);
+    for (size_t i = 0; i < block.size(); i++) {
+        block[i] = static_cast<char>((i * 131) % 251);
+    }
+    for (int64_t written = 0; written < sizeMb * MEGABYTE; written += static_cast<int64_t>(block.size())) {
+        fwrite(block.data(), 1, block.size(), file);
+    }
+    fclose(file);
+    return path;
+}
+
+size_t StdioReadCallback(char *buffer, size_t size, size_t nitems, void *arg)
+{
+    return fread(buffer, 1, std::min(size * nitems, STDIO_READ_SIZE), static_cast<FILE *>(arg));
+}
+
+size_t ReaderReadCallback(char *buffer, size_t size, size_t nitems, void *arg)
+{
+    ssize_t len = static_cast<UploadFileReader *>(arg)->Read(buffer, size * nitems);
+    return len < 0 ? CURL_READFUNC_ABORT : static_cast<size_t>(len);
+}
+
+size_t DiscardCallback(char *, size_t size, size_t nitems, void *)
+{
+    return size * nitems;
+}
+
+// bufferSize 0 keeps curl's default upload buffer
+bool Post(CURL *curl, int64_t size, curl_read_callback callback, void *arg, size_t bufferSize)
+{
+    curl_easy_setopt(curl, CURLOPT_URL, GetSink().GetUrl().c_str());
+    curl_easy_setopt(curl, CURLOPT_POST, 1L);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(size));
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, callback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, arg);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, DiscardCallback);
+    if (bufferSize > 0) {
+        curl_easy_setopt(curl, CURLOPT_UPLOAD_BUFFERSIZE, static_cast<long>(bufferSize));
+    }
+    long httpCode = 0;
+    bool result = curl_easy_perform(curl) == CURLE_OK;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &httpCode);
+    return result && httpCode == 200;
+}
+
+/**
+ * @brief The read path before UploadFileReader: 8 KB freads straight from the curl read callback
+ */
+void BM_UploadStdio(benchmark::State &state)
+{
+    std::string path = GetSourceFile(state.range(0));
+    CURL *curl = curl_easy_init();
+    if (path.empty() || curl == nullptr || GetSink().GetUrl().empty()) {
+        state.SkipWithError("setup failed");
+        curl_easy_cleanup(curl);
+        return;
+    }
+    int64_t size = state.range(0) * MEGABYTE;
+    for (auto _ : state) {
+        FILE *file = fopen(path.c_str(), "rb");
+        bool result = file != nullptr && Post(curl, size, StdioReadCallback, file, 0);
+        if (file != nullptr) {
+            fclose(file);
+        }
+        if (!result) {
+            state.SkipWithError("upload failed");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+    curl_easy_cleanup(curl);
+}
+
+/**
+ * @brief The current read path, with range(1) as bufferSize and range(2) selecting useMmap
+ */
+void BM_UploadReader(benchmark::State &state)
+{
+    std::string path = GetSourceFile(state.range(0));
+    CURL *curl = curl_easy_init();
+    if (path.empty() || curl == nullptr || GetSink().GetUrl().empty()) {
+        state.SkipWithError("setup failed");
+        curl_easy_cleanup(curl);
+        return;
+    }
+    int64_t size = state.range(0) * MEGABYTE;
+    size_t bufferSize = UploadFileReader::ClampBufferSize(static_cast<size_t>(state.range(1)));
+    for (auto _ : state) {
+        FILE *file = fopen(path.c_str(), "rb");
+        if (file == nullptr) {
+            state.SkipWithError("open failed");
+            break;
+        }
+        UploadFileReader reader(fileno(file), 0, size);
+        bool result = reader.Open(bufferSize, state.range(2) != 0) &&
+            Post(curl, size, ReaderReadCallback, &reader, std::min(bufferSize, MAX_CURL_UPLOAD_BUFFER));
+        reader.Close();
+        fclose(file);
+        if (!result) {
+            state.SkipWithError("upload failed");
+            break;
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * size);
+    curl_easy_cleanup(curl);
+}
+
+void StdioArgs(benchmark::internal::Benchmark *bench)
+{
+    for (int64_t sizeMb : FILE_SIZES_MB) {
+        bench->Args({ sizeMb });
+    }
+}
+
+void ReaderArgs(benchmark::internal::Benchmark *bench)
+{
+    for (int64_t sizeMb : FILE_SIZES_MB) {
+        bench->Args({ sizeMb, static_cast<int64_t>(UploadFileReader::DEFAULT_BUFFER_SIZE), 0 });
+        bench->Args({ sizeMb, static_cast<int64_t>(MAX_CURL_UPLOAD_BUFFER), 0 });
+        bench->Args({ sizeMb, static_cast<int64_t>(MAX_CURL_UPLOAD_BUFFER), 1 });
+    }
+}
+} // namespace
+
+BENCHMARK(BM_UploadStdio)->Apply(StdioArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_UploadReader)->Apply(ReaderArgs)->Unit(benchmark::kMillisecond)->UseRealTime();
+} // namespace OHOS::Request::Upload
+
+BENCHMARK_MAIN();
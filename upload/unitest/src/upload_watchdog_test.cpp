@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2022 Huawei Device Co., Ltd.
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "upload_watchdog.h"
+
+using namespace testing::ext;
+namespace OHOS::Request::Upload {
+constexpr int64_t CHECK_INTERVAL_MS = 10;
+constexpr int64_t SETTLE_MS = 100;
+
+class UploadWatchdogTest : public testing::Test {
+public:
+    static void SetUpTestCase(void);
+
+    static void TearDownTestCase(void);
+
+    void SetUp();
+
+    void TearDown();
+};
+
+void UploadWatchdogTest::SetUpTestCase(void)
+{
+    UploadWatchdog::GetInstance().SetCheckInterval(CHECK_INTERVAL_MS);
+}
+
+void UploadWatchdogTest::TearDownTestCase(void)
+{
+}
+
+void UploadWatchdogTest::SetUp()
+{
+}
+
+void UploadWatchdogTest::TearDown()
+{
+}
+
+/**
+ * @tc.name: UploadWatchdogTest_001
+ * @tc.desc: an expired deadline fires its callback once and is cleared
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadWatchdogTest, UploadWatchdogTest_001, TestSize.Level1)
+{
+    std::atomic<int64_t> deadline(0);
+    std::atomic<int> fired(0);
+    uint64_t id = UploadWatchdog::GetInstance().Watch(&deadline, [&fired]() { fired++; });
+    EXPECT_NE(id, 0u);
+    deadline = UploadWatchdog::Now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+    EXPECT_EQ(fired.load(), 1);
+    EXPECT_EQ(deadline.load(), 0);
+    UploadWatchdog::GetInstance().Unwatch(id);
+}
+
+/**
+ * @tc.name: UploadWatchdogTest_002
+ * @tc.desc: idle, future and unwatched deadlines do not fire
+ * @tc.type: FUNC
+ */
+HWTEST_F(UploadWatchdogTest, UploadWatchdogTest_002, TestSize.Level1)
+{
+    std::atomic<int64_t> idle(0);
+    std::atomic<int64_t> future(UploadWatchdog::Now() + SETTLE_MS * SETTLE_MS);
+    std::atomic<int64_t> removed(0);
+    std::atomic<int> fired(0);
+    auto &watchdog = UploadWatchdog::GetInstance();
+    uint64_t idleId = watchdog.Watch(&idle, [&fired]() { fired++; });
+    uint64_t futureId = watchdog.Watch(&future, [&fired]() { fired++; });
+    uint64_t removedId = watchdog.Watch(&removed, [&fired]() { fired++; });
+    watchdog.Unwatch(removedId);
+    removed = UploadWatchdog::Now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(SETTLE_MS));
+    EXPECT_EQ(fired.load(), 0);
+    watchdog.Unwatch(idleId);
+    watchdog.Unwatch(futureId);
+    EXPECT_EQ(watchdog.Watch(nullptr, []() {}), 0u);
+}
+} // end of OHOS::Request::Upload